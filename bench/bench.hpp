@@ -0,0 +1,27 @@
+#ifndef POVU_BENCH_HPP
+#define POVU_BENCH_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <limits>
+
+#include "../src/common/types.hpp"
+
+namespace povu::bench {
+namespace pt = povu::types;
+
+// the fastest of runs calls of f in seconds
+template <typename F> double best_of(std::size_t runs, F&& f) {
+  double best { std::numeric_limits<double>::max() };
+  for (std::size_t i {}; i < runs; ++i) {
+    auto t0 = pt::Time::now();
+    f();
+    std::chrono::duration<double> d = pt::Time::now() - t0;
+    if (d.count() < best) { best = d.count(); }
+  }
+  return best;
+}
+
+} // namespace povu::bench
+
+#endif
@@ -0,0 +1,122 @@
+/*
+ * deconstruct of every component of a GFA with and without --sort, and how far
+ * apart the ends of an edge are in the store in either order. The ids can be
+ * shuffled first to stand for an unsorted input.
+ *
+ * usage: bench_bfs_sort [gfa] [runs] [shuffle seed, 0 keeps the input ids]
+ */
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <format>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../src/cli/app.hpp"
+#include "../src/graph/graph.hpp"
+#include "../src/io/io.hpp"
+#include "../src/povu.hpp"
+#include "./bench.hpp"
+
+namespace pbe = povu::bench;
+namespace pg = povu::graph;
+namespace pgt = povu::graph_types;
+
+namespace {
+// a copy of g with its ids permuted at random, componetize puts the vertices of
+// a component in id order so this scatters the neighbours of a vertex
+pg::Graph shuffled(const pg::Graph& g, unsigned int seed, const core::config& app_config) {
+  std::mt19937 rng(seed);
+
+  // the new id of the vertex at each index
+  std::vector<std::size_t> ids;
+  for (std::size_t v_idx {}; v_idx < g.size(); ++v_idx) { ids.push_back(g.v_idx_to_id(v_idx)); }
+  std::shuffle(ids.begin(), ids.end(), rng);
+
+  pg::Graph s(ids.size(), g.edge_count());
+  for (std::size_t id : ids) { s.add_vertex(id); }
+  for (std::size_t e_idx {}; e_idx < g.edge_count(); ++e_idx) {
+    const pg::Edge& e = g.get_edge(e_idx);
+    s.add_edge(ids[e.get_v1_idx()], e.get_v1_end(), ids[e.get_v2_idx()], e.get_v2_end());
+  }
+  s.freeze();
+  io::from_gfa::populate_tips(s, app_config);
+
+  return s;
+}
+
+// the mean distance between the indexes of the ends of an edge
+double mean_edge_span(const std::vector<pg::Graph>& components) {
+  double sum {};
+  std::size_t count {};
+  for (const pg::Graph& c : components) {
+    for (std::size_t e_idx {}; e_idx < c.edge_count(); ++e_idx) {
+      const pg::Edge& e = c.get_edge(e_idx);
+      std::size_t v1 = e.get_v1_idx(), v2 = e.get_v2_idx();
+      sum += static_cast<double>(v1 > v2 ? v1 - v2 : v2 - v1);
+      ++count;
+    }
+  }
+  return count ? sum / static_cast<double>(count) : 0.0;
+}
+
+// the components deconstruct would run on
+std::vector<pg::Graph> deconstructed(std::vector<pg::Graph>&& components) {
+  std::vector<pg::Graph> cs;
+  for (pg::Graph& c : components) {
+    if (c.size() >= 3 && !pg::is_flubble_free(c)) { cs.push_back(std::move(c)); }
+  }
+  return cs;
+}
+} // namespace
+
+int main(int argc, char* argv[]) {
+  std::string gfa = argc > 1 ? argv[1] : std::string(POVU_TEST_DATA) + "/real/DRB1-3123_unsorted.gfa";
+  std::size_t runs = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 10;
+  unsigned int seed = argc > 3 ? static_cast<unsigned int>(std::strtoul(argv[3], nullptr, 10)) : 0;
+
+  core::config app_config;
+  app_config.set_verbosity(0);
+  app_config.set_print_dot(false);
+  app_config.set_thread_count(1);
+
+  pg::Graph g = ::io::from_gfa::to_pv_graph(gfa.c_str(), app_config);
+  if (seed) { g = shuffled(g, seed, app_config); }
+  std::vector<pg::Graph> components = deconstructed(pg::componetize(std::move(g), app_config));
+
+  std::vector<pg::Graph> sorted;
+  double sort_s = pbe::best_of(runs, [&] {
+    sorted.clear();
+    for (const pg::Graph& c : components) { sorted.push_back(pg::sort_bfs(c)); }
+  });
+
+  std::size_t flubble_count {}, sorted_flubble_count {};
+  double unsorted_s = pbe::best_of(runs, [&] {
+    flubble_count = 0;
+    for (std::size_t i {}; i < components.size(); ++i) {
+      flubble_count += povu::lib::deconstruct_to_ft(components[i], i + 1, app_config).size();
+    }
+  });
+  double sorted_s = pbe::best_of(runs, [&] {
+    sorted_flubble_count = 0;
+    for (std::size_t i {}; i < sorted.size(); ++i) {
+      sorted_flubble_count += povu::lib::deconstruct_to_ft(sorted[i], i + 1, app_config).size();
+    }
+  });
+
+  if (flubble_count != sorted_flubble_count) {
+    std::cerr << std::format("the flubble counts differ: {} unsorted {} sorted\n", flubble_count, sorted_flubble_count);
+    return 1;
+  }
+
+  std::cout << std::format("{} ({} components, shuffle seed {}) best of {}\n", gfa, components.size(), seed, runs);
+  std::cout << std::format("  mean edge span     {:.1f} -> {:.1f} sorted\n", mean_edge_span(components),
+                           mean_edge_span(sorted));
+  std::cout << std::format("  deconstruct        {:.2f} ms\n", unsorted_s * 1e3);
+  std::cout << std::format("  sort_bfs           {:.2f} ms\n", sort_s * 1e3);
+  std::cout << std::format("  deconstruct sorted {:.2f} ms\n", sorted_s * 1e3);
+
+  return 0;
+}
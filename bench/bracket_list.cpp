@@ -0,0 +1,106 @@
+/*
+ * BracketPool against the std::list and unordered_map bracket list it
+ * replaced, on the bracket operations cycle equivalence does on a chain in
+ * which every vertex has a back edge span vertices up
+ *
+ * usage: bench_bracket_list [vertex count] [span] [runs]
+ */
+#include <cstddef>
+#include <cstdlib>
+#include <format>
+#include <iostream>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+#include "../src/graph/bracket_list.hpp"
+#include "./bench.hpp"
+
+namespace pbl = povu::bracket_list;
+namespace pbe = povu::bench;
+
+namespace {
+// WBracketList as it was before the pool
+class WBracketList {
+  std::list<pbl::Bracket> brackets;
+  std::unordered_map<std::size_t, std::list<pbl::Bracket>::iterator> bracket_map;
+
+public:
+  std::size_t size() const { return this->brackets.size(); }
+
+  void push(pbl::Bracket br) {
+    this->brackets.push_front(br);
+    this->bracket_map[br.back_edge_id()] = this->brackets.begin();
+  }
+
+  pbl::Bracket& top() { return this->brackets.front(); }
+
+  void del(std::size_t be_id) {
+    if (this->bracket_map.find(be_id) == this->bracket_map.end()) { return; }
+    this->brackets.erase(this->bracket_map[be_id]);
+    this->bracket_map.erase(be_id);
+  }
+
+  void concat(WBracketList* child) {
+    this->brackets.splice(this->brackets.begin(), child->brackets);
+    for (auto it = this->brackets.begin(); it != this->brackets.end(); ++it) {
+      this->bracket_map[it->back_edge_id()] = it;
+    }
+  }
+};
+
+/*
+ * vertices are finished from the bottom of the chain up, each one takes the
+ * list of its child, deletes the back edge that ends at it and pushes the one
+ * that leaves it. Back edge v goes from v + span to v.
+ */
+std::size_t run_list(std::size_t n, std::size_t span) {
+  std::vector<WBracketList*> lists(n, nullptr);
+  std::size_t sum {};
+  for (std::size_t v { n }; v-- > 0;) {
+    lists[v] = new WBracketList();
+    if (v + 1 < n) { lists[v]->concat(lists[v + 1]); }
+    lists[v]->del(v);
+    if (v >= span) { lists[v]->push(pbl::Bracket(v - span)); }
+    if (lists[v]->size() > 0) { sum += lists[v]->top().back_edge_id(); }
+  }
+  for (WBracketList* l : lists) { delete l; }
+  return sum;
+}
+
+std::size_t run_pool(std::size_t n, std::size_t span) {
+  pbl::BracketPool pool;
+  pool.reserve(n);
+  std::vector<pbl::BracketList> lists(n);
+  std::size_t sum {};
+  for (std::size_t v { n }; v-- > 0;) {
+    if (v + 1 < n) { pool.concat(lists[v], lists[v + 1]); }
+    pool.del(lists[v], v);
+    if (v >= span) { pool.push(lists[v], v - span, v - span); }
+    if (!lists[v].empty()) { sum += pool.top(lists[v]).back_edge_id(); }
+  }
+  return sum;
+}
+} // namespace
+
+int main(int argc, char* argv[]) {
+  std::size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 50'000;
+  std::size_t span = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1'000;
+  std::size_t runs = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 5;
+
+  std::size_t list_sum {}, pool_sum {};
+  // the pool first, the heap the list leaves behind slows down what follows
+  double pool_s = pbe::best_of(runs, [&] { pool_sum = run_pool(n, span); });
+  double list_s = pbe::best_of(runs, [&] { list_sum = run_list(n, span); });
+
+  if (list_sum != pool_sum) {
+    std::cerr << std::format("the tops differ: list {} pool {}\n", list_sum, pool_sum);
+    return 1;
+  }
+
+  std::cout << std::format("{} vertices span {} best of {}\n", n, span, runs);
+  std::cout << std::format("  std::list    {:.4f} s\n", list_s);
+  std::cout << std::format("  BracketPool  {:.4f} s\n", pool_s);
+
+  return 0;
+}
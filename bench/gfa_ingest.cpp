@@ -0,0 +1,83 @@
+/*
+ * GFA ingest throughput of to_pv_graph and of to_bd (with the paths call keeps)
+ * in MB/s for 1 to max threads. With no GFA a chain of bubbles with two paths
+ * is written to the temp dir, a number in place of the GFA is the bubble count.
+ *
+ * usage: bench_gfa_ingest [gfa | bubbles] [max threads] [runs] [min chunk bytes]
+ */
+#include <cstddef>
+#include <cstdlib>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+
+#include "../src/cli/app.hpp"
+#include "../src/io/io.hpp"
+#include "./bench.hpp"
+
+namespace pbe = povu::bench;
+
+namespace {
+// a -> (b | c) -> d per bubble, d of one bubble links to a of the next, one
+// path through every b and one through every c
+std::string write_bubble_chain(std::size_t bubble_count) {
+  std::filesystem::path fp = std::filesystem::temp_directory_path() / std::format("povu_bench_ingest_{}.gfa", bubble_count);
+  std::ofstream out(fp);
+  std::mt19937 rng(1);
+
+  out << "H\tVN:Z:1.0\n";
+  for (std::size_t id { 1 }; id <= 3 * bubble_count + 1; ++id) {
+    std::string label(8 + rng() % 24, 'A');
+    for (char& c : label) { c = "ACGT"[rng() % 4]; }
+    out << std::format("S\t{}\t{}\n", id, label);
+  }
+
+  std::string p1, p2;
+  for (std::size_t i {}; i < bubble_count; ++i) {
+    std::size_t a = 3 * i + 1, b = a + 1, c = a + 2, d = a + 3;
+    out << std::format("L\t{}\t+\t{}\t+\t0M\nL\t{}\t+\t{}\t+\t0M\n", a, b, a, c);
+    out << std::format("L\t{}\t+\t{}\t+\t0M\nL\t{}\t+\t{}\t+\t0M\n", b, d, c, d);
+    p1 += std::format("{}+,{}+,", a, b);
+    p2 += std::format("{}+,{}+,", a, c);
+  }
+  p1 += std::format("{}+", 3 * bubble_count + 1);
+  p2 += std::format("{}+", 3 * bubble_count + 1);
+  out << std::format("P\tp1\t{}\t*\nP\tp2\t{}\t*\n", p1, p2);
+
+  return fp.string();
+}
+} // namespace
+
+int main(int argc, char* argv[]) {
+  std::string arg = argc > 1 ? argv[1] : "300000";
+  unsigned int max_threads = argc > 2 ? static_cast<unsigned int>(std::strtoul(argv[2], nullptr, 10)) : 8;
+  std::size_t runs = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 5;
+  std::size_t min_chunk_size = argc > 4 ? std::strtoull(argv[4], nullptr, 10) : io::from_gfa::GFA_MIN_CHUNK_SIZE;
+
+  std::string gfa = arg.find_first_not_of("0123456789") == std::string::npos
+    ? write_bubble_chain(std::strtoull(arg.c_str(), nullptr, 10))
+    : arg;
+  double mb = static_cast<double>(std::filesystem::file_size(gfa)) / 1e6;
+
+  std::cout << std::format("{} ({:.1f} MB, min chunk {} bytes) best of {}\n", gfa, mb, min_chunk_size, runs);
+  std::cout << std::format("  {:>7} {:>16} {:>16}\n", "threads", "to_pv_graph MB/s", "to_bd MB/s");
+
+  for (unsigned int t { 1 }; t <= max_threads; ++t) {
+    core::config app_config;
+    app_config.set_verbosity(0);
+    app_config.set_print_dot(false);
+    app_config.set_thread_count(t);
+
+    double pv_s = pbe::best_of(runs, [&] { ::io::from_gfa::to_pv_graph(gfa.c_str(), app_config, min_chunk_size); });
+
+    app_config.set_task(core::task_t::call);
+    double bd_s = pbe::best_of(runs, [&] { ::io::from_gfa::to_bd(gfa.c_str(), app_config, min_chunk_size); });
+
+    std::cout << std::format("  {:>7} {:>16.1f} {:>16.1f}\n", t, mb / pv_s, mb / bd_s);
+  }
+
+  return 0;
+}
@@ -0,0 +1,204 @@
+/*
+ * the spanning tree DFS of every component of a GFA, with the stack DFS over
+ * std::map and std::set that it replaced, on the materialised biedged graph
+ * and on the implicit view. The trees are checked to be the same, vertex for
+ * vertex and edge for edge.
+ *
+ * usage: bench_spanning_tree [gfa] [runs]
+ */
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <format>
+#include <iostream>
+#include <map>
+#include <set>
+#include <span>
+#include <stack>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "../src/cli/app.hpp"
+#include "../src/common/types.hpp"
+#include "../src/graph/biedged.hpp"
+#include "../src/graph/graph.hpp"
+#include "../src/graph/spanning_tree.hpp"
+#include "../src/io/io.hpp"
+#include "./bench.hpp"
+
+namespace bd = biedged;
+namespace pbe = povu::bench;
+namespace pc = povu::constants;
+namespace pgt = povu::graph_types;
+namespace pst = povu::spanning_tree;
+namespace pt = povu::types;
+
+namespace {
+using pgt::color;
+using pgt::v_type;
+
+// the DFS before it was made iterative, revisits a vertex's neighbours every
+// time it is back on top of the stack
+pst::Tree legacy_spanning_tree(const bd::BVariationGraph& g) {
+  pst::Tree t = pst::Tree(g.size());
+
+  std::stack<std::tuple<std::size_t, std::size_t, color>> s;
+  std::vector<bool> visited(g.size(), false);
+
+  std::size_t v_idx {};
+  s.push({ pc::INVALID_ID, v_idx, color::gray });
+  visited[v_idx] = true;
+
+  std::size_t counter {};
+  std::map<std::size_t, std::size_t> vtx_to_dfs_num;
+  std::vector<bool> in_tree(g.size(), false);
+  std::set<pt::unordered_pair<std::size_t>> back_edges;
+
+  auto is_parent = [&](std::size_t p, std::size_t c) -> bool {
+    return t.get_vertex(vtx_to_dfs_num[c]).get_parent_idx() == vtx_to_dfs_num[p];
+  };
+
+  auto is_parent_child = [&](std::size_t n, std::size_t v_idx) -> bool {
+    return is_parent(n, v_idx) || is_parent(v_idx, n);
+  };
+
+  auto is_self_loop = [&](std::size_t n, std::size_t v_idx) -> bool {
+    if (!is_parent_child(n, v_idx)) { return false; }
+    if (g.get_vertex(v_idx).get_type() == v_type::dummy || g.get_vertex(n).get_type() == v_type::dummy) { return false; }
+    if (std::stoull(g.get_vertex(n).get_handle()) != std::stoull(g.get_vertex(v_idx).get_handle())) { return false; }
+
+    for (auto e_idx : g.get_vertex(v_idx).get_grey_edges()) {
+      if (g.get_edge(e_idx).get_other_vertex(v_idx) == n) { return true; }
+    }
+    return false;
+  };
+
+  while (!s.empty()) {
+    auto [p_idx, v_idx, c] = s.top();
+    const bd::Vertex& v = g.get_vertex(v_idx);
+
+    if (!in_tree[v_idx]) {
+      t.add_vertex(pst::Vertex { counter, v.get_type() }, v.get_id());
+      in_tree[v_idx] = true;
+      vtx_to_dfs_num[v_idx] = counter;
+      if (p_idx != pc::INVALID_ID) { t.add_tree_edge(vtx_to_dfs_num[p_idx], counter, pc::UNDEFINED_SIZE_T, c); }
+      counter++;
+    }
+
+    bool explored { true };
+    for (auto [c, n] : g.get_neighbours(v_idx)) {
+      if (!visited[n]) {
+        s.push({ v_idx, n, c });
+        visited[n] = true;
+        explored = false;
+        break;
+      }
+      else if ((is_self_loop(n, v_idx) || !is_parent_child(n, v_idx)) && !back_edges.count({ n, v_idx })) {
+        t.add_be(vtx_to_dfs_num[v_idx], vtx_to_dfs_num[n], pc::UNDEFINED_SIZE_T, pst::EdgeType::back_edge, c);
+        back_edges.insert({ v_idx, n });
+      }
+    }
+
+    if (explored) { s.pop(); }
+  }
+
+  t.freeze();
+  return t;
+}
+
+// the first difference between two trees, empty if they are the same vertex
+// for vertex and edge for edge. The legacy DFS does not record the graph edge of
+// a tree or back edge, with_g_idx compares them too.
+std::string tree_diff(pst::Tree& a, pst::Tree& b, bool with_g_idx) {
+  if (a.size() != b.size()) { return "vertex count"; }
+  if (a.tree_edge_count() != b.tree_edge_count()) { return "tree edge count"; }
+  if (a.back_edge_count() != b.back_edge_count()) { return "back edge count"; }
+
+  auto same = [](std::span<const std::size_t> x, std::span<const std::size_t> y) {
+    return std::equal(x.begin(), x.end(), y.begin(), y.end());
+  };
+
+  for (std::size_t v {}; v < a.size(); ++v) {
+    const pst::Vertex& av = a.get_vertex(v);
+    const pst::Vertex& bv = b.get_vertex(v);
+    if (a.get_vertex_id(v) != b.get_vertex_id(v) || av.type() != bv.type() || av.dfs_num() != bv.dfs_num()) {
+      return std::format("vertex {}", v);
+    }
+    if (v != a.get_root_idx() && av.get_parent_idx() != bv.get_parent_idx()) { return std::format("parent of {}", v); }
+    if (!same(a.get_children(v), b.get_children(v))) { return std::format("children of {}", v); }
+    if (!same(a.get_obe_idxs(v), b.get_obe_idxs(v))) { return std::format("out back edges of {}", v); }
+    if (!same(a.get_ibe_idxs(v), b.get_ibe_idxs(v))) { return std::format("in back edges of {}", v); }
+  }
+
+  for (std::size_t e {}; e < a.tree_edge_count(); ++e) {
+    const pst::Edge& ae = a.get_tree_edge(e);
+    const pst::Edge& be = b.get_tree_edge(e);
+    if (ae.id() != be.id() || ae.get_parent_v_idx() != be.get_parent_v_idx()
+        || ae.get_child() != be.get_child() || ae.get_color() != be.get_color()) {
+      return std::format("tree edge {}", e);
+    }
+    if (with_g_idx && a.get_tree_edge_g_idx(e) != b.get_tree_edge_g_idx(e)) { return std::format("graph edge of tree edge {}", e); }
+  }
+
+  for (std::size_t e {}; e < a.back_edge_count(); ++e) {
+    const pst::BackEdge& ae = a.get_backedge(e);
+    const pst::BackEdge& be = b.get_backedge(e);
+    if (ae.id() != be.id() || ae.get_src() != be.get_src() || ae.get_tgt() != be.get_tgt()
+        || ae.type() != be.type() || ae.get_color() != be.get_color()) {
+      return std::format("back edge {}", e);
+    }
+    if (with_g_idx && a.get_backedge_g_idx(e) != b.get_backedge_g_idx(e)) { return std::format("graph edge of back edge {}", e); }
+  }
+
+  return "";
+}
+} // namespace
+
+int main(int argc, char* argv[]) {
+  std::string gfa = argc > 1 ? argv[1] : std::string(POVU_TEST_DATA) + "/real/chr6.C4.gfa";
+  std::size_t runs = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 20;
+
+  core::config app_config;
+  app_config.set_verbosity(0);
+  app_config.set_print_dot(false);
+  app_config.set_thread_count(1);
+
+  std::vector<povu::graph::Graph> components =
+    povu::graph::componetize(::io::from_gfa::to_pv_graph(gfa.c_str(), app_config), app_config);
+
+  std::vector<bd::BVariationGraph> biedged;
+  for (const povu::graph::Graph& g : components) { biedged.emplace_back(g); }
+
+  for (std::size_t i {}; i < components.size(); ++i) {
+    pst::Tree legacy = legacy_spanning_tree(biedged[i]);
+    pst::Tree iter = biedged[i].compute_spanning_tree();
+    pst::Tree view = bd::BVariationGraphView(components[i]).compute_spanning_tree();
+
+    for (auto [name, diff] : { std::pair { "iterative", tree_diff(legacy, iter, false) },
+                               std::pair { "view", tree_diff(iter, view, true) } }) {
+      if (!diff.empty()) {
+        std::cerr << std::format("the {} tree of component {} differs at the {}\n", name, i, diff);
+        return 1;
+      }
+    }
+  }
+
+  double legacy_s = pbe::best_of(runs, [&] {
+    for (const bd::BVariationGraph& bg : biedged) { legacy_spanning_tree(bg); }
+  });
+  double iter_s = pbe::best_of(runs, [&] {
+    for (const bd::BVariationGraph& bg : biedged) { bg.compute_spanning_tree(); }
+  });
+  double view_s = pbe::best_of(runs, [&] {
+    for (const povu::graph::Graph& g : components) { bd::BVariationGraphView(g).compute_spanning_tree(); }
+  });
+
+  std::cout << std::format("{} ({} components) best of {}\n", gfa, components.size(), runs);
+  std::cout << std::format("  stack DFS, std::map and std::set  {:.2f} ms\n", legacy_s * 1e3);
+  std::cout << std::format("  iterative DFS                     {:.2f} ms\n", iter_s * 1e3);
+  std::cout << std::format("  iterative DFS on the view         {:.2f} ms\n", view_s * 1e3);
+
+  return 0;
+}
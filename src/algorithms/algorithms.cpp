@@ -1,292 +1,397 @@
 #include <algorithm>
 #include <cstddef>
+#include <cstdint>
 #include <iostream>
+#include <span>
 
 #include <unistd.h>
 #include <utility>
 #include <vector>
 #include <format>
-#include <chrono>
 
 #include "./algorithms.hpp"
+#include "../common/scheduler.hpp"
 
 
 namespace povu::algorithms {
 using namespace povu::graph_types;
 namespace pc = povu::constants;
 
-
+namespace {
 /**
- * Compute the equivalance class of a given vertex
- * Find the cycle equivalent edges
- * in reverse DFS
+ * where the processing of a vertex gets its new classes from and adds its
+ * capping and simplifying back edges to
+ *
+ * A serial run takes both straight from the tree. In a parallel run every
+ * vertex adds its back edge in its own slot and classes are provisional ids
+ * from a range owned by the context, they are relabelled once all vertices are
+ * done.
  */
-void eulerian_cycle_equiv(pst::Tree &t) {
-  std::string fn_name = std::format("[povu::algorithms::{}]", __func__);
-
-  std::set<std::size_t> articulted_vertices;
-  bool report_time {false};
-  bool check_time{false};
-
-  auto start = std::chrono::high_resolution_clock::now();
-
-  bool in_hairpin {false};
-
-  std::size_t boundary {pc::UNDEFINED_SIZE_T};
-
-  for (std::size_t v { t.size() - 1 }; v < pc::UNDEFINED_SIZE_T; --v) {
+struct ce_context {
+  pst::Tree& t;
+  bool parallel { false };
 
-    if (report_time && v % 10000 == 0) {
-      check_time = true;
-      std::cerr << "v: " << v << std::endl;
-      start = std::chrono::high_resolution_clock::now();
-    }
-
-
-    // check if v is a multiple of 100000
+  // the dfs nums [lo, hi) of the subtree a task owns, back edges added to a
+  // target outside of it are chained once all tasks are done
+  std::size_t lo {};
+  std::size_t hi { pc::INVALID_IDX };
+  std::vector<std::size_t> escaped;
 
-    //t0 = pt::Time::now();
-
-    /*
-     * compute v.hi
-     * ------------
-     */
-
-    std::size_t hi_0 { pc::UNDEFINED_SIZE_T };
-    std::set<std::size_t> obe = t.get_obe(v);
-    for (auto be: obe) {
-      hi_0 = std::min(hi_0, t.get_vertex(be).dfs_num());
-    }
+  // the next provisional class
+  std::size_t next_class {};
 
-    // given a node v find its child with the lowest hi value
-    // (closest to root)
-    // its hi value is hi_1 and the dfs num of that vertex is hi_child
-    // children are empty for dummy stop node
+  // the chains of added in back edges are not in the order a serial run
+  // builds them when tasks have added to them
+  bool sort_added { false };
 
-    std::size_t hi_1 { pc::UNDEFINED_SIZE_T };
+  // serial
+  explicit ce_context(pst::Tree& t) : t(t) {}
+  // parallel, owning the subtree [lo, hi)
+  ce_context(pst::Tree& t, std::size_t lo, std::size_t hi) : t(t), parallel(true), lo(lo), hi(hi) {}
 
+  std::size_t new_class() { return this->parallel ? this->next_class++ : this->t.new_class(); }
 
-    std::set<std::size_t> children = t.get_children(v);
-
-
-    if (in_hairpin && children.empty() && !t.is_root(v)) { // v is a leaf
-      in_hairpin = false;
-      std::cerr << "Found hairpin boundary end " << t.get_vertex(boundary).name() << std::endl;
-    }
-    else if (in_hairpin && t.is_root(v)) {
-      in_hairpin = false;
-      std::cerr << "Found hairpin boundary end " << t.get_vertex(boundary).name() << std::endl;
-    }
-
+  std::size_t add_be(std::size_t frm, std::size_t to, pst::EdgeType type) {
+    if (!this->parallel) { return this->t.add_be(frm, to, type); }
 
-    // a vector of pairs of hi values and children
-    std::vector<std::pair<std::size_t, std::size_t>> hi_and_child{};
-    hi_and_child.reserve(children.size());
-
-    // for each child input the hi value and the child
-    for (std::size_t child: children) {
-      hi_and_child.push_back({t.get_vertex(child).hi(), child});
-    }
-    std::sort(hi_and_child.begin(), hi_and_child.end());
-    if (!children.empty()) { hi_1 = hi_and_child[0].first; }
+    bool inside = to >= this->lo && to < this->hi;
+    std::size_t be_idx = this->t.add_be_to_slot(frm, to, type, inside);
+    if (!inside) { this->escaped.push_back(be_idx); }
+    return be_idx;
+  }
+};
 
-    t.get_vertex_mut(v).set_hi(std::min(hi_0, hi_1));
+// what happened at a vertex that the hairpin messages depend on
+enum hairpin_flag : std::uint8_t {
+  opens = 1,            // the bracket list was empty, a simplifying back edge was added
+  tops_simplifying = 2, // the top bracket is a simplifying back edge
+};
 
-    // the child vertex whose hi value is hi_1
-    std::size_t hi_child { pc::UNDEFINED_SIZE_T };
-    for (std::size_t child: children) {
-      if (t.get_vertex(child).hi() == hi_1) {
-        hi_child = child;
-        break;
+/**
+ * @brief the hairpin boundary messages, they depend on the vertices seen
+ * before in reverse DFS order so a parallel run replays them at the end
+ */
+struct hairpin_tracker {
+  bool in_hairpin { false };
+  std::size_t boundary { pc::UNDEFINED_SIZE_T };
+
+  void visit(const pst::Tree& t, std::size_t v, std::uint8_t flags) {
+    if (this->in_hairpin && (t.is_root(v) || t.is_leaf(v))) {
+      this->in_hairpin = false;
+      // no vertex of the hairpin had the simplifying back edge on top
+      if (this->boundary != pc::UNDEFINED_SIZE_T) {
+        std::cerr << "Found hairpin boundary end " << t.get_vertex_name(this->boundary) << std::endl;
       }
     }
 
-    // if hi_and_child has at least 2 elements
-    // assign hi_2 from the second element of hi_and_child
-    // works because hi_and_child is sorted
-    std::size_t hi_2 { pc::UNDEFINED_SIZE_T };
-    for (std::size_t child: children) {
-      if (child != hi_child && t.get_vertex(child).hi() < v && articulted_vertices.find(child) == articulted_vertices.end()) {
-        hi_2 = t.get_vertex(child).hi();
-        break;
+    if (flags & hairpin_flag::opens) {
+      if (t.get_vertex(v).type() != VertexType::dummy) {
+        std::cerr << "Found hairpin boundary start " << t.get_vertex_name(v) << std::endl;
       }
+      this->in_hairpin = true;
     }
-
-
-    if (report_time && check_time) {
-      auto end = std::chrono::high_resolution_clock::now();
-      std::chrono::duration<double, std::milli> duration1 = end - start;
-      std::cout << "Block 1 Time: " << duration1.count() << " ms" << std::endl;
-
-      start = std::chrono::high_resolution_clock::now();
+    else if (this->in_hairpin && (flags & hairpin_flag::tops_simplifying)) {
+      this->boundary = v;
     }
+  }
+};
 
+/**
+ * Compute the equivalance class of the tree edge into v, all descendants of v
+ * must have been processed
+ *
+ * @return the hairpin flags of v
+ */
+std::uint8_t cycle_equiv_vertex(pst::Tree& t, std::size_t v, ce_context& ctx) {
 
-    //std::cout << "\tcompute bracket list";
-    /*
-     * compute bracket list
-     * --------------------
-     */
-
-    // the bracketlist was created in tree constructor
-    //if (children.size() > 1) {
-    //std::cerr << "many ~> " << children.size() << std::endl;
-    // }
-    for (auto c: children) {
-      t.concat_bracket_lists(v, c);
-    }
+  /*
+   * compute v.hi
+   * ------------
+   */
 
+  std::size_t hi_0 { pc::UNDEFINED_SIZE_T };
+  for (std::size_t be_idx : t.get_obe_idxs(v)) {
+    hi_0 = std::min(hi_0, t.get_vertex(t.get_backedge(be_idx).get_tgt()).dfs_num());
+  }
 
-    if (report_time && check_time) {
-      auto end = std::chrono::high_resolution_clock::now();
-      std::chrono::duration<double, std::milli> duration1 = end - start;
-      std::cout << "Block 2 concat Time: " << duration1.count() << " ms" << std::endl;
+  // given a node v find its child with the lowest hi value
+  // (closest to root)
+  // its hi value is hi_1 and the dfs num of that vertex is hi_child
+  // children are empty for dummy stop node
 
-      start = std::chrono::high_resolution_clock::now();
-    }
+  std::size_t hi_1 { pc::UNDEFINED_SIZE_T };
 
+  std::span<const std::size_t> children = t.get_children(v);
 
-    // for each capping backedge TODO: add
+  for (std::size_t child: children) {
+    hi_1 = std::min(hi_1, t.get_vertex(child).hi());
+  }
 
-    // pop incoming backedges
-    // remove backedges we have reached the end of
-    std::set<std::size_t> ibe_idxs = t.get_ibe_idxs(v);
-    for (std::size_t b: ibe_idxs) {
-      t.del_bracket(v, b);
+  t.get_vertex_mut(v).set_hi(std::min(hi_0, hi_1));
 
-      // TODO: set backedge class ?? was id not enough?
-      // do this in the del_bracket_method?
-      pst::BackEdge& be= t.get_backedge(b);
-      if (!be.is_capping_backedge() && !be.is_class_defined()) {
-        be.set_class(t.new_class());
-      }
+  // the child vertex whose hi value is hi_1
+  std::size_t hi_child { pc::UNDEFINED_SIZE_T };
+  for (std::size_t child: children) {
+    if (t.get_vertex(child).hi() == hi_1) {
+      hi_child = child;
+      break;
     }
+  }
 
+  // the hi value of the first other child that reaches above v
+  std::size_t hi_2 { pc::UNDEFINED_SIZE_T };
+  for (std::size_t child: children) {
+    if (child != hi_child && t.get_vertex(child).hi() < v) {
+      hi_2 = t.get_vertex(child).hi();
+      break;
+    }
+  }
 
-    if (report_time && check_time) {
-      auto end = std::chrono::high_resolution_clock::now();
-      std::chrono::duration<double, std::milli> duration1 = end - start;
-      std::cout << "Block 2 del Time: " << duration1.count() << " ms" << std::endl;
+  /*
+   * compute bracket list
+   * --------------------
+   */
 
-      start = std::chrono::high_resolution_clock::now();
-    }
+  for (auto c: children) {
+    t.concat_bracket_lists(v, c);
+  }
 
+  // pop incoming backedges
+  // remove backedges we have reached the end of
+  auto pop_ibe = [&](std::size_t b) {
+    t.del_bracket(v, b);
 
-    // push outgoing backedges
-    std::set<std::size_t> obe_i = t.get_obe_idxs(v);
-    for (std::size_t be_idx : obe_i) {
-      t.push(v, be_idx);
+    pst::BackEdge& be= t.get_backedge(b);
+    if (!be.is_capping_backedge() && !be.is_class_defined()) {
+      be.set_class(ctx.new_class());
     }
+  };
+
+  for (std::size_t b : t.get_ibe_idxs(v)) { pop_ibe(b); }
+
+  // capping and simplifying backedges added by descendants of v
+  if (ctx.sort_added) {
+    std::vector<std::size_t> added;
+    for (std::size_t b { t.first_added_ibe(v) }; b != pc::INVALID_IDX; b = t.next_added_ibe(b)) { added.push_back(b); }
+    // a serial run adds them in descending order of their source
+    std::sort(added.begin(), added.end(), [&](std::size_t a, std::size_t b) {
+      return t.get_backedge(a).get_src() > t.get_backedge(b).get_src();
+    });
+    for (std::size_t b : added) { pop_ibe(b); }
+  }
+  else {
+    for (std::size_t b { t.first_added_ibe(v) }; b != pc::INVALID_IDX; b = t.next_added_ibe(b)) { pop_ibe(b); }
+  }
 
+  // push outgoing backedges
+  for (std::size_t be_idx : t.get_obe_idxs(v)) {
+    t.push(v, be_idx);
+  }
 
-    if (hi_2 < hi_0) {
-      // add a capping backedge
-      std::size_t dest_v =  hi_2;
-      std::size_t be_idx =
-          t.add_be(v, dest_v, pst::EdgeType::capping_back_edge);
-      t.push(v, be_idx);
-    }
+  if (hi_2 < hi_0) {
+    // add a capping backedge
+    std::size_t be_idx = ctx.add_be(v, hi_2, pst::EdgeType::capping_back_edge);
+    t.push(v, be_idx);
+  }
 
+  std::uint8_t flags {};
 
+  if (t.get_bracket_list(v).empty()) {
+    std::size_t be_idx = ctx.add_be(v, t.get_root_idx(), pst::EdgeType::simplifying_back_edge);
+    t.push(v, be_idx);
+    t.get_vertex_mut(v).set_hi(t.get_root_idx());
 
-    if (t.get_bracket_list(v).empty()) {
-      std::size_t dest_v = t.get_root_idx();
-      if (t.get_vertex(v).type() != VertexType::dummy) {
-        //std::cerr << "add art be " << t.get_vertex(v).name() << " " << dest_v << std::endl;
+    flags |= hairpin_flag::opens;
+  }
+  else {
+    std::size_t b_id = t.top(v).back_edge_id();
+    if (t.get_backedge_ref_given_id(b_id).type() == pst::EdgeType::simplifying_back_edge) {
+      flags |= hairpin_flag::tops_simplifying;
+    }
+  }
 
-        std::cerr << "Found hairpin boundary start " << t.get_vertex(v).name() << std::endl;
-      }
+  /*
+   * determine equivalance class for edge v.parent() to v
+   * ---------------------------------------------------
+   */
 
-      std::size_t be_idx = t.add_be(v, dest_v, pst::EdgeType::simplifying_back_edge);
-      t.push(v, be_idx);
-      t.get_vertex_mut(v).set_hi(t.get_root_idx());
+  // if v is not the root of the spanning tree
+  if (!t.is_root(v)) {
+    pst::Bracket& b = t.top(v);
 
-      in_hairpin = true;
+    if (t.list_size(v) !=  b.recent_size()) {
+      b.set_recent_size(t.list_size(v));
+      b.set_recent_class(ctx.new_class());
     }
-    else if (in_hairpin) {
 
-      pst::Bracket& b = t.top(v);
+    // when retreating out of a node the tree edge is labelled with
+    // the class of the topmost bracket in the bracket stack
+    pst::Edge& e = t.get_incoming_edge(v);
+    e.set_class_idx(b.recent_class());
 
+    /*check for e, b equivalance*/
+    if (b.recent_size() == 1) {
       std::size_t b_id = b.back_edge_id();
-      pst::BackEdge &be = t.get_backedge_ref_given_id(b_id);
-      if (be.type() == pst::EdgeType::simplifying_back_edge) {
-        boundary = v;
-      }
-
+      pst::BackEdge& be = t.get_backedge_ref_given_id(b_id);
+      be.set_class(e.get_class_idx());
     }
+  }
 
+  return flags;
+}
 
+/**
+ * @brief cycle equivalence with the large enough subtrees done as tasks
+ *
+ * Sibling subtrees don't share brackets until they are concatenated at their
+ * common ancestor. The largest subtrees of at most a grain of vertices are
+ * handed to the scheduler, the vertices above them are then done serially in
+ * reverse DFS order, merging at the branching vertices as usual.
+ *
+ * Each task gives out provisional classes from its own range. Every class is
+ * given out in a known position in the reverse DFS order so they are relabelled
+ * to the classes a serial run gives.
+ *
+ * @return false, having done nothing, if there are too few subtrees to share
+ */
+bool parallel_cycle_equiv(pst::Tree& t, unsigned int thread_count, std::size_t min_task_size) {
+  std::size_t n = t.size();
 
-    if (report_time && check_time) {
-      auto end = std::chrono::high_resolution_clock::now();
-      std::chrono::duration<double, std::milli> duration1 = end - start;
-      std::cout << "Block 2 Time: " << duration1.count() << " ms" << std::endl;
-
-      start = std::chrono::high_resolution_clock::now();
-    }
+  // the subtree of v is the dfs nums [v, v + sub[v])
+  std::vector<std::size_t> sub(n, 1);
+  for (std::size_t v{n - 1}; v < pc::INVALID_IDX; --v) {
+    for (std::size_t c : t.get_children(v)) { sub[v] += sub[c]; }
+  }
 
-    /*
-     * determine equivalance class for edge v.parent() to v
-     * ---------------------------------------------------
-     */
+  std::size_t grain = std::max(min_task_size, n / (4 * static_cast<std::size_t>(thread_count)));
 
-    // if v is not the root of the spanning tree
-    if (!t.is_root(v)) {
+  // the roots of the tasks, ascending so their ranges are too
+  std::vector<std::size_t> roots;
+  for (std::size_t v{1}; v < n; ++v) {
+    if (sub[v] >= min_task_size && sub[v] <= grain && sub[t.get_parent_v_idx(v)] > grain) {
+      roots.push_back(v);
+    }
+  }
 
-      /*default behavior*/
+  if (roots.size() < 2) { return false; }
+
+  t.reserve_be_slots();
+
+  // a task can give out at most a class for each in back edge, added back edge
+  // and tree edge in its subtree
+  std::vector<ce_context> ctxs;
+  ctxs.reserve(roots.size() + 1);
+  std::vector<std::size_t> task_base;
+  task_base.reserve(roots.size());
+  std::size_t class_base {};
+  for (std::size_t r : roots) {
+    ce_context ctx(t, r, r + sub[r]);
+    ctx.next_class = class_base;
+    ctxs.push_back(std::move(ctx));
+    task_base.push_back(class_base);
+
+    std::size_t ibe_count {};
+    for (std::size_t v{r}; v < r + sub[r]; ++v) { ibe_count += t.get_ibe_idxs(v).size(); }
+    class_base += ibe_count + 2 * sub[r];
+  }
 
+  std::vector<std::uint8_t> flags(n, 0);
 
-      pst::Bracket& b = t.top(v);
+  std::vector<povu::scheduler::task> tasks;
+  tasks.reserve(roots.size());
+  for (std::size_t k{}; k < roots.size(); ++k) {
+    tasks.push_back({sub[roots[k]], [&, k] {
+      ce_context& ctx = ctxs[k];
+      for (std::size_t v{ctx.hi}; v > ctx.lo; --v) { flags[v - 1] = cycle_equiv_vertex(t, v - 1, ctx); }
+    }});
+  }
+  povu::scheduler::run(std::move(tasks), thread_count);
 
-    if (report_time && check_time) {
-      auto end = std::chrono::high_resolution_clock::now();
-      std::chrono::duration<double, std::milli> duration1 = end - start;
-      std::cout << "Block 3 a Time: " << duration1.count() << " ms" << std::endl;
+  for (ce_context& ctx : ctxs) {
+    for (std::size_t be_idx : ctx.escaped) { t.chain_added_be(be_idx); }
+  }
 
-      start = std::chrono::high_resolution_clock::now();
+  // the vertices above the tasks, noting how many classes the serial part
+  // had given out as it skips each task
+  ce_context& top = ctxs.emplace_back(t, 0, n);
+  top.next_class = class_base;
+  top.sort_added = true;
+
+  std::vector<std::size_t> skipped_at(roots.size());
+  std::size_t k { roots.size() - 1 };
+  for (std::size_t v{n - 1}; v < pc::INVALID_IDX; --v) {
+    if (k < roots.size() && v == ctxs[k].hi - 1) {
+      skipped_at[k] = top.next_class;
+      v = ctxs[k].lo;
+      --k;
+      continue;
     }
+    flags[v] = cycle_equiv_vertex(t, v, top);
+  }
 
+  // the provisional classes in the order a serial run gives them out: the
+  // vertices above the last task, the last task, the vertices between it and
+  // the task before it and so on
+  struct class_range { std::size_t base; std::size_t relabelled; };
+  std::vector<class_range> ranges;
+  std::size_t class_count {};
+
+  auto take = [&](std::size_t from, std::size_t to) {
+    if (from == to) { return; }
+    ranges.push_back({from, class_count});
+    class_count += to - from;
+  };
+
+  std::size_t serial_from { class_base };
+  for (std::size_t i{roots.size() - 1}; i < pc::INVALID_IDX; --i) {
+    take(serial_from, skipped_at[i]);
+    serial_from = skipped_at[i];
+    take(task_base[i], ctxs[i].next_class);
+  }
+  take(serial_from, top.next_class);
 
-      if (t.list_size(v) !=  b.recent_size()) {
-        b.set_recent_size(t.list_size(v));
-        b.set_recent_class(t.new_class());
-      }
+  std::sort(ranges.begin(), ranges.end(),
+            [](const class_range& a, const class_range& b) { return a.base < b.base; });
 
+  t.relabel_classes([&](std::size_t c) {
+    auto it = std::upper_bound(ranges.begin(), ranges.end(), c,
+                               [](std::size_t c, const class_range& r) { return c < r.base; });
+    --it;
+    return it->relabelled + (c - it->base);
+  }, class_count);
 
-      // when retreating out of a node the tree edge is labelled with
-      // the class of the topmost bracket in the bracket stack
-      pst::Edge& e = t.get_incoming_edge(v);
-      e.set_class_idx(b.recent_class());
+  t.compact_be_slots();
 
-      if (report_time && check_time) {
-        auto end = std::chrono::high_resolution_clock::now();
-        std::chrono::duration<double, std::milli> duration1 = end - start;
-        std::cout << "Block 3 b Time: " << duration1.count() << " ms" << std::endl;
+  hairpin_tracker hairpins;
+  for (std::size_t v{n - 1}; v < pc::INVALID_IDX; --v) { hairpins.visit(t, v, flags[v]); }
 
-        start = std::chrono::high_resolution_clock::now();
-      }
+  return true;
+}
 
-      /*check for e, b equivalance*/
-      if (b.recent_size() == 1) {
-        std::size_t b_id = b.back_edge_id();
-        pst::BackEdge& be = t.get_backedge_ref_given_id(b_id);
-        be.set_class(e.get_class_idx());
-      }
-    }
+} // namespace
 
-    if (report_time && check_time) {
-      auto end = std::chrono::high_resolution_clock::now();
-      std::chrono::duration<double, std::milli> duration1 = end - start;
-      std::cout << "Block 3 Time: " << duration1.count() << " ms" << std::endl;
 
-      start = std::chrono::high_resolution_clock::now();
-      check_time = false;
-    }
+/**
+ * Compute the equivalance class of a given vertex
+ * Find the cycle equivalent edges
+ * in reverse DFS
+ */
+bool eulerian_cycle_equiv(pst::Tree &t, unsigned int thread_count, std::size_t parallel_min_size,
+                          std::size_t min_task_size) {
+  std::string fn_name = std::format("[povu::algorithms::{}]", __func__);
 
+  if (thread_count > 1 && t.size() >= parallel_min_size && parallel_cycle_equiv(t, thread_count, min_task_size)) {
+    return true;
+  }
 
-    //std::cout << "\tfinished loop" << std::endl;
+  ce_context ctx(t);
+  hairpin_tracker hairpins;
+
+  for (std::size_t v { t.size() - 1 }; v < pc::UNDEFINED_SIZE_T; --v) {
+    hairpins.visit(t, v, cycle_equiv_vertex(t, v, ctx));
   }
 
+  return false;
 }
 
 
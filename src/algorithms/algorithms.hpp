@@ -1,6 +1,8 @@
 #ifndef PV_ALGOS_HPP
 #define PV_ALGOS_HPP
 
+#include <cstddef>
+
 //#include <vector>
 
 //#include "../common/types.hpp"
@@ -12,10 +14,23 @@ namespace povu::algorithms {
 namespace pst = povu::spanning_tree;
 
 
+// below this many vertices a tree is always handled serially
+const std::size_t CYCLE_EQUIV_PARALLEL_MIN_SIZE { 1 << 16 };
+// the smallest subtree worth a task of its own
+const std::size_t CYCLE_EQUIV_MIN_TASK_SIZE { 1 << 12 };
+
 /**
- * @brief
+ * @brief assign the cycle equivalence class of every tree and back edge
+ *
+ * with more than one thread trees of at least parallel_min_size vertices have
+ * their subtrees of at least min_task_size vertices done in parallel, the
+ * classes are the same as those of a serial run
+ *
+ * @return true if subtrees were done in parallel
  */
-void eulerian_cycle_equiv(pst::Tree &t);
+bool eulerian_cycle_equiv(pst::Tree &t, unsigned int thread_count = 1,
+                          std::size_t parallel_min_size = CYCLE_EQUIV_PARALLEL_MIN_SIZE,
+                          std::size_t min_task_size = CYCLE_EQUIV_MIN_TASK_SIZE);
 
 } // namespace povu::algorithms
 
@@ -12,6 +12,12 @@ std::ostream& operator<<(std::ostream& os, const task_t& t)  {
     case task_t::info:
       os << "info";
       break;
+    case task_t::index:
+      os << "index";
+      break;
+    case task_t::convert:
+      os << "convert";
+      break;
     default:
       os << "unknown";
       break;
@@ -26,6 +26,8 @@ enum class task_t {
   call,        // call variants
   deconstruct, // deconstruct a graph
   info,        // print graph information
+  index,       // write a binary pvg index of a gfa
+  convert,     // convert a flubble forest between flb and pft
   unset        // unset
 };
 
@@ -53,12 +55,19 @@ struct config {
   std::string chrom;
   //std::optional<std::filesystem::path> pvst_path;
   std::filesystem::path output_dir; // output directory for task and deconstruct
+  std::filesystem::path index_path; // output file for index
+  std::filesystem::path convert_path; // output of convert, a pft file or a dir of flb files
 
   // general
   unsigned char v; // verbosity
   bool print_dot_ { true }; // generate dot format graphs
 
   unsigned int thread_count_ {1}; // number of threads to use
+  bool compact_chains_ { false }; // collapse unbranched chains before deconstructing
+  bool sort_graph_ { false }; // put the vertices in breadth first order before processing
+  std::size_t max_mem_ { 0 }; // bytes the components being deconstructed may take at once, 0 is no limit
+  bool forest_file_ { false }; // write the flubble forest into a single indexed file
+  bool haplotype_sweep_ { false }; // find the walks through the flubbles by walking the haplotypes
 
   // references
   std::string references_txt; // the path to the file containing the reference paths
@@ -88,6 +97,8 @@ struct config {
   std::string get_input_gfa() const { return this->input_gfa; }
   std::filesystem::path get_forest_dir() const { return this->forest_dir; }
   std::filesystem::path get_output_dir() const { return this->output_dir; }
+  std::filesystem::path get_index_path() const { return this->index_path; }
+  std::filesystem::path get_convert_path() const { return this->convert_path; }
   const std::string& get_chrom() const { return this->chrom; }
   std::vector<std::string> const& get_reference_paths() const { return this->reference_paths; }
   std::vector<std::string>* get_reference_ptr() { return &this->reference_paths; }
@@ -95,6 +106,11 @@ struct config {
   std::size_t verbosity() const { return this->v; } // can we avoid this being a size_t?
   unsigned int thread_count() const { return this->thread_count_; }
   bool print_dot() const { return this->print_dot_; }
+  bool compact_chains() const { return this->compact_chains_; }
+  bool sort_graph() const { return this->sort_graph_; }
+  std::size_t max_mem() const { return this->max_mem_; }
+  bool forest_file() const { return this->forest_file_; }
+  bool haplotype_sweep() const { return this->haplotype_sweep_; }
   bool gen_undefined_vcf() const { return this->undefined_vcf; }
   task_t get_task() const { return this->task; }
 
@@ -111,9 +127,16 @@ struct config {
   void set_verbosity(unsigned char v) { this->v = v; }
   void set_thread_count(uint8_t t) { this->thread_count_ = t; }
   void set_print_dot(bool b) { this->print_dot_ = b; }
+  void set_compact_chains(bool b) { this->compact_chains_ = b; }
+  void set_sort_graph(bool b) { this->sort_graph_ = b; }
+  void set_max_mem(std::size_t bytes) { this->max_mem_ = bytes; }
+  void set_forest_file(bool b) { this->forest_file_ = b; }
+  void set_haplotype_sweep(bool b) { this->haplotype_sweep_ = b; }
   void set_input_gfa(std::string s) { this->input_gfa = s; }
   void set_forest_dir(std::string s) { this->forest_dir = s; }
   void set_output_dir(std::string s) { this->output_dir = s; }
+  void set_index_path(std::string s) { this->index_path = s; }
+  void set_convert_path(std::string s) { this->convert_path = s; }
   void set_task(task_t t) { this->task = t; }
   void set_undefined_vcf(bool b) { this->undefined_vcf = b; }
 
@@ -129,6 +152,23 @@ struct config {
     std::cerr << "\t" << "input gfa: " << this->input_gfa << std::endl;
     std::cerr << "\t" << "forest dir: " << this->forest_dir << std::endl;
     std::cerr << "\t" << "output dir: " << this->output_dir << std::endl;
+    if (this->task == task_t::index) {
+      std::cerr << "\t" << "index path: " << this->index_path << std::endl;
+    }
+    if (this->task == task_t::convert) {
+      std::cerr << "\t" << "convert path: " << this->convert_path << std::endl;
+    }
+    if (this->task == task_t::deconstruct) {
+      std::cerr << "\t" << "compact chains: " << (this->compact_chains() ? "yes" : "no") << "\n";
+      std::cerr << "\t" << "forest file: " << (this->forest_file() ? "yes" : "no") << "\n";
+      std::cerr << "\t" << "max mem: " << (this->max_mem() ? std::to_string(this->max_mem()) + " bytes" : "no limit") << "\n";
+    }
+    if (this->task == task_t::deconstruct || this->task == task_t::call) {
+      std::cerr << "\t" << "sort graph: " << (this->sort_graph() ? "yes" : "no") << "\n";
+    }
+    if (this->task == task_t::call) {
+      std::cerr << "\t" << "haplotype sweep: " << (this->haplotype_sweep() ? "yes" : "no") << "\n";
+    }
     std::cerr << "\t" << "chrom: " << this->chrom << std::endl;
     std::cerr << "\t" << "Generate undefined vcf: " << std::boolalpha << this->undefined_vcf << std::endl;
     if (this->ref_input_format == input_format_t::file_path) {
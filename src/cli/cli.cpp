@@ -1,3 +1,4 @@
+#include <cctype>
 #include <cstddef>
 #include <cstdlib>
 // #include <format>
@@ -52,22 +53,47 @@ void read_lines_to_vector_str(const std::string& fp, std::vector<std::string> *v
 
 
 void fp_to_vector (const std::string& fp, std::vector<std::string>* v) {
-  std::size_t file_size = get_file_size(fp);
-
-  v->reserve(file_size);
   read_lines_to_vector_str(fp, v);
   v->shrink_to_fit();
 }
 
 
+/**
+ * @brief parse a size in bytes, a K, M, G or T suffix multiplies it by a power
+ * of 1024
+ */
+std::size_t parse_size(const std::string& s) {
+  const std::string units { "KMGT" };
+
+  std::size_t pos {};
+  std::size_t n {};
+  try {
+    n = std::stoull(s, &pos);
+  }
+  catch (const std::exception&) {
+    pos = 0;
+  }
+
+  std::size_t unit = pos + 1 == s.size() ? units.find(std::toupper(s[pos])) : std::string::npos;
+  if (pos == 0 || (pos < s.size() && unit == std::string::npos)) {
+    std::cerr << "[cli::parse_size] Error: not a size " << s << std::endl;
+    std::exit(1);
+  }
+
+  return pos == s.size() ? n : n << (10 * (unit + 1));
+}
+
+
 void call_handler(args::Subparser &parser, core::config& app_config) {
   args::Group arguments("arguments");
-  args::ValueFlag<std::string> input_gfa(parser, "gfa", "path to input gfa [required]", {'i', "input-gfa"}, args::Options::Required);
-  args::ValueFlag<std::string> forest_dir(parser, "forest_dir", "dir containing flubble forest [default: .]", {'f', "forest-dir"});
+  args::ValueFlag<std::string> input_gfa(parser, "gfa", "path to input gfa or pvg index [required]", {'i', "input-gfa"}, args::Options::Required);
+  args::ValueFlag<std::string> forest_dir(parser, "forest_dir", "dir containing flubble forest or a flf or pft forest file [default: .]", {'f', "forest-dir"});
   args::ValueFlag<std::string> output_dir(parser, "output_dir", "Output directory [default: .]", {'o', "output-dir"});
   args::ValueFlag<std::string> ref_list(parser, "ref_list", "path to txt file containing reference haplotypes [optional]", {'p', "path-list"});
   args::ValueFlag<std::string> chrom(parser, "chrom", "graph identifier, default is from GFA file. Chrom column in VCF [optional]", {'c', "chrom"});
   args::Flag undefined_vcf(parser, "undefined_vcf", "Generate VCF file for flubbles without a reference path [default: false]", {'u', "undefined"});
+  args::Flag sort(parser, "sort", "Put the vertices in breadth first order before calling [default: off]", {"sort"});
+  args::Flag haplotype_sweep(parser, "haplotype_sweep", "Take the walks through each flubble from the haplotypes in one pass over them instead of searching the graph [default: off]", {"haplotype-sweep"});
   args::PositionalList<std::string> pathsList(parser, "paths", "list of paths to use as reference haplotypes [optional]");
 
   parser.Parse();
@@ -97,6 +123,14 @@ void call_handler(args::Subparser &parser, core::config& app_config) {
     app_config.set_undefined_vcf(true);
   }
 
+  if (sort) {
+    app_config.set_sort_graph(true);
+  }
+
+  if (haplotype_sweep) {
+    app_config.set_haplotype_sweep(true);
+  }
+
   // either ref list or path list
   // if ref list is not set, then path list must be set
   // -------------
@@ -124,8 +158,12 @@ void call_handler(args::Subparser &parser, core::config& app_config) {
 
 void deconstruct_handler(args::Subparser &parser, core::config& app_config) {
   args::Group arguments("arguments");
-  args::ValueFlag<std::string> input_gfa(parser, "gfa", "path to input gfa [required]", {'i', "input-gfa"}, args::Options::Required);
+  args::ValueFlag<std::string> input_gfa(parser, "gfa", "path to input gfa or pvg index [required]", {'i', "input-gfa"}, args::Options::Required);
   args::ValueFlag<std::string> output_dir(parser, "output_dir", "Output directory [default: .]", {'o', "output-dir"});
+  args::Flag compact(parser, "compact", "Collapse unbranched chains of vertices before deconstructing [default: off]", {"compact"});
+  args::Flag sort(parser, "sort", "Put the vertices of each component in breadth first order before deconstructing [default: off]", {"sort"});
+  args::Flag forest_file(parser, "forest_file", "Write the flubble forest into a single indexed file forest.flf instead of a .flb file per component [default: off]", {"forest-file"});
+  args::ValueFlag<std::string> max_mem(parser, "max_mem", "Memory the components being deconstructed may take at once e.g. 64G, a hint [default: no limit]", {"max-mem"});
 
   parser.Parse();
   app_config.set_task(core::task_t::deconstruct);
@@ -135,12 +173,28 @@ void deconstruct_handler(args::Subparser &parser, core::config& app_config) {
   if (output_dir) {
     app_config.set_output_dir(args::get(output_dir));
   }
+
+  if (compact) {
+    app_config.set_compact_chains(true);
+  }
+
+  if (sort) {
+    app_config.set_sort_graph(true);
+  }
+
+  if (forest_file) {
+    app_config.set_forest_file(true);
+  }
+
+  if (max_mem) {
+    app_config.set_max_mem(parse_size(args::get(max_mem)));
+  }
 }
 
 
 void info_handler(args::Subparser &parser, core::config& app_config) {
   args::Group arguments("arguments");
-  args::ValueFlag<std::string> input_gfa(parser, "gfa", "path to input gfa [required]", {'i', "input-gfa"}, args::Options::Required);
+  args::ValueFlag<std::string> input_gfa(parser, "gfa", "path to input gfa or pvg index [required]", {'i', "input-gfa"}, args::Options::Required);
 
   parser.Parse();
   app_config.set_task(core::task_t::info);
@@ -149,6 +203,50 @@ void info_handler(args::Subparser &parser, core::config& app_config) {
 }
 
 
+void index_handler(args::Subparser &parser, core::config& app_config) {
+  args::Group arguments("arguments");
+  args::ValueFlag<std::string> input_gfa(parser, "gfa", "path to input gfa [required]", {'i', "input-gfa"}, args::Options::Required);
+  args::ValueFlag<std::string> output(parser, "output", "path to the output index [default: <input stem>.pvg]", {'o', "output"});
+
+  parser.Parse();
+  app_config.set_task(core::task_t::index);
+  // input gfa is already a c_str
+  app_config.set_input_gfa(args::get(input_gfa));
+
+  if (output) {
+    app_config.set_index_path(args::get(output));
+  }
+  else {
+    std::filesystem::path filePath(app_config.get_input_gfa());
+    app_config.set_index_path(filePath.stem().string() + ".pvg");
+  }
+}
+
+
+void convert_handler(args::Subparser &parser, core::config& app_config) {
+  args::Group arguments("arguments");
+  args::ValueFlag<std::string> input(parser, "input", "a flb file, a dir of flb files, a flf or a pft file [required]", {'i', "input"}, args::Options::Required);
+  args::ValueFlag<std::string> output(parser, "output", "the pft file, or the dir to write the flb files into for a pft input [default: <input stem>.pft or .]", {'o', "output"});
+
+  parser.Parse();
+  app_config.set_task(core::task_t::convert);
+  app_config.set_forest_dir(args::get(input));
+
+  std::filesystem::path filePath(args::get(input));
+  if (output) {
+    app_config.set_convert_path(args::get(output));
+  }
+  else if (filePath.extension() == ".pft") {
+    app_config.set_convert_path(".");
+  }
+  else {
+    // a dir given with a trailing slash has no stem of its own
+    std::string stem = filePath.has_stem() ? filePath.stem().string() : filePath.parent_path().stem().string();
+    app_config.set_convert_path(stem + ".pft");
+  }
+}
+
+
 int cli(int argc, char **argv, core::config& app_config) {
 
   args::ArgumentParser p("Use cycle equivalence to call variants");
@@ -160,6 +258,10 @@ int cli(int argc, char **argv, core::config& app_config) {
                        [&](args::Subparser &parser) { info_handler(parser, app_config); });
   args::Command call(commands, "call", "[subcommand under development please do not use]",
                        [&](args::Subparser &parser) { call_handler(parser, app_config); });
+  args::Command index(commands, "index", "Write a binary pvg index of the graph for faster loading",
+                       [&](args::Subparser &parser) { index_handler(parser, app_config); });
+  args::Command convert(commands, "convert", "Convert a flubble forest between flb and the binary pft format",
+                       [&](args::Subparser &parser) { convert_handler(parser, app_config); });
 
   args::Group arguments(p, "arguments", args::Group::Validators::DontCare, args::Options::Global);
   args::Flag version(arguments, "version", "The current version of povu", {"version"});
@@ -0,0 +1,78 @@
+#include <algorithm>
+#include <cstdint>
+
+#include "./arena.hpp"
+
+namespace povu::arena {
+
+namespace {
+// the size of the first block of an arena
+const std::size_t MIN_BLOCK_SIZE { 1 << 16 };
+// a reset keeps at most this many bytes
+const std::size_t MAX_KEPT_SIZE { 1 << 26 };
+} // namespace
+
+
+void Arena::add_block(std::size_t size) {
+  this->blocks_.push_back(std::make_unique_for_overwrite<std::byte[]>(size));
+  this->block_sizes_.push_back(size);
+  ++this->upstream_calls_;
+}
+
+void* Arena::do_allocate(std::size_t bytes, std::size_t alignment) {
+  auto aligned = [&](std::size_t b) -> std::size_t {
+    auto base = reinterpret_cast<std::uintptr_t>(this->blocks_[b].get());
+    return ((base + this->offset_ + alignment - 1) & ~(alignment - 1)) - base;
+  };
+
+  // move on to the next block, making one if none is left, until it fits
+  while (this->cur_ >= this->blocks_.size() || aligned(this->cur_) + bytes > this->block_sizes_[this->cur_]) {
+    if (this->cur_ < this->blocks_.size()) { ++this->cur_; }
+    this->offset_ = 0;
+
+    if (this->cur_ == this->blocks_.size()) {
+      std::size_t last = this->block_sizes_.empty() ? MIN_BLOCK_SIZE / 2 : this->block_sizes_.back();
+      this->add_block(std::max(2 * last, bytes + alignment));
+    }
+  }
+
+  std::size_t start = aligned(this->cur_);
+  this->offset_ = start + bytes;
+  this->used_ += bytes;
+
+  return this->blocks_[this->cur_].get() + start;
+}
+
+void Arena::do_deallocate(void*, std::size_t, std::size_t) {}
+
+bool Arena::do_is_equal(const std::pmr::memory_resource& other) const noexcept { return this == &other; }
+
+void Arena::reset() {
+  std::size_t total = this->capacity();
+  if (this->blocks_.size() > 1 || total > MAX_KEPT_SIZE) {
+    this->blocks_.clear();
+    this->block_sizes_.clear();
+    this->add_block(std::min(total, MAX_KEPT_SIZE));
+  }
+
+  this->cur_ = 0;
+  this->offset_ = 0;
+  this->used_ = 0;
+}
+
+std::size_t Arena::capacity() const {
+  std::size_t total {};
+  for (std::size_t s : this->block_sizes_) { total += s; }
+  return total;
+}
+
+std::size_t Arena::used() const { return this->used_; }
+std::size_t Arena::upstream_calls() const { return this->upstream_calls_; }
+
+
+Arena& local() {
+  thread_local Arena a;
+  return a;
+}
+
+} // namespace povu::arena
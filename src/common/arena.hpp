@@ -0,0 +1,80 @@
+#ifndef POVU_ARENA_HPP
+#define POVU_ARENA_HPP
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+
+namespace povu::arena {
+
+/**
+ * @brief a bump allocator for the scratch of a single component
+ *
+ * Allocations are carved out of large blocks and deallocate is a no-op, the
+ * memory is only taken back by reset(). A reset keeps the memory for the next
+ * component so once a worker has seen a component of a given size, the ones
+ * up to that size cost no calls to malloc at all.
+ *
+ * An arena is not thread safe, each worker thread has its own, see local().
+ */
+class Arena : public std::pmr::memory_resource {
+  std::vector<std::unique_ptr<std::byte[]>> blocks_;
+  std::vector<std::size_t> block_sizes_;
+  std::size_t cur_ {};    // the block allocations come from
+  std::size_t offset_ {}; // the first free byte in it
+
+  std::size_t used_ {};   // bytes handed out since the last reset
+  std::size_t upstream_calls_ {};
+
+  void add_block(std::size_t size);
+
+protected:
+  void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+  void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override;
+  bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+public:
+  Arena() = default;
+  Arena(const Arena&) = delete;
+  Arena& operator=(const Arena&) = delete;
+
+  /**
+   * @brief take back everything handed out, nothing allocated from the arena
+   * may be used after
+   *
+   * The blocks are merged into one as big as all of them put together, up to
+   * a cap past which the memory is given back to the system.
+   */
+  void reset();
+
+  // bytes handed out since the last reset
+  std::size_t used() const;
+  // bytes reserved from the system
+  std::size_t capacity() const;
+  // the number of blocks allocated from the system so far
+  std::size_t upstream_calls() const;
+};
+
+/**
+ * @brief the arena of the calling thread
+ */
+Arena& local();
+
+/**
+ * @brief resets an arena when it goes out of scope
+ */
+class scope {
+  Arena& a_;
+
+public:
+  explicit scope(Arena& a) : a_(a) {}
+  scope(const scope&) = delete;
+  scope& operator=(const scope&) = delete;
+  ~scope() { this->a_.reset(); }
+};
+
+} // namespace povu::arena
+
+#endif
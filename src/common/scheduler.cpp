@@ -0,0 +1,125 @@
+#include <algorithm>
+#include <deque>
+#include <exception>
+#include <format>
+#include <mutex>
+#include <thread>
+
+#include "./scheduler.hpp"
+#include "./types.hpp"
+
+namespace povu::scheduler {
+namespace pt = povu::types;
+
+namespace {
+// a worker's queue of task indexes, ordered largest first
+struct work_queue {
+  std::mutex m;
+  std::deque<std::size_t> q;
+
+  bool pop(std::size_t& t_idx) {
+    std::lock_guard<std::mutex> lock(this->m);
+    if (this->q.empty()) { return false; }
+    t_idx = this->q.front();
+    this->q.pop_front();
+    return true;
+  }
+};
+} // namespace
+
+
+std::vector<thread_stats> run(std::vector<task>&& tasks, unsigned int thread_count) {
+  std::size_t worker_count = std::max<std::size_t>(1, std::min<std::size_t>(thread_count, tasks.size()));
+
+  std::vector<std::size_t> order(tasks.size());
+  for (std::size_t i {}; i < order.size(); ++i) { order[i] = i; }
+  std::stable_sort(order.begin(), order.end(),
+                   [&](std::size_t a, std::size_t b) { return tasks[a].cost > tasks[b].cost; });
+
+  std::vector<work_queue> queues(worker_count);
+  for (std::size_t i {}; i < order.size(); ++i) { queues[i % worker_count].q.push_back(order[i]); }
+
+  std::vector<thread_stats> stats(worker_count);
+  std::exception_ptr error;
+  std::mutex error_mutex;
+
+  auto work = [&](std::size_t w) {
+    thread_stats& st = stats[w];
+    std::size_t t_idx;
+
+    while (true) {
+      bool stolen { false };
+      bool found = queues[w].pop(t_idx);
+
+      // steal the largest pending task, trying the other workers in turn
+      for (std::size_t i { 1 }; !found && i < worker_count; ++i) {
+        found = stolen = queues[(w + i) % worker_count].pop(t_idx);
+      }
+
+      if (!found) { return; }
+
+      auto t0 = pt::Time::now();
+      try {
+        tasks[t_idx].run();
+      }
+      catch (...) {
+        std::lock_guard<std::mutex> lock(error_mutex);
+        if (!error) { error = std::current_exception(); }
+      }
+      st.busy += pt::Time::now() - t0;
+
+      ++st.task_count;
+      st.cost += tasks[t_idx].cost;
+      if (stolen) { ++st.stolen; }
+    }
+  };
+
+  if (worker_count == 1) {
+    work(0);
+  }
+  else {
+    std::vector<std::thread> threads;
+    threads.reserve(worker_count);
+    for (std::size_t w {}; w < worker_count; ++w) { threads.emplace_back(work, w); }
+    for (std::thread& t : threads) { t.join(); }
+  }
+
+  if (error) { std::rethrow_exception(error); }
+
+  return stats;
+}
+
+
+void report(std::ostream& os, const std::string& fn_name, const std::vector<thread_stats>& stats,
+            std::chrono::duration<double> wall, bool stealing) {
+  for (std::size_t w {}; w < stats.size(); ++w) {
+    const thread_stats& st = stats[w];
+    double util = wall.count() > 0 ? 100.0 * st.busy.count() / wall.count() : 100.0;
+    std::string stolen = stealing ? std::format("{} stolen, ", st.stolen) : "";
+    os << std::format("{} INFO thread {}: {} task(s), {}cost {}, busy {:.2f} of {:.2f} sec ({:.1f}%)\n",
+                      fn_name, w, st.task_count, stolen, st.cost, st.busy.count(), wall.count(), util);
+  }
+}
+
+
+void budget::acquire(std::size_t n) {
+  std::unique_lock<std::mutex> lock(this->m_);
+  this->freed_.wait(lock, [&] {
+    return this->limit_ == 0 || this->held_ == 0 || this->held_ + n <= this->limit_;
+  });
+  this->held_ += n;
+  this->peak_ = std::max(this->peak_, this->held_);
+}
+
+void budget::release(std::size_t n) {
+  std::lock_guard<std::mutex> lock(this->m_);
+  this->held_ -= n;
+  this->freed_.notify_all();
+}
+
+std::size_t budget::peak() {
+  std::lock_guard<std::mutex> lock(this->m_);
+  return this->peak_;
+}
+
+} // namespace povu::scheduler
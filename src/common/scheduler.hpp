@@ -0,0 +1,128 @@
+#ifndef POVU_SCHEDULER_HPP
+#define POVU_SCHEDULER_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+
+namespace povu::scheduler {
+
+/**
+ * a unit of work and an estimate of how long it takes relative to the others
+ */
+struct task {
+  std::size_t cost;
+  std::function<void()> run;
+};
+
+/**
+ * what one worker thread did
+ */
+struct thread_stats {
+  std::size_t task_count { 0 };
+  std::size_t stolen { 0 };           // tasks taken from another worker's queue
+  std::size_t cost { 0 };             // sum of the estimated costs of the tasks run
+  std::chrono::duration<double> busy { 0 };
+};
+
+/**
+ * @brief run tasks across thread_count worker threads
+ *
+ * Tasks are sorted by cost, largest first, and dealt round robin into one
+ * queue per worker. A worker runs its own queue from the front and once it is
+ * empty steals the largest pending task of another worker, so a few large tasks
+ * among many small ones don't leave threads idle.
+ *
+ * If a task throws the first exception is rethrown once all workers are done.
+ *
+ * @return the stats of each worker
+ */
+std::vector<thread_stats> run(std::vector<task>&& tasks, unsigned int thread_count);
+
+/**
+ * @brief print a per-thread utilisation summary of a run, the stolen count only
+ * means something for run so it is left out unless stealing is true
+ */
+void report(std::ostream& os, const std::string& fn_name, const std::vector<thread_stats>& stats,
+            std::chrono::duration<double> wall, bool stealing = true);
+
+/**
+ * @brief a FIFO between the stages of a pipeline that holds at most capacity
+ * items, a producer that gets ahead of its consumers waits
+ *
+ * Once the producers are done they close the queue, pop then drains what is
+ * left and returns false.
+ */
+template <typename T> class bounded_queue {
+  std::mutex m_;
+  std::condition_variable not_full_;
+  std::condition_variable not_empty_;
+  std::deque<T> q_;
+  std::size_t capacity_;
+  bool closed_ { false };
+
+public:
+  explicit bounded_queue(std::size_t capacity) : capacity_(std::max<std::size_t>(1, capacity)) {}
+
+  void push(T&& x) {
+    std::unique_lock<std::mutex> lock(this->m_);
+    this->not_full_.wait(lock, [&] { return this->q_.size() < this->capacity_; });
+    this->q_.push_back(std::move(x));
+    this->not_empty_.notify_one();
+  }
+
+  // false once the queue is closed and empty
+  bool pop(T& x) {
+    std::unique_lock<std::mutex> lock(this->m_);
+    this->not_empty_.wait(lock, [&] { return !this->q_.empty() || this->closed_; });
+    if (this->q_.empty()) { return false; }
+
+    x = std::move(this->q_.front());
+    this->q_.pop_front();
+    this->not_full_.notify_one();
+    return true;
+  }
+
+  void close() {
+    std::lock_guard<std::mutex> lock(this->m_);
+    this->closed_ = true;
+    this->not_empty_.notify_all();
+  }
+};
+
+/**
+ * @brief an amount, bytes or a count, that the jobs in flight may hold between
+ * them
+ *
+ * acquire waits until the amount asked for fits under the limit. It is always
+ * let through when nothing is held so a job larger than the limit still runs,
+ * on its own. A limit of 0 means no limit.
+ */
+class budget {
+  std::mutex m_;
+  std::condition_variable freed_;
+  std::size_t limit_;
+  std::size_t held_ { 0 };
+  std::size_t peak_ { 0 };
+
+public:
+  explicit budget(std::size_t limit) : limit_(limit) {}
+
+  void acquire(std::size_t n);
+  void release(std::size_t n);
+
+  // the most held at once
+  std::size_t peak();
+};
+
+} // namespace povu::scheduler
+
+#endif
@@ -1,7 +1,134 @@
+#include <algorithm>
+#include <bit>
 #include <iostream>
 
 #include "./types.hpp"
 
+namespace povu::types {
+namespace pc = povu::constants;
+
+/*
+ * IdMap
+ * -----
+ */
+namespace {
+// the id range stays dense while it spans at most 2 slots per id plus this slack
+const std::size_t DENSE_SLACK { 1 << 16 };
+
+bool is_dense_range(std::size_t min_id, std::size_t max_id, std::size_t count) {
+  return max_id - min_id < 2 * count + DENSE_SLACK;
+}
+
+bool is_pow_2(std::size_t n) { return n > 0 && (n & (n - 1)) == 0; }
+} // namespace
+
+void IdMap::reserve(std::size_t n) {
+  this->reserved_ = std::max(this->reserved_, n);
+  this->idx_to_id_.reserve(n);
+  if (this->dense_) { this->id_to_idx_.reserve(n); }
+  else if (2 * n > this->keys_.size()) { this->rehash(std::bit_ceil(2 * n)); }
+}
+
+void IdMap::insert(std::size_t id, std::size_t idx) {
+  if (idx >= this->idx_to_id_.size()) { this->idx_to_id_.resize(idx + 1, pc::INVALID_ID); }
+  this->idx_to_id_[idx] = id;
+
+  bool is_new = !this->has_id(id);
+  if (is_new) { ++this->count_; }
+
+  this->min_id_ = std::min(this->min_id_, id);
+  this->max_id_ = std::max(this->max_id_, id);
+
+  // ids that arrive out of order can make the range look sparse early on, a
+  // size hint from reserve() avoids that
+  std::size_t expected = std::max(this->count_, this->reserved_);
+  if (this->dense_ && !is_dense_range(this->min_id_, this->max_id_, expected)) { this->to_sparse(); }
+
+  if (!this->dense_) {
+    this->insert_sparse(id, idx);
+    if (is_new && is_pow_2(this->count_) && is_dense_range(this->min_id_, this->max_id_, this->count_)) {
+      this->to_dense();
+    }
+    return;
+  }
+
+  if (this->id_to_idx_.empty()) {
+    this->base_ = id;
+  }
+  else if (id < this->base_) {
+    // leave room below for ids that arrive in descending order
+    std::size_t span = this->max_id_ - this->min_id_ + 1;
+    std::size_t new_base = id - std::min(id, span / 2);
+    this->id_to_idx_.insert(this->id_to_idx_.begin(), this->base_ - new_base, pc::INVALID_IDX);
+    this->base_ = new_base;
+  }
+
+  if (id - this->base_ >= this->id_to_idx_.size()) { this->id_to_idx_.resize(id - this->base_ + 1, pc::INVALID_IDX); }
+  this->id_to_idx_[id - this->base_] = idx;
+}
+
+void IdMap::to_sparse() {
+  this->dense_ = false;
+  this->rehash(std::bit_ceil(std::max<std::size_t>(16, 2 * this->count_)));
+
+  for (std::size_t i {}; i < this->id_to_idx_.size(); ++i) {
+    if (this->id_to_idx_[i] != pc::INVALID_IDX) { this->insert_sparse(this->base_ + i, this->id_to_idx_[i]); }
+  }
+
+  this->id_to_idx_ = std::vector<std::size_t>();
+}
+
+void IdMap::to_dense() {
+  this->dense_ = true;
+  this->base_ = this->min_id_;
+  this->id_to_idx_.assign(this->max_id_ - this->min_id_ + 1, pc::INVALID_IDX);
+
+  for (std::size_t i {}; i < this->keys_.size(); ++i) {
+    if (this->keys_[i] != pc::INVALID_ID) { this->id_to_idx_[this->keys_[i] - this->base_] = this->vals_[i]; }
+  }
+
+  this->keys_ = std::vector<std::size_t>();
+  this->vals_ = std::vector<std::size_t>();
+  this->shift_ = 64;
+}
+
+void IdMap::rehash(std::size_t table_size) {
+  std::vector<std::size_t> keys = std::move(this->keys_);
+  std::vector<std::size_t> vals = std::move(this->vals_);
+
+  this->keys_.assign(table_size, pc::INVALID_ID);
+  this->vals_.assign(table_size, pc::INVALID_IDX);
+  this->shift_ = 64 - std::countr_zero(table_size);
+
+  for (std::size_t i {}; i < keys.size(); ++i) {
+    if (keys[i] != pc::INVALID_ID) { this->insert_sparse(keys[i], vals[i]); }
+  }
+}
+
+void IdMap::insert_sparse(std::size_t id, std::size_t idx) {
+  // keep the load factor at or below 1/2
+  if (2 * this->count_ > this->keys_.size()) { this->rehash(2 * this->keys_.size()); }
+
+  std::size_t mask = this->keys_.size() - 1;
+  std::size_t s = this->slot(id);
+  while (this->keys_[s] != pc::INVALID_ID && this->keys_[s] != id) { s = (s + 1) & mask; }
+  this->keys_[s] = id;
+  this->vals_[s] = idx;
+}
+
+std::size_t IdMap::get_sparse(std::size_t id) const {
+  if (this->keys_.empty()) { return pc::INVALID_IDX; }
+
+  std::size_t mask = this->keys_.size() - 1;
+  for (std::size_t s { this->slot(id) }; this->keys_[s] != pc::INVALID_ID; s = (s + 1) & mask) {
+    if (this->keys_[s] == id) { return this->vals_[s]; }
+  }
+  return pc::INVALID_IDX;
+}
+
+} // namespace povu::types
+
+
 namespace povu::graph_types {
 
 std::ostream& operator<<(std::ostream& os, const VertexType& vt) {
@@ -100,6 +227,10 @@ std::ostream& operator<<(std::ostream& os, const orientation_t& o) {
 
   return os;
 }
+std::string vertex_name(std::size_t v_id) {
+  return v_id == constants::DUMMY_VERTEX_ID ? constants::DUMMY_VERTEX_NAME : std::to_string(v_id);
+}
+
 std::string or_to_str (orientation_t o) {
   return o == orientation_t::forward ? ">" : "<";
 };
@@ -3,6 +3,7 @@
 
 #include <chrono>
 #include <cstddef>
+#include <cstdint>
 #include <string>
 #include <utility>
 #include <format>
@@ -29,11 +30,13 @@ const int UNDEFINED_INT = std::numeric_limits<int>::min();
 const std::size_t UNDEFINED_SIZE_T = std::numeric_limits<size_t>::max();
 const std::size_t INVALID_ID = UNDEFINED_SIZE_T;
 const std::size_t INVALID_IDX = UNDEFINED_SIZE_T;
+const std::size_t DUMMY_VERTEX_ID = UNDEFINED_SIZE_T - 1; // id of the biedged dummy vertex
 
 // strings
 const std::string EMPTY_SET = "\u2205";
 const std::string UNDEFINED_VALUE = "\u2205";
 const std::string WAVY_ARROW = "\u2933";
+const std::string DUMMY_VERTEX_NAME = "d_s";
 
 // genomics constants
 const std::string UNDEFINED_PATH_LABEL { "undefined" };
@@ -86,6 +89,76 @@ template <typename T> struct unordered_pair{
 };
 
 
+/**
+ * IdMap
+ * -----
+ * maps the ids of vertices (e.g. GFA segment ids) to their index in a graph and
+ * back
+ *
+ * idx -> id is a plain vector. While the ids seen so far fall in a dense range
+ * id -> idx is a flat vector offset by the smallest id, once the range gets too
+ * sparse it moves to an open addressing hash table, and back once enough ids
+ * have filled the range in.
+ * Missing ids and indexes map to povu::constants::INVALID_IDX and INVALID_ID.
+ */
+class IdMap {
+  std::vector<std::size_t> idx_to_id_;
+
+  bool dense_ { true };
+  std::size_t min_id_ { povu::constants::INVALID_ID };
+  std::size_t max_id_ { 0 };
+
+  // dense: slot id - base_ holds the idx
+  std::size_t base_ { 0 };
+  std::vector<std::size_t> id_to_idx_;
+
+  // sparse: linear probing over a power of two table, empty keys are INVALID_ID
+  std::vector<std::size_t> keys_;
+  std::vector<std::size_t> vals_;
+  unsigned shift_ { 64 };
+
+  std::size_t count_ { 0 };
+  std::size_t reserved_ { 0 };
+
+  std::size_t slot(std::size_t id) const {
+    return static_cast<std::size_t>((id * 0x9E3779B97F4A7C15ULL) >> this->shift_);
+  }
+
+  void to_sparse();
+  void to_dense();
+  void rehash(std::size_t table_size);
+  void insert_sparse(std::size_t id, std::size_t idx);
+  std::size_t get_sparse(std::size_t id) const;
+
+public:
+  IdMap() = default;
+
+  // ---------
+  // getter(s)
+  // ---------
+  std::size_t get_idx(std::size_t id) const {
+    if (!this->dense_) { return this->get_sparse(id); }
+    return (id >= this->base_ && id - this->base_ < this->id_to_idx_.size())
+      ? this->id_to_idx_[id - this->base_]
+      : povu::constants::INVALID_IDX;
+  }
+
+  std::size_t get_id(std::size_t idx) const {
+    return idx < this->idx_to_id_.size() ? this->idx_to_id_[idx] : povu::constants::INVALID_ID;
+  }
+
+  bool has_id(std::size_t id) const { return this->get_idx(id) != povu::constants::INVALID_IDX; }
+  std::size_t size() const { return this->count_; }
+  bool is_dense() const { return this->dense_; }
+
+  // ---------------------
+  // setter(s) & modifiers
+  // ---------------------
+  void reserve(std::size_t n);
+  void insert(std::size_t id, std::size_t idx);
+};
+
+
 
 
 } // namespace povu::types
@@ -144,6 +217,9 @@ enum class VertexType {
 typedef VertexType v_type;
 std::ostream& operator<<(std::ostream& os, const VertexType& vt);
 
+// the name of a vertex as in the GFA, only for output
+std::string vertex_name(std::size_t v_id);
+
 // Merge path_t and biedged PathInfo into one namespace
 struct path_t {
   std::string name; // name as pertains the GFA file
@@ -193,6 +269,20 @@ bool operator!=(const id_n_orientation_t & lhs, const id_n_orientation_t& rhs);
 bool operator==(const id_n_orientation_t & lhs, const id_n_orientation_t& rhs);
 bool operator<(const id_n_orientation_t& lhs, const id_n_orientation_t& rhs);
 
+// an id_n_orientation_t as a single word, vertex index << 1 | reverse
+inline std::uint64_t pack(const id_n_orientation_t& x) {
+  return static_cast<std::uint64_t>(x.v_idx) << 1 | (x.orientation == orientation_t::reverse ? 1 : 0);
+}
+
+inline id_n_orientation_t unpack(std::uint64_t x) {
+  return { static_cast<std::size_t>(x >> 1), (x & 1) ? orientation_t::reverse : orientation_t::forward };
+}
+
+// mixes a packed id_n_orientation_t (or any other word) into the hash h
+inline std::uint64_t hash_combine(std::uint64_t h, std::uint64_t x) {
+  return h * 0x9e3779b97f4a7c15ULL ^ x;
+}
+
 typedef std::vector<graph_types::id_n_orientation_t> walk; // a walk is a sequence of vertices also a path
 
 struct flubble {
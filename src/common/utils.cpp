@@ -4,6 +4,7 @@
 #include <iterator>
 #include <sstream>
 #include <string>
+#include <sys/resource.h>
 
 #include "./utils.hpp"
 
@@ -56,6 +57,13 @@ void report_time(std::ostream& os, std::string fn_name, std::string action, std:
   os << std::format("{} INFO Time spent by {}: {:.2f} sec\n", fn_name, action, period.count());
 }
 
+void report_peak_rss(std::ostream& os, std::string fn_name) {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  // ru_maxrss is in kilobytes on linux
+  os << std::format("{} INFO Peak RSS: {:.2f} MB\n", fn_name, static_cast<double>(usage.ru_maxrss) / 1024);
+}
+
 std::vector<std::string> immutable_erase(std::vector<std::string> v, std::size_t idx) {
   v.erase(v.begin()+idx, v.begin()+idx+1);
   return v;
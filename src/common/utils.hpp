@@ -6,7 +6,6 @@
 #include <iostream>
 #include <string>
 #include <vector>
-#include <unordered_map>
 
 
 namespace povu::utils {
@@ -40,6 +39,11 @@ template <typename T> void print_with_comma(std::ostream& os, const T& v, char d
  */
 void report_time(std::ostream& os, std::string fn_name, std::string action, std::chrono::duration<double> period);
 
+/**
+  * @brief report the peak resident set size of the process so far
+ */
+void report_peak_rss(std::ostream& os, std::string fn_name);
+
 
 /**
  * @brief Returns the current date in the format YYYYMMDD
@@ -55,54 +59,6 @@ std::string today();
  */
 std::vector<std::string> immutable_erase(std::vector<std::string> v, std::size_t idx);
 
-// TODO : move to povu::types
-template <typename Key, typename Value>
-class TwoWayMap {
-    std::unordered_map<Key, Value> keyToValueMap;
-    std::unordered_map<Value, Key> valueToKeyMap;
-
-public:
-    // Insert a key-value pair
-    void insert(const Key& key, const Value& value) {
-        keyToValueMap[key] = value;
-        valueToKeyMap[value] = key;
-    }
-
-    // Lookup value by key
-    Value get_value(const Key& key) const {
-        auto it = keyToValueMap.find(key);
-        if (it != keyToValueMap.end()) {
-            return it->second;
-        }
-        // Return a default-constructed Value or throw an exception, depending on your use case
-        return Value{};
-    }
-
-    // Lookup key by value
-    Key get_key(const Value& value) const {
-        auto it = valueToKeyMap.find(value);
-        if (it != valueToKeyMap.end()) {
-            return it->second;
-        }
-        // Return a default-constructed Key or throw an exception, depending on your use case
-        return Key{};
-    }
-
-  // get all keys
-  std::vector<Key> get_keys() const {
-    std::vector<Key> keys;
-    for (const auto& [key, _]: keyToValueMap) {
-      keys.push_back(key);
-    }
-    return keys;
-  }
-
-  // find key
-  bool has_key(const Key& key) const {
-    return keyToValueMap.find(key) != keyToValueMap.end();
-  }
-};
-
 template <typename T> void push_front(std::vector<T>& v, const T& elem) {
   v.insert(v.begin(), elem);
 }
@@ -81,17 +81,27 @@ public:
   }
 
   std::string as_DNA_str(const bd::VG& bd_vg, std::size_t w_idx) const {
-    // skip the first and last vertices in the path
     auto [idx, o] = this->walk_[w_idx];
-    bd::Vertex const& v = bd_vg.get_vertex(idx);
-    return o == pgt::orientation_t::forward ? v.get_label() : v.get_rc_label();
+    return bd_vg.get_label_str(idx, o);
+  }
+
+  // append the label of the vertex at w_idx without a temporary string
+  void append_DNA(const bd::VG& bd_vg, std::size_t w_idx, std::string& dna_str) const {
+    auto [idx, o] = this->walk_[w_idx];
+    bd_vg.append_label(idx, o, dna_str);
+  }
+
+  // the last base of the label of the vertex at w_idx
+  char last_base(const bd::VG& bd_vg, std::size_t w_idx) const {
+    auto [idx, o] = this->walk_[w_idx];
+    return bd_vg.get_label(idx, o).back();
   }
 
   std::string as_DNA_str(const bd::VG& bd_vg) const {
     std::string dna_str;
     // skip the first and last vertices in the path
     for (std::size_t i {1}; i < this->walk_.size() - 1; ++i) {
-      dna_str += this->as_DNA_str(bd_vg, i);
+      this->append_DNA(bd_vg, i, dna_str);
     }
     return dna_str;
   }
@@ -106,10 +116,9 @@ public:
 
 
     if (has_ins) {
-      std::string s_str { this->as_DNA_str(bd_vg, 0) };
-      dna_str += s_str.back();
+      dna_str += this->last_base(bd_vg, 0);
       for (std::size_t i { 1 }; i < sp.length - 1; ++i) {
-        dna_str += this->as_DNA_str(bd_vg, i);
+        this->append_DNA(bd_vg, i, dna_str);
       }
 
 
@@ -119,7 +128,7 @@ public:
     std::size_t i { sp.start == 0 ? 1 : sp.start }; // start idx
     std::size_t last_idx { sp.start + sp.length == this->walk_.size() ? sp.length - 1 : sp.length };
     for (; i < last_idx; ++i) {
-      dna_str += this->as_DNA_str(bd_vg, i);
+      this->append_DNA(bd_vg, i, dna_str);
     }
 
 
@@ -218,6 +227,15 @@ public:
   std::size_t get_longest_walk_idx(std::size_t hap_id) const { return this->longest_hap_walk_.at(hap_id); }
 };
 
+/**
+ * @brief the distinct walks the haplotypes take through each flubble, in the
+ * order they are first seen, the steps are vertex indexes
+ */
+void find_bubble_paths_sweep(const std::vector<pgt::flubble>& canonical_flubbles,
+                             const bd::VG& bd_vg,
+                             std::vector<std::vector<pgt::walk>>& all_paths,
+                             const core::config& app_config);
+
 void call_variants(const std::vector<pgt::flubble>& canonical_flubbles,
                    const bd::VG& bd_vg,
                    const core::config& app_config);
@@ -142,7 +142,7 @@ std::vector<pt::idx_t> get_positions(const bd::VG &bd_vg, const ref_meta& meta,
       if (!found) { return false; }
 
       curr_si += len;
-      len = curr_v.get_label().length();
+      len = curr_v.get_label_length();
     }
 
     return true;
@@ -152,7 +152,7 @@ std::vector<pt::idx_t> get_positions(const bd::VG &bd_vg, const ref_meta& meta,
   // check that the path id is valid and that
   // the position is valid for the walk i.e the position can be extended in the
   // next vertex in the walk
-  std::size_t l = v.get_label().length();
+  std::size_t l = v.get_label_length();
   ps.erase(std::remove_if(ps.begin(), ps.end(), [&](bd::PathInfo& pi) { return !pred(pi, l); } ), ps.end());
 
   for (bd::PathInfo& pi : ps) { pi.step_index += l; }
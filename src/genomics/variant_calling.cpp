@@ -1,16 +1,22 @@
 #include <algorithm>
 #include <cstddef>
+#include <cstdint>
 #include <ctime>
 #include <format>
 #include <iostream>
 #include <map>
 #include <set>
+#include <span>
 #include <string>
 #include <sys/types.h>
+#include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
+#include "../common/scheduler.hpp"
 #include "../common/types.hpp"
+#include "../common/utils.hpp"
 #include "./genomics.hpp"
 #include "../graph/bidirected.hpp"
 #include "../io/io.hpp"
@@ -26,6 +32,32 @@ namespace pu = povu::untangle;
 // TODO: replace with stride
 typedef std::pair<std::size_t, std::size_t> range; // start and length covered by the haplotype
 
+namespace {
+/**
+ * @brief a walk of a flubble as the flubble index and the index of the walk in
+ * all_paths, hashed and compared by the steps of the walk
+ */
+struct walk_key_hash {
+  const std::vector<std::vector<pgt::walk>>* all_paths;
+
+  std::size_t operator()(const std::pair<std::size_t, std::size_t>& k) const {
+    std::uint64_t h { k.first };
+    for (const pgt::id_n_orientation_t& s : (*all_paths)[k.first][k.second]) {
+      h = pgt::hash_combine(h, pgt::pack(s));
+    }
+    return std::hash<std::uint64_t>{}(h);
+  }
+};
+
+struct walk_key_eq {
+  const std::vector<std::vector<pgt::walk>>* all_paths;
+
+  bool operator()(const std::pair<std::size_t, std::size_t>& a, const std::pair<std::size_t, std::size_t>& b) const {
+    return a.first == b.first && (*all_paths)[a.first][a.second] == (*all_paths)[b.first][b.second];
+  }
+};
+} // namespace
+
 // Overload the << operator
 std::ostream &operator<<(std::ostream &os, variant_type vt) {
   switch (vt) {
@@ -206,17 +238,18 @@ get_boundary_incidence(const bd::VG& g,
   std::string fn_name = std::format("[povu::genomics::]", __func__);
 
   std::size_t v_idx = g.id_to_idx(v_id);
-  const bd::Vertex& v = g.get_vertex(v_idx);
+  std::span<const std::size_t> e_l = g.get_edges_l(v_idx);
+  std::span<const std::size_t> e_r = g.get_edges_r(v_idx);
 
   auto foo = [&](std::size_t e_idx) ->bool {
     auto [side, alt_v_idx] = g.get_edge(e_idx).get_other_vertex(v_idx);
     return in_sese.count(g.idx_to_id(alt_v_idx)) || g.idx_to_id(alt_v_idx) == alt_id ;
   };
 
-  bool allLeftInSet = std::any_of(v.get_edges_l().begin(), v.get_edges_l().end(), foo);
+  bool allLeftInSet = std::any_of(e_l.begin(), e_l.end(), foo);
 
-  bool allRightNotInSet = allLeftInSet ? !std::none_of(v.get_edges_r().begin(), v.get_edges_r().end(), foo)
-                                       : std::any_of(v.get_edges_r().begin(), v.get_edges_r().end(), foo);
+  bool allRightNotInSet = allLeftInSet ? !std::none_of(e_r.begin(), e_r.end(), foo)
+                                       : std::any_of(e_r.begin(), e_r.end(), foo);
   if (!(allLeftInSet ^ allRightNotInSet)) {
     throw std::runtime_error(std::format("{} {} {}", v_idx, allLeftInSet, allRightNotInSet));
   }
@@ -310,6 +343,134 @@ void find_bubble_paths(const std::vector<pgt::flubble>& canonical_flubbles,
     all_paths.push_back(paths);
   }
 }
+
+/**
+ * @brief as find_bubble_paths but the walks are those the haplotypes take
+ *
+ * Each haplotype is walked once. A table from each vertex to the flubbles it
+ * bounds opens a flubble when the haplotype reaches its entry, or its exit in
+ * reverse, and the subwalk is recorded when it reaches the other boundary. This
+ * takes O(total path length) and has no cap on how complex a flubble can be.
+ * The haplotypes are walked in parallel and the walks of a flubble are kept in
+ * the order they are first seen.
+ */
+void find_bubble_paths_sweep(const std::vector<pgt::flubble>& canonical_flubbles,
+                             const bd::VG& bd_vg,
+                             std::vector<std::vector<pgt::walk>>& all_paths,
+                             const core::config& app_config) {
+  std::string fn_name { std::format("[povu::genomics::{}]" , __func__) };
+
+  auto flip = [](pgt::orientation_t o) {
+    return o == pgt::orientation_t::forward ? pgt::orientation_t::reverse : pgt::orientation_t::forward;
+  };
+
+  // -----
+  // the flubbles each vertex bounds
+  // -----
+  struct boundary {
+    std::size_t b_idx;
+    pgt::orientation_t o; // as the flubble is entered or left going forward
+    bool is_exit;
+  };
+
+  std::vector<std::size_t> offsets(bd_vg.size() + 1, 0);
+  for (const auto& [entry, exit] : canonical_flubbles) {
+    ++offsets[bd_vg.id_to_idx(entry.v_idx) + 1];
+    ++offsets[bd_vg.id_to_idx(exit.v_idx) + 1];
+  }
+  for (std::size_t v_idx {}; v_idx < bd_vg.size(); ++v_idx) { offsets[v_idx + 1] += offsets[v_idx]; }
+
+  std::vector<boundary> boundaries(offsets.back());
+  {
+    std::vector<std::size_t> next(offsets.begin(), offsets.end() - 1);
+    for (std::size_t b_idx {}; b_idx < canonical_flubbles.size(); ++b_idx) {
+      const auto& [entry, exit] = canonical_flubbles[b_idx];
+      boundaries[next[bd_vg.id_to_idx(entry.v_idx)]++] = { b_idx, entry.orientation, false };
+      boundaries[next[bd_vg.id_to_idx(exit.v_idx)]++] = { b_idx, exit.orientation, true };
+    }
+  }
+
+  // -----
+  // walk each haplotype
+  // -----
+  const std::vector<std::vector<pgt::id_n_orientation_t>>& haplotypes = bd_vg.get_raw_paths();
+
+  // the flubble and the walk through it of each traversal, per haplotype
+  std::vector<std::vector<std::pair<std::size_t, pgt::walk>>> traversals(haplotypes.size());
+
+  auto sweep = [&](std::size_t h_idx) {
+    const std::vector<pgt::id_n_orientation_t>& h = haplotypes[h_idx];
+
+    // the step at which each open flubble was entered and if in reverse
+    std::unordered_map<std::size_t, std::pair<std::size_t, bool>> open;
+
+    for (std::size_t i {}; i < h.size(); ++i) {
+      auto [v_idx, o] = h[i];
+      std::span<const boundary> bs(boundaries.data() + offsets[v_idx], offsets[v_idx + 1] - offsets[v_idx]);
+
+      // leave before entering, the exit of one flubble can be the entry of the next
+      for (const boundary& b : bs) {
+        bool forward = b.is_exit && o == b.o;
+        bool reverse = !b.is_exit && o == flip(b.o);
+        if (!forward && !reverse) { continue; }
+
+        auto it = open.find(b.b_idx);
+        if (it == open.end() || it->second.second != reverse) { continue; }
+
+        pgt::walk w(h.begin() + it->second.first, h.begin() + i + 1);
+        if (reverse) {
+          std::reverse(w.begin(), w.end());
+          for (pgt::id_n_orientation_t& s : w) { s.orientation = flip(s.orientation); }
+        }
+
+        traversals[h_idx].push_back({b.b_idx, std::move(w)});
+        open.erase(it);
+      }
+
+      for (const boundary& b : bs) {
+        if (!b.is_exit && o == b.o) { open[b.b_idx] = { i, false }; }
+        else if (b.is_exit && o == flip(b.o)) { open[b.b_idx] = { i, true }; }
+      }
+    }
+  };
+
+  std::vector<povu::scheduler::task> tasks;
+  tasks.reserve(haplotypes.size());
+  for (std::size_t h_idx {}; h_idx < haplotypes.size(); ++h_idx) {
+    tasks.push_back({haplotypes[h_idx].size(), [&, h_idx] { sweep(h_idx); }});
+  }
+  povu::scheduler::run(std::move(tasks), app_config.thread_count());
+
+  // -----
+  // the distinct walks of each flubble
+  // -----
+  // a walk is added and dropped again if the set already has it
+  all_paths.assign(canonical_flubbles.size(), {});
+  std::unordered_set<std::pair<std::size_t, std::size_t>, walk_key_hash, walk_key_eq>
+    seen(0, walk_key_hash { &all_paths }, walk_key_eq { &all_paths });
+  for (std::vector<std::pair<std::size_t, pgt::walk>>& h_traversals : traversals) {
+    for (auto& [b_idx, w] : h_traversals) {
+      std::vector<pgt::walk>& walks = all_paths[b_idx];
+      walks.push_back(std::move(w));
+      if (!seen.insert({b_idx, walks.size() - 1}).second) { walks.pop_back(); }
+    }
+    std::vector<std::pair<std::size_t, pgt::walk>>().swap(h_traversals);
+  }
+
+  std::size_t untraversed {};
+  for (std::size_t b_idx {}; b_idx < canonical_flubbles.size(); ++b_idx) {
+    const auto& [entry, exit] = canonical_flubbles[b_idx];
+    if (all_paths[b_idx].empty()) { ++untraversed; }
+    if (all_paths[b_idx].size() < 2) {
+      std::cerr << std::format("{} WARN: Bubble {} {} has {} paths\n", fn_name, entry.as_str(), exit.as_str(), all_paths[b_idx].size());
+    }
+  }
+
+  if (app_config.verbosity() > 1) {
+    std::cerr << std::format("{} {} of {} flubbles are not traversed by any haplotype\n",
+                             fn_name, untraversed, canonical_flubbles.size());
+  }
+}
 /**
   * @brief reference paths that are in the graph & in the app config
   *
@@ -344,7 +505,13 @@ void call_variants(const std::vector<pgt::flubble>& canonical_flubbles,
 
   std::vector<std::vector<pgt::walk>> all_paths;
   //std::vector<std::pair<pgt::id_n_orientation_t, pgt::id_n_orientation_t>> bubble_boundaries;
-  find_bubble_paths(canonical_flubbles, bd_vg, all_paths);
+  auto t0 = pt::Time::now();
+  if (app_config.haplotype_sweep()) { find_bubble_paths_sweep(canonical_flubbles, bd_vg, all_paths, app_config); }
+  else { find_bubble_paths(canonical_flubbles, bd_vg, all_paths); }
+
+  if (app_config.verbosity() > 1) {
+    povu::utils::report_time(std::cerr, fn_name, "finding the walks through the flubbles", pt::Time::now() - t0);
+  }
 
   std::set<pt::id_t> ref_ids { find_relevant_refs(bd_vg, app_config) };
 
@@ -61,14 +61,14 @@ vcf::vcf_record gen_vcf_rec(const bd::VG& bd_vg,
     std::string alt_str { alt_p.as_DNA_str(bd_vg) };
 
     if (variant_cats[i] == genomics::variant_type::DEL) {
-      alt_str = alt_p.as_DNA_str(bd_vg, 0).back();
+      alt_str = alt_p.last_base(bd_vg, 0);
       vcf_rec.ref = alt_str + vcf_rec.ref;
     }
     else if (variant_cats[i] == genomics::variant_type::INS) {
       alt_str = vcf_rec.ref + alt_str;
     }
     else if (vcf_rec.ref.empty()) {
-      vcf_rec.ref = alt_p.as_DNA_str(bd_vg, 0).back();
+      vcf_rec.ref = alt_p.last_base(bd_vg, 0);
       alt_str = vcf_rec.ref + alt_str;
     }
 
@@ -1,4 +1,5 @@
 #include <algorithm>
+#include <cassert>
 #include <cstddef>
 #include <cstring>
 #include <format>
@@ -9,10 +10,12 @@
 #include <queue>
 #include <set>
 #include <stack>
+#include <stdexcept>
 #include <string>
 #include <sys/types.h>
 #include <tuple>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
 #include "./bidirected.hpp"
@@ -92,28 +95,13 @@ std::ostream& operator<<(std::ostream& os, const Edge& edge) {
   Vertex constructor(s)
  */
 Vertex::Vertex() {
-  this->label = std::string();
-  this->edges_l = std::set<std::size_t>();
-  this->edges_r = std::set<std::size_t>();
-
-  this->paths = std::vector<PathInfo>();
-  this->handle = std::string();
-  this->is_reversed_ = false;
-}
-
-Vertex::Vertex(const std::string& label): label(label) {
-  this->edges_l = std::set<std::size_t>();
-  this->edges_r = std::set<std::size_t>();
-
   this->paths = std::vector<PathInfo>();
   this->handle = std::string();
   this->is_reversed_ = false;
 }
 
-Vertex::Vertex(const std::string& label, const handlegraph::nid_t& id)
-  : label(label), handle(std::to_string(id)) {
-  this->edges_l = std::set<std::size_t>();
-  this->edges_r = std::set<std::size_t>();
+Vertex::Vertex(std::size_t label_offset, std::size_t label_length, const handlegraph::nid_t& id)
+  : label_offset_(label_offset), label_length_(label_length), handle(std::to_string(id)) {
 
   this->paths = std::vector<PathInfo>();
   this->is_reversed_ = false;
@@ -122,12 +110,12 @@ Vertex::Vertex(const std::string& label, const handlegraph::nid_t& id)
 /*
   Vertex getter(s)
  */
-const std::string& Vertex::get_label() const {
-  return this->label;
+std::size_t Vertex::get_label_offset() const {
+  return this->label_offset_;
 }
 
-std::string Vertex::get_rc_label() const{
-  return pu::reverse_complement(this->label);
+std::size_t Vertex::get_label_length() const {
+  return this->label_length_;
 }
 
 const std::string& Vertex::get_handle() const {
@@ -141,14 +129,6 @@ const std::string& Vertex::get_name() const {
   return this->name_;
 }
 
-const std::set<std::size_t>& Vertex::get_edges_l() const {
-    return this->edges_l;
-}
-
-const std::set<std::size_t>& Vertex::get_edges_r() const {
-    return this->edges_r;
-}
-
 const std::vector<PathInfo>& Vertex::get_refs() const {
   return this->paths;
 }
@@ -169,39 +149,9 @@ bool Vertex::toggle_reversed() {
 }
 
 
-bool Vertex::is_tip() const {
-  return this->edges_l.empty() || this->edges_r.empty();
-}
-
-std::optional<VertexEnd> Vertex::tip_end() const {
-  if (this->edges_l.empty()) {
-    return std::optional<VertexEnd> {VertexEnd::l};
-  }
-  else if (this->edges_r.empty()) {
-    return std::optional<VertexEnd> {VertexEnd::r};
-  }
-  else {
-    return std::optional<VertexEnd> {};
-  }
-}
-
 /*
   Vertex setter(s)
 */
-void Vertex::add_edge(std::size_t edge_index, VertexEnd vertex_end) {
-  if (vertex_end == VertexEnd::l) {
-    this->edges_l.insert(edge_index);
-  }
-  else {
-    this->edges_r.insert(edge_index);
-  }
-}
-
-void Vertex::clear_edges() {
-  this->edges_l.clear();
-  this->edges_r.clear();
-}
-
 void Vertex::add_path(std::size_t path_id, std::size_t step_index) {
   this->paths.push_back(PathInfo(path_id, step_index));
 }
@@ -226,6 +176,7 @@ void Vertex::set_eq_class(std::size_t eq_class) { this->eq_class = eq_class; }
 VariationGraph::VariationGraph()
     : vertices(std::vector<Vertex>{}),
       edges((std::vector<Edge>{})),
+      seqs_(std::make_shared<pss::SeqStore>()),
       paths(std::map<id_t, path_t>{})
 {}
 
@@ -234,11 +185,26 @@ VariationGraph::VariationGraph(std::size_t vertex_count, std::size_t edge_count,
                                std::size_t path_count)
     : vertices(std::vector<Vertex>{}),
       edges(std::vector<Edge>{}),
+      seqs_(std::make_shared<pss::SeqStore>()),
       paths(std::map<id_t, path_t>{})
 {
   this->vertices.reserve(vertex_count);
   this->edges.reserve(edge_count);
-}
+  this->id_to_idx_.reserve(vertex_count);
+}
+
+VariationGraph::VariationGraph(std::vector<Vertex>&& vertices, pt::IdMap&& id_to_idx, std::vector<Edge>&& edges,
+                               std::shared_ptr<pss::SeqStore> seqs,
+                               std::vector<std::size_t>&& adj_off, std::vector<std::size_t>&& adj)
+    : vertices(std::move(vertices)),
+      edges(std::move(edges)),
+      seqs_(std::move(seqs)),
+      adj_off_(std::move(adj_off)),
+      adj_(std::move(adj)),
+      frozen_(true),
+      paths(std::map<id_t, path_t>{}),
+      id_to_idx_(std::move(id_to_idx))
+{}
 
 // Getters
 // -------
@@ -279,11 +245,34 @@ std::size_t VariationGraph::get_vertex_idx_by_name(std::string n) const {
 }
 
 std::size_t VariationGraph::idx_to_id(std::size_t idx) const {
-  return this->id_to_idx_.get_key(idx);
+  return this->id_to_idx_.get_id(idx);
 }
 
 std::size_t VariationGraph::id_to_idx(std::size_t id) const {
-  return this->id_to_idx_.get_value(id);
+  return this->id_to_idx_.get_idx(id);
+}
+
+pss::SeqView VariationGraph::get_label(std::size_t v_idx, orientation_t o) const {
+  const Vertex& v = this->vertices[v_idx];
+  return this->seqs_->view(v.get_label_offset(), v.get_label_length(), o == orientation_t::reverse);
+}
+
+std::string VariationGraph::get_label_str(std::size_t v_idx, orientation_t o) const {
+  return this->get_label(v_idx, o).to_string();
+}
+
+char* VariationGraph::decode_label(std::size_t v_idx, orientation_t o, char* out) const {
+  const Vertex& v = this->vertices[v_idx];
+  return this->seqs_->decode(v.get_label_offset(), v.get_label_length(), o == orientation_t::reverse, out);
+}
+
+void VariationGraph::append_label(std::size_t v_idx, orientation_t o, std::string& out) const {
+  const Vertex& v = this->vertices[v_idx];
+  this->seqs_->append_to(v.get_label_offset(), v.get_label_length(), o == orientation_t::reverse, out);
+}
+
+const pss::SeqStore& VariationGraph::get_seq_store() const {
+  return *this->seqs_;
 }
 
 const std::vector<Edge>& VariationGraph::get_all_edges() const {
@@ -298,6 +287,22 @@ const Edge& VariationGraph::get_edge(std::size_t index) const {
     return this->edges[index];
 }
 
+std::span<const std::size_t> VariationGraph::get_edges_l(std::size_t v_idx) const {
+  assert(this->frozen_);
+  return std::span<const std::size_t>(this->adj_.data() + this->adj_off_[2 * v_idx],
+                                      this->adj_off_[2 * v_idx + 1] - this->adj_off_[2 * v_idx]);
+}
+
+std::span<const std::size_t> VariationGraph::get_edges_r(std::size_t v_idx) const {
+  assert(this->frozen_);
+  return std::span<const std::size_t>(this->adj_.data() + this->adj_off_[2 * v_idx + 1],
+                                      this->adj_off_[2 * v_idx + 2] - this->adj_off_[2 * v_idx + 1]);
+}
+
+std::span<const std::size_t> VariationGraph::get_edges(std::size_t v_idx, VertexEnd end) const {
+  return end == VertexEnd::l ? this->get_edges_l(v_idx) : this->get_edges_r(v_idx);
+}
+
 std::set<side_n_id_t> VariationGraph::get_orphan_tips() const {
   std::set<side_n_id_t> orphan_tips = this->tips();
 
@@ -322,13 +327,13 @@ std::vector<side_n_id_t> VariationGraph::get_adj_vertices(std::size_t vertex_ind
   std::vector<side_n_id_t> adj_vertices;
 
   if (vertex_end == VertexEnd::l) {
-    for (const auto& edge_index : this->vertices[vertex_index].get_edges_l()) {
+    for (const auto& edge_index : this->get_edges_l(vertex_index)) {
       const Edge& e = this->get_edge(edge_index);
       adj_vertices.push_back(e.get_other_vertex(vertex_index));
     }
   }
   else {
-    for (const auto& edge_index : this->vertices[vertex_index].get_edges_r()) {
+    for (const auto& edge_index : this->get_edges_r(vertex_index)) {
           const Edge& e = this->get_edge(edge_index);
       adj_vertices.push_back(e.get_other_vertex(vertex_index));
     }
@@ -377,8 +382,8 @@ std::set<id_n_orientation_t> VariationGraph::get_outgoing_neighbours(id_n_orient
   auto [v_idx, o] = idx_n_o;
   std::set<id_n_orientation_t> neighbours;
 
-  const std::set<std::size_t>& edges = o == orientation_t::forward ?
-    this->get_vertex(v_idx).get_edges_r() : this->get_vertex(v_idx).get_edges_l();
+  std::span<const std::size_t> edges = o == orientation_t::forward ?
+    this->get_edges_r(v_idx) : this->get_edges_l(v_idx);
 
   for (const auto& e_idx : edges) {
     const Edge& e = this->get_edge(e_idx);
@@ -398,8 +403,8 @@ std::set<id_n_orientation_t> VariationGraph::get_incoming_neighbours(id_n_orient
   auto [v_idx, o] = idx_n_o;
   std::set<id_n_orientation_t> neighbours;
 
-  const std::set<std::size_t>& e_idxs = o == orientation_t::forward ?
-    this->get_vertex(v_idx).get_edges_l() : this->get_vertex(v_idx).get_edges_r();
+  std::span<const std::size_t> e_idxs = o == orientation_t::forward ?
+    this->get_edges_l(v_idx) : this->get_edges_r(v_idx);
 
   for (const auto& e_idx : e_idxs) {
     const Edge& e = this->get_edge(e_idx);
@@ -423,17 +428,13 @@ pt::id_t VariationGraph::get_shared_edge_idx(id_or src, id_or snk) const {
   auto [v_idx_1, o1] = src;
   auto [v_idx_2, o2] = snk;
 
-  Vertex v1 = this->get_vertex(v_idx_1);
-  const std::set<std::size_t>& e_idxs = o1 == or_t::forward ? v1.get_edges_r() : v1.get_edges_l();
-
-  Vertex v2 = this->get_vertex(v_idx_2);
-  const std::set<std::size_t>& e_idxs2 = o2 == or_t::forward ? v2.get_edges_l() : v2.get_edges_r();
+  std::span<const std::size_t> e_idxs = o1 == or_t::forward ? this->get_edges_r(v_idx_1) : this->get_edges_l(v_idx_1);
+  std::span<const std::size_t> e_idxs2 = o2 == or_t::forward ? this->get_edges_l(v_idx_2) : this->get_edges_r(v_idx_2);
 
-  // get the intersection of the two sets
-  std::set<std::size_t> intersection;
+  // get the intersection of the two sorted spans
+  std::vector<std::size_t> intersection;
   std::set_intersection(e_idxs.begin(), e_idxs.end(), e_idxs2.begin(),
-                        e_idxs2.end(),
-                        std::inserter(intersection, intersection.begin()));
+                        e_idxs2.end(), std::back_inserter(intersection));
 
 
   if (intersection.size() != 1) {
@@ -454,7 +455,7 @@ pt::id_t VariationGraph::get_shared_edge_idx(id_or src, id_or snk) const {
         fn_name, src.as_str(), snk.as_str(), intersection.size()));
   }
 
-  return *intersection.begin();
+  return intersection.front();
 }
 
 const Edge& VariationGraph::get_edge(id_or x1, id_or x2) const {
@@ -723,24 +724,86 @@ std::size_t VariationGraph::add_vertex(const Vertex& vertex) {
   return this->vertices.size() - 1;
 }
 
+void VariationGraph::share_seq_store(const VariationGraph& other) {
+  this->seqs_ = other.seqs_;
+}
+
 void VariationGraph::add_edge(const Edge& edge) {
-  std::size_t edge_idx = this->edges.size();
   this->edges.push_back(edge);
-  this->get_vertex_mut(edge.get_v1_idx()).add_edge(edge_idx, edge.get_v1_end());
-  this->get_vertex_mut(edge.get_v2_idx()).add_edge(edge_idx, edge.get_v2_end());
+  this->frozen_ = false;
 }
 
 std::size_t VariationGraph::add_edge(std::size_t v1, VertexEnd v1_end, std::size_t v2, VertexEnd v2_end) {
-  v1 = this->id_to_idx_.get_value(v1);
-  v2 = this->id_to_idx_.get_value(v2);
+  std::size_t v1_idx = this->id_to_idx_.get_idx(v1);
+  std::size_t v2_idx = this->id_to_idx_.get_idx(v2);
+  if (v1_idx == pc::INVALID_IDX || v2_idx == pc::INVALID_IDX) {
+    throw std::invalid_argument(std::format("[povu::bidirected::{}] no vertex with id {} for the edge {} {} {} {}",
+                                            __func__, v1_idx == pc::INVALID_IDX ? v1 : v2,
+                                            v1, v1_end == VertexEnd::l ? '+' : '-',
+                                            v2, v2_end == VertexEnd::l ? '+' : '-'));
+  }
+  v1 = v1_idx;
+  v2 = v2_idx;
   std::size_t edge_idx = this->edges.size();
   this->edges.push_back(Edge(v1, v1_end, v2, v2_end));
-  this->get_vertex_mut(v1).add_edge(edge_idx, v1_end);
-  this->get_vertex_mut(v2).add_edge(edge_idx, v2_end);
+  this->frozen_ = false;
 
   return edge_idx;
 }
 
+void VariationGraph::freeze() {
+  povu::graph::build_csr(this->edges, this->size(), this->adj_off_, this->adj_);
+  this->frozen_ = true;
+}
+
+void VariationGraph::freeze(std::vector<std::size_t>&& adj_off, std::vector<std::size_t>&& adj) {
+  this->adj_off_ = std::move(adj_off);
+  this->adj_ = std::move(adj);
+  this->frozen_ = true;
+}
+
+void VariationGraph::sort_bfs() {
+  if (!this->frozen_) { this->freeze(); }
+
+  std::vector<std::size_t> roots;
+  for (auto [_, v_idx] : this->tips_) { roots.push_back(v_idx); }
+  std::vector<std::size_t> order = povu::graph::bfs_order(*this, roots);
+
+  std::vector<std::size_t> new_idx(order.size());
+  for (std::size_t i {}; i < order.size(); ++i) { new_idx[order[i]] = i; }
+
+  std::vector<Vertex> vertices;
+  vertices.reserve(order.size());
+  pt::IdMap id_to_idx;
+  id_to_idx.reserve(order.size());
+  for (std::size_t i {}; i < order.size(); ++i) {
+    vertices.push_back(std::move(this->vertices[order[i]]));
+    id_to_idx.insert(this->id_to_idx_.get_id(order[i]), i);
+  }
+  this->vertices = std::move(vertices);
+  this->id_to_idx_ = std::move(id_to_idx);
+
+  for (Edge& e : this->edges) {
+    e.set_v1_idx(new_idx[e.get_v1_idx()]);
+    e.set_v2_idx(new_idx[e.get_v2_idx()]);
+  }
+
+  auto remap = [&](std::set<side_n_id_t>& sides) {
+    std::set<side_n_id_t> moved;
+    for (auto [end, v_idx] : sides) { moved.insert({end, new_idx[v_idx]}); }
+    sides = std::move(moved);
+  };
+  remap(this->tips_);
+  remap(this->haplotype_start_nodes_);
+  remap(this->haplotype_end_nodes_);
+
+  for (std::vector<id_n_orientation_t>& raw_path : this->raw_paths) {
+    for (id_n_orientation_t& s : raw_path) { s.v_idx = new_idx[s.v_idx]; }
+  }
+
+  this->freeze();
+}
+
 void VariationGraph::add_path(const path_t& path) {
   std::string fn_name = std::format("[povu::bidirected::{}]", __func__);
 
@@ -751,8 +814,12 @@ void VariationGraph::add_path(const path_t& path) {
   this->paths[path.id] = path_t{path.name, path.id, path.is_circular};
 }
 
-void VariationGraph::set_raw_paths(std::vector<std::vector<id_n_orientation_t>> &raw_paths) {
-  this->raw_paths = raw_paths;
+const std::vector<std::vector<id_n_orientation_t>>& VariationGraph::get_raw_paths() const {
+  return this->raw_paths;
+}
+
+void VariationGraph::set_raw_paths(std::vector<std::vector<id_n_orientation_t>> raw_paths) {
+  this->raw_paths = std::move(raw_paths);
 }
 
 void VariationGraph::set_min_id(std::size_t min_id) {
@@ -795,8 +862,8 @@ void scc_from_tip(const VariationGraph &vg,
       continue;
     }
 
-    const std::set<std::size_t> &out_edges =
-      side == VertexEnd::l ? vg.get_vertex(v).get_edges_r() : vg.get_vertex(v).get_edges_l();
+    std::span<const std::size_t> out_edges =
+      side == VertexEnd::l ? vg.get_edges_r(v) : vg.get_edges_l(v);
 
     for (std::size_t e_idx : out_edges) {
       id_t adj_v = vg.get_edge(e_idx).get_other_vertex(v).v_idx;
@@ -828,18 +895,16 @@ bool VariationGraph::validate_haplotype_paths() {
       auto [v1, o1] = raw_path[i];
       auto [v2, o2] = raw_path[i+1];
 
-      std::set<std::size_t> const &s1_edges =
-        o1 == bidirected::orientation_t::forward ?
-        this->get_vertex(v1).get_edges_r() : this->get_vertex(v1).get_edges_l();
+      std::span<const std::size_t> s1_edges =
+        o1 == bidirected::orientation_t::forward ? this->get_edges_r(v1) : this->get_edges_l(v1);
 
-      std::set<std::size_t> const &s2_edges =
-        o2 == bidirected::orientation_t::forward ?
-        this->get_vertex(v2).get_edges_l() : this->get_vertex(v2).get_edges_r();
+      std::span<const std::size_t> s2_edges =
+        o2 == bidirected::orientation_t::forward ? this->get_edges_l(v2) : this->get_edges_r(v2);
 
-      std::set<std::size_t> intersection; // shared edges between v1 and v2
+      std::vector<std::size_t> intersection; // shared edges between v1 and v2
       std::set_intersection(s1_edges.begin(), s1_edges.end(),
                             s2_edges.begin(), s2_edges.end(),
-                            std::inserter(intersection, intersection.begin()));
+                            std::back_inserter(intersection));
 
       for (std::size_t e_idx : intersection) {
         Edge const& e = this->get_edge(e_idx);
@@ -880,6 +945,7 @@ std::vector<VariationGraph> componetize(const VariationGraph& vg, const core::co
 
   std::vector<VariationGraph> components;
   bidirected::VariationGraph curr_vg;
+  curr_vg.share_seq_store(vg);
 
   std::set<side_n_id_t> const& hap_starts = vg.find_haplotype_start_nodes();
   std::set<side_n_id_t> const& hap_ends = vg.find_haplotype_end_nodes();
@@ -902,8 +968,8 @@ std::vector<VariationGraph> componetize(const VariationGraph& vg, const core::co
     std::size_t v = s.top();
     bool is_vtx_explored { true };
 
-    std::set<std::size_t> const& e_l = vg.get_vertex(v).get_edges_l();
-    std::set<std::size_t> const& e_r = vg.get_vertex(v).get_edges_r();
+    std::span<const std::size_t> e_l = vg.get_edges_l(v);
+    std::span<const std::size_t> e_r = vg.get_edges_r(v);
 
     for (std::size_t e_idx: e_l) { update(e_idx, v, is_vtx_explored); }
     for (std::size_t e_idx: e_r) { update(e_idx, v, is_vtx_explored); }
@@ -916,7 +982,6 @@ std::vector<VariationGraph> componetize(const VariationGraph& vg, const core::co
 
       std::size_t v_ = curr_vg.add_vertex(vg.get_vertex(v));
       Vertex& v_mut = curr_vg.get_vertex_mut(v_);
-      v_mut.clear_edges();
       //v_mut.set_handle(v_+1);
 
       if (vertex_map.find(v) == vertex_map.end()) {
@@ -968,6 +1033,8 @@ std::vector<VariationGraph> componetize(const VariationGraph& vg, const core::co
                            vertex_map[vg.get_edge(e).get_v2_idx()], vg.get_edge(e).get_v2_end());
       }
 
+     curr_vg.freeze();
+
      // add paths to curr_vg
      for (std::size_t p: curr_paths) { curr_vg.add_path(vg.get_path(p)); }
      components.push_back(curr_vg);
@@ -976,6 +1043,7 @@ std::vector<VariationGraph> componetize(const VariationGraph& vg, const core::co
      curr_paths.clear();
      tips.clear();
      curr_vg = bidirected::VariationGraph();
+     curr_vg.share_seq_store(vg);
 
      for (std::size_t v_idx{}; v_idx < vg.size(); ++v_idx) {
        if (explored.find(v_idx) == explored.end()) {
@@ -1022,11 +1090,11 @@ handlegraph::handle_t VariationGraph::flip(const handlegraph::handle_t& handle)
 }
 
 size_t VariationGraph::get_length(const handlegraph::handle_t& handle) const {
-  return this->get_vertex(  std::stoll(handle.data)).get_label().length();
+  return this->get_vertex(  std::stoll(handle.data)).get_label_length();
 }
 
 std::string VariationGraph::get_sequence(const handlegraph::handle_t& handle) const {
-  return this->get_vertex(std::stoll(handle.data)).get_label();
+  return this->get_label_str(std::stoll(handle.data));
 }
 
 std::size_t VariationGraph::get_node_count() const {
@@ -1080,12 +1148,18 @@ VariationGraph::create_handle(const std::string& sequence) {
 
   std::snprintf(h.data, sizeof(h.data), "%ld", this->size());
 
-  this->add_vertex(Vertex(sequence, this->size()));
+  std::size_t off = this->seqs_->append(sequence);
+  this->add_vertex(Vertex(off, sequence.size(), this->size()));
 
   return h;
 }
 handlegraph::handle_t
 VariationGraph::create_handle(const std::string& sequence, const handlegraph::nid_t& id) {
+  return this->create_handle(std::string_view(sequence), id);
+}
+
+handlegraph::handle_t
+VariationGraph::create_handle(std::string_view sequence, const handlegraph::nid_t& id) {
   std::size_t id_ = id;
 
   //if (id < this->size()) {
@@ -1100,7 +1174,8 @@ VariationGraph::create_handle(const std::string& sequence, const handlegraph::ni
 
   std::snprintf(h.data, sizeof(h.data), "%ld", this->size());
 
-  this->add_vertex(Vertex(sequence, id_));
+  std::size_t off = this->seqs_->append(sequence);
+  this->add_vertex(Vertex(off, sequence.size(), id_));
 
   return h;
   // return create_handle(sequence);
@@ -3,8 +3,11 @@
 
 #include <cstddef>
 #include <map>
+#include <memory>
 #include <set>
+#include <span>
 #include <string>
+#include <string_view>
 #include <sys/types.h>
 #include <vector>
 
@@ -12,6 +15,8 @@
 
 #include "../common/types.hpp"
 #include "../common/utils.hpp"
+#include "./graph.hpp"
+#include "./seq_store.hpp"
 
 namespace povu::bidirected {
 using namespace povu::graph_types;
@@ -19,6 +24,7 @@ namespace pc = povu::constants;
 namespace hg = handlegraph;
 namespace pu = povu::utils;
 namespace pt = povu::types;
+namespace pss = povu::seq_store;
 
 /**
  *
@@ -98,14 +104,13 @@ public:
 
 /**
  * a vertex is invalid if it lacks either a label or a handle
+ *
+ * the label (or sequence) lives in the SeqStore of the graph, the vertex only
+ * holds its offset and length
  */
 class Vertex {
-  std::string label; // or sequence
-
-  // TODO: replace with vector of edge indexes
-  // indexes to the edge vector in Graph
-  std::set<std::size_t> edges_l;
-  std::set<std::size_t> edges_r;
+  std::size_t label_offset_ { 0 };
+  std::size_t label_length_ { 0 };
 
   // paths (also colors)
   // the first element is the path id and the second is the step index or
@@ -129,35 +134,25 @@ public:
   // constructor(s)
   // --------------
   Vertex();
-  Vertex(const std::string& label);
-  Vertex(const std::string& label, const handlegraph::nid_t& id);
+  Vertex(std::size_t label_offset, std::size_t label_length, const handlegraph::nid_t& id);
 
   // ---------
   // getter(s)
   // ---------
   bool is_reversed() const;
-  const std::string& get_label() const;
-  // rc is reverse complement
-  std::string get_rc_label() const;
+  std::size_t get_label_offset() const;
+  std::size_t get_label_length() const;
   const std::string& get_handle() const;
   const std::string& get_name() const;
-  const std::set<std::size_t>& get_edges_l() const;
-  const std::set<std::size_t>& get_edges_r() const;
   const std::vector<PathInfo>& get_paths() const; // TODO: Deprecated use get_refs
   const std::vector<PathInfo>& get_refs() const; // TODO: Deprecated use get_refs
   std::size_t get_eq_class() const;
-  bool is_tip() const; // considers a single node to be a tip
-  // returns the end of the vertex that is a tip
-  // if a single node l is considered the tip end
-  std::optional<VertexEnd> tip_end() const;
 
   // ---------
   // setter(s)
   // ---------
   // returns the new value
   bool toggle_reversed();
-  void add_edge(std::size_t edge_index, VertexEnd vertex_end);
-  void clear_edges();
   // void set_label(const std::string& label);
   void set_handle(const std::string& handle);
   void set_handle(id_t id);
@@ -171,11 +166,22 @@ public:
 
 /**
  * A variation graph as a bidirected graph
+ *
+ * The incident edges of each vertex side are held in a CSR layout (see
+ * povu::graph::build_csr) which is built by freeze() once all edges have been
+ * added.
  */
 class VariationGraph {
   std::vector<Vertex> vertices;
   std::vector<Edge> edges;
 
+  // vertex labels, shared with the components split off this graph
+  std::shared_ptr<pss::SeqStore> seqs_;
+
+  std::vector<std::size_t> adj_off_;
+  std::vector<std::size_t> adj_;
+  bool frozen_ { false };
+
   std::map<id_t, path_t> paths;
 
   // TODO: associate with paths above, maybe make it a map as well or merge them into one
@@ -193,7 +199,7 @@ class VariationGraph {
   // vertices with incident edges on only one side
   std::set<side_n_id_t> tips_;
 
-  pu::TwoWayMap<std::size_t, std::size_t> id_to_idx_;
+  pt::IdMap id_to_idx_;
 
   // for libHandleGraph
   // min and max vertex ids
@@ -206,7 +212,11 @@ public:
   // --------------
   VariationGraph();
   VariationGraph(std::size_t vertex_count, std::size_t edge_count, std::size_t path_count);
-
+  // adopt vertices, edges and a CSR adjacency built elsewhere e.g. read from an
+  // index, the graph is frozen
+  VariationGraph(std::vector<Vertex>&& vertices, pt::IdMap&& id_to_idx, std::vector<Edge>&& edges,
+                 std::shared_ptr<pss::SeqStore> seqs,
+                 std::vector<std::size_t>&& adj_off, std::vector<std::size_t>&& adj);
 
   // ---------
   // getter(s)
@@ -222,6 +232,18 @@ public:
   Vertex& get_vertex_mut(std::size_t index);
 
   const Vertex& get_vertex_by_name(std::string n) const;
+
+  /**
+   * @brief a non-allocating view of the label of a vertex
+   *
+   * @param o reverse yields the reverse complement
+   */
+  pss::SeqView get_label(std::size_t v_idx, orientation_t o = orientation_t::forward) const;
+  std::string get_label_str(std::size_t v_idx, orientation_t o = orientation_t::forward) const;
+  // decode the label into a caller provided buffer, returns one past the last char written
+  char* decode_label(std::size_t v_idx, orientation_t o, char* out) const;
+  void append_label(std::size_t v_idx, orientation_t o, std::string& out) const;
+  const pss::SeqStore& get_seq_store() const;
   std::size_t get_vertex_idx_by_name(std::string n) const;
 
   /**
@@ -238,6 +260,11 @@ public:
   std::set<id_n_orientation_t> get_outgoing_neighbours(id_n_orientation_t idx_n_o) const;
   std::set<id_n_orientation_t> get_incoming_neighbours(id_n_orientation_t idx_n_o) const;
 
+  // incident edges of a vertex side, the graph must be frozen
+  std::span<const std::size_t> get_edges_l(std::size_t v_idx) const;
+  std::span<const std::size_t> get_edges_r(std::size_t v_idx) const;
+  std::span<const std::size_t> get_edges(std::size_t v_idx, VertexEnd end) const;
+
   const Edge& get_edge(std::size_t index) const;
   Edge &get_edge_mut(std::size_t index);
   /**
@@ -278,6 +305,7 @@ public:
   const path_t& get_ref(const std::string& ref_name) const;
   const path_t& get_path(std::size_t ref_id) const; // deprecated in favour of get_ref
   std::size_t get_path_count() const;
+  const std::vector<std::vector<id_n_orientation_t>>& get_raw_paths() const;
 
   std::set<side_n_id_t> const& tips() const;
 
@@ -315,11 +343,41 @@ public:
    */
   std::size_t add_vertex(const Vertex& vertex);
 
+  /**
+   * @brief use the labels of another graph, for vertices copied from it
+   */
+  void share_seq_store(const VariationGraph& other);
+
   void add_edge(const Edge& edge); // handles the case where one or both of the vertices are invalid
+  /**
+   * @brief add an edge between the vertices with the ids v1 and v2
+   *
+   * @throws std::invalid_argument if either id is not that of a vertex
+   */
   std::size_t add_edge(std::size_t v1, VertexEnd v1_end, std::size_t v2, VertexEnd v2_end);
 
+  /**
+   * @brief build the CSR adjacency from the edges added so far
+   */
+  void freeze();
+
+  /**
+   * @brief adopt a CSR adjacency that was built elsewhere e.g. read from an index
+   */
+  void freeze(std::vector<std::size_t>&& adj_off, std::vector<std::size_t>&& adj);
+
+  /**
+   * @brief put the vertices in breadth first order from the tips (see
+   * povu::graph::bfs_order) so that walks over the graph touch vertices that
+   * are close together
+   *
+   * Ids are kept. Edges keep their order so paths are enumerated as before,
+   * only the vertex indexes in them change. Refreezes the graph.
+   */
+  void sort_bfs();
+
   void add_path(const path_t &path);
-  void set_raw_paths(std::vector<std::vector<id_n_orientation_t>> &raw_paths);
+  void set_raw_paths(std::vector<std::vector<id_n_orientation_t>> raw_paths);
 
   void add_tip(std::size_t node_id, VertexEnd end);
 
@@ -429,6 +487,10 @@ public:
   handlegraph::handle_t create_handle(const std::string& sequence,
                                       const handlegraph::nid_t& id);
 
+  // as above but appends the sequence straight into the label store
+  handlegraph::handle_t create_handle(std::string_view sequence,
+                                      const handlegraph::nid_t& id);
+
   // this seems to assume a biedged representation
   void create_edge(const handlegraph::handle_t& left, const handlegraph::handle_t& right);
 
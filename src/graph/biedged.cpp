@@ -1,11 +1,16 @@
+#include <algorithm>
 #include <cstddef>
+#include <cstdint>
 #include <format>
 #include <iostream>
+#include <map>
 #include <set>
+#include <span>
 #include <stdexcept>
 #include <string>
 #include <vector>
 #include <stack>
+#include <tuple>
 
 #include "./biedged.hpp"
 #include "../common/utils.hpp"
@@ -123,21 +128,25 @@ Vertex::Vertex() :
   black_edge(pc::UNDEFINED_SIZE_T),
   grey_edges(std::set<std::size_t>()),
   type(v_type::l),
-  handle(std::string()),
+  id_(pc::INVALID_ID),
   vertex_idx(0)
 {}
 
-Vertex::Vertex(const std::string& id, std::size_t vertex_idx, v_type vertex_type) :
+Vertex::Vertex(std::size_t id, std::size_t vertex_idx, v_type vertex_type) :
   black_edge(pc::UNDEFINED_SIZE_T),
   grey_edges(std::set<std::size_t>()),
   type(vertex_type),
-  handle(id),
+  id_(id),
   vertex_idx(vertex_idx)
 {}
 
 
-const std::string& Vertex::get_handle() const {
-    return this->handle;
+std::size_t Vertex::get_id() const {
+  return this->id_;
+}
+
+std::string Vertex::get_handle() const {
+  return pgt::vertex_name(this->id_);
 }
 
 std::set<std::size_t> const& Vertex::get_grey_edges() const {
@@ -224,10 +233,9 @@ BVariationGraph::BVariationGraph(const povu::graph::Graph &g, bool add_dummy_ver
     // add vertices + and -
     // --------------------
 
-    std::string v_id_str = std::to_string(v_id); // TODO: stop passing a string for ID?
     {
-      this->vertices.push_back(Vertex(v_id_str, i_l, v_type::l));
-      this->vertices.push_back(Vertex(v_id_str, i_r, v_type::r));
+      this->vertices.push_back(Vertex(v_id, i_l, v_type::l));
+      this->vertices.push_back(Vertex(v_id, i_r, v_type::r));
     }
 
     // ----------------
@@ -250,9 +258,9 @@ BVariationGraph::BVariationGraph(const povu::graph::Graph &g, bool add_dummy_ver
   /*
     add gray edges
   */
-  auto do_gray_edges = [&](std::size_t v_idx, povu::graph::Vertex const& current_vg_vertex, std::size_t i_l, std::size_t i_r) {
+  auto do_gray_edges = [&](std::size_t v_idx, std::size_t i_l, std::size_t i_r) {
       // add gray edges incident with the 5' (left/+) vertex
-      for (auto e_idx : current_vg_vertex.get_edges_l()) {
+      for (auto e_idx : g.get_edges_l(v_idx)) {
         const povu::graph::Edge& e = g.get_edge(e_idx);
 
         std::size_t new_v1{};
@@ -287,7 +295,7 @@ BVariationGraph::BVariationGraph(const povu::graph::Graph &g, bool add_dummy_ver
       }
 
       // add gray edges incident with the 3' (right/-) vertex
-      for (auto e_idx : current_vg_vertex.get_edges_r()) {
+      for (auto e_idx : g.get_edges_r(v_idx)) {
 
         const povu::graph::Edge& e = g.get_edge(e_idx);
 
@@ -327,7 +335,7 @@ BVariationGraph::BVariationGraph(const povu::graph::Graph &g, bool add_dummy_ver
   // add dummy vertex to make it all one SCC
   if (add_dummy_vertices) {
     this->dummy_vertices_.push_back(0);
-    this->vertices.push_back(Vertex("d_s", 0, v_type::dummy));
+    this->vertices.push_back(Vertex(pc::DUMMY_VERTEX_ID, 0, v_type::dummy));
   }
 
   // add duplicate vertices and black edges
@@ -340,7 +348,7 @@ BVariationGraph::BVariationGraph(const povu::graph::Graph &g, bool add_dummy_ver
   // add gray edges between duplicated vertices
   for (std::size_t i {}; i < g.size(); ++i) {
     auto [l, r] =  pu::frm_bidirected_idx(i);
-    do_gray_edges(i, g.get_vertex_by_idx(i),  l , r);
+    do_gray_edges(i, l , r);
   }
 
   // connect dummy vertices to tips
@@ -430,6 +438,12 @@ e  }
 */
 std::vector<std::pair<color, std::size_t>> BVariationGraph::get_neighbours(std::size_t vertex_idx) const {
   std::vector<std::pair<color, std::size_t>> neighbours;
+  this->get_neighbours(vertex_idx, neighbours);
+  return neighbours;
+}
+
+void BVariationGraph::get_neighbours(std::size_t vertex_idx,
+                                     std::vector<std::pair<color, std::size_t>>& neighbours) const {
   Vertex const& v = this->get_vertex(vertex_idx);
 
 
@@ -447,9 +461,6 @@ std::vector<std::pair<color, std::size_t>> BVariationGraph::get_neighbours(std::
     std::pair<color, std::size_t> p = std::make_pair(color::gray, other_vertex);
     neighbours.push_back(p);
   }
-
-
-  return neighbours;
 }
 
 const biedged::Vertex& BVariationGraph::get_vertex(std::size_t i) const {
@@ -510,32 +521,30 @@ std::size_t BVariationGraph::add_edge(std::size_t v1, v_type v1_type,
   return this->edges.size() - 1;
 }
 
-void BVariationGraph::add_vertex(std::string handle_str, v_type vertex_type) {
-  vertices.push_back(Vertex(handle_str, vertices.size(), vertex_type));
+void BVariationGraph::add_vertex(std::size_t v_id, v_type vertex_type) {
+  vertices.push_back(Vertex(v_id, vertices.size(), vertex_type));
 }
 
-bool BVariationGraph::replace_vertex(std::size_t vertex_idx, std::string handle_str, v_type vertex_type) {
-  if (this->get_vertex(vertex_idx).get_handle() != "") {
+bool BVariationGraph::replace_vertex(std::size_t vertex_idx, std::size_t v_id, v_type vertex_type) {
+  if (this->get_vertex(vertex_idx).get_id() != pc::INVALID_ID) {
     return false;
   }
 
-  this->get_vertex_mut(vertex_idx) = Vertex(handle_str, vertex_idx, vertex_type);
+  this->get_vertex_mut(vertex_idx) = Vertex(v_id, vertex_idx, vertex_type);
   return true;
 }
 
 void BVariationGraph::update_eq_classes(pst::Tree& st) {
-  const std::map<std::size_t, std::pair<pst::EdgeType, std::size_t>>& m = st.get_g_edge_idx_map();
-
-  for (auto& [e_idx, v] : m) {
-    auto [e_type, t_e_idx] = v;
-
-    std::size_t eq_class = (e_type == pst::EdgeType::tree_edge)
-      ? st.get_tree_edge(v.second).get_class()
-      : st.get_backedge(v.second).get_class();
-
-    //auto e = this->get_edge_mut(e_idx);
+  for (std::size_t i{}; i < st.tree_edge_count(); ++i) {
+    std::size_t e_idx = st.get_tree_edge_g_idx(i);
+    if (e_idx == pc::UNDEFINED_SIZE_T) { continue; }
+    this->get_edge_mut(e_idx).set_eq_class(st.get_tree_edge(i).get_class());
+  }
 
-    this->get_edge_mut(e_idx).set_eq_class(eq_class);
+  for (std::size_t i{}; i < st.back_edge_count(); ++i) {
+    std::size_t e_idx = st.get_backedge_g_idx(i);
+    if (e_idx == pc::UNDEFINED_SIZE_T) { continue; }
+    this->get_edge_mut(e_idx).set_eq_class(st.get_backedge(i).get_class());
   }
 }
 
@@ -591,9 +600,9 @@ void validate_spanning_tree(BVariationGraph const &g, pst::Tree &t,
   }
 
   for (std::size_t v{}; v < t.size() ; v++) {
-    std::set<std::size_t>const& children = t.get_children(v);
-    std::set<std::size_t>const& obe = t.get_obe(v);
-    std::set<std::size_t> const &ibe = t.get_ibe(v);
+    std::span<const std::size_t> children = t.get_children(v);
+    std::span<const std::size_t> obe = t.get_obe_idxs(v);
+    std::span<const std::size_t> ibe = t.get_ibe_idxs(v);
 
     //dfs_num_to_vtx[v];
 
@@ -611,7 +620,7 @@ void validate_spanning_tree(BVariationGraph const &g, pst::Tree &t,
       if (obe.size() + ibe.size() + children.size() + 1 != g.get_neighbours(    dfs_num_to_vtx[v]).size()) {
         std::cerr << std::format("neighbour mismatch {} ({} {}) {} {} {} {}\n",
                                  v,
-                                 t.get_vertex(v).name(),
+                                 t.get_vertex_name(v),
                                  g.get_vertex(dfs_num_to_vtx[v]).get_handle(),
                                  obe.size(),
                                  ibe.size(),
@@ -630,7 +639,8 @@ void validate_spanning_tree(BVariationGraph const &g, pst::Tree &t,
       }
     }
 
-    for (std::size_t tgt : t.get_obe(v)) {
+    for (std::size_t be_idx : obe) {
+      std::size_t tgt = t.get_backedge(be_idx).get_tgt();
       if (t.get_vertex(v).dfs_num() <= t.get_vertex(tgt).dfs_num()) {
         std::cerr << std::format("obe weird {} {} {} {}\n",
                                  v,
@@ -640,7 +650,8 @@ void validate_spanning_tree(BVariationGraph const &g, pst::Tree &t,
       }
     }
 
-    for (std::size_t src : t.get_ibe(v)) {
+    for (std::size_t be_idx : ibe) {
+      std::size_t src = t.get_backedge(be_idx).get_src();
       if (t.get_vertex(v).dfs_num() >= t.get_vertex(src).dfs_num()) {
         std::cerr << std::format("ibe weird {} {} {} {}\n",
                                  v,
@@ -653,24 +664,47 @@ void validate_spanning_tree(BVariationGraph const &g, pst::Tree &t,
 }
 
 
-pst::Tree BVariationGraph::compute_spanning_tree() const {
-  pst::Tree t = pst::Tree(this->size());
-
-  std::stack<std::tuple<std::size_t, std::size_t, pgt::color>> s; // parent indedx in the biedged graph, vertex idx and color
+namespace {
+v_type vertex_type(BVariationGraph const& g, std::size_t v_idx) { return g.get_vertex(v_idx).get_type(); }
+v_type vertex_type(BVariationGraphView const& g, std::size_t v_idx) { return g.get_type(v_idx); }
+std::size_t vertex_id(BVariationGraph const& g, std::size_t v_idx) { return g.get_vertex(v_idx).get_id(); }
+std::size_t vertex_id(BVariationGraphView const& g, std::size_t v_idx) { return g.get_id(v_idx); }
+
+/**
+ * @brief the DFS spanning tree of a biedged graph, G is a BVariationGraph or a
+ * BVariationGraphView
+ *
+ * Each vertex on the stack keeps a cursor into its neighbours, which sit on a
+ * stack of their own, so a vertex's neighbours are computed once and scanned
+ * once.
+ *
+ * A non tree edge is found from both of its ends. It is added as a back edge
+ * from the end that gets to it first, which is the end the other one has
+ * already finished with, so the state of the other end is enough to tell if it
+ * has been added. The only neighbour a vertex can list twice is its black
+ * neighbour when a grey self loop joins the two as well.
+ */
+template <typename G>
+pst::Tree dfs_spanning_tree(G const& g, std::pmr::memory_resource* mr) {
+  enum class state : std::uint8_t { unvisited, on_stack, done };
+
+  struct frame {
+    std::size_t p_idx;      // parent index in the biedged graph
+    std::size_t v_idx;
+    pgt::color c;           // color of the edge from the parent
+    std::size_t nbr_begin;  // start of the neighbours of v_idx in nbrs
+    std::size_t cursor;     // the next neighbour to look at
+  };
 
-  std::vector<bool> visited(this->size(), false); // visited vertices
+  pst::Tree t = pst::Tree(g.size(), mr);
 
-  std::size_t v_idx {}; // set start node to 0
-  s.push({pc::INVALID_ID, v_idx, color::gray});
-  visited[v_idx] = true;
+  std::pmr::vector<state> st(g.size(), state::unvisited, mr);
+  std::pmr::vector<std::size_t> vtx_to_dfs_num(g.size(), 0, mr);
+  std::pmr::vector<frame> s(mr);
+  std::vector<std::pair<color, std::size_t>> nbrs;
 
   std::size_t counter {}; // dfs pre visit counter
 
-  std::map<std::size_t, std::size_t> vtx_to_dfs_num;
-
-  std::vector<bool> in_tree(this->size(), false); // graph vertices in the tree
-  std::set<pt::unordered_pair<std::size_t>> back_edges; // avoids duplicate back edges
-
   auto is_parent = [&](std::size_t p, std::size_t c) -> bool {
     return t.get_vertex(vtx_to_dfs_num[c]).get_parent_idx() == vtx_to_dfs_num[p];
   };
@@ -679,73 +713,202 @@ pst::Tree BVariationGraph::compute_spanning_tree() const {
     return is_parent(n, v_idx) || is_parent(v_idx, n);
   };
 
-  auto is_self_loop = [&](std::size_t n, std::size_t v_idx) -> bool {
-    if (!is_parent_child(n, v_idx)) {
-      return false;
-    }
+  // start at vertex 0
+  s.push_back({pc::INVALID_ID, 0, color::gray, pc::INVALID_IDX, 0});
+  st[0] = state::on_stack;
 
-    if (this->get_vertex(v_idx).get_type() == v_type::dummy || this->get_vertex(n).get_type() == v_type::dummy) {
-      return false;
+  while (!s.empty()) {
+    std::size_t f_idx = s.size() - 1;
+    std::size_t v_idx = s[f_idx].v_idx;
+
+    if (s[f_idx].nbr_begin == pc::INVALID_IDX) {
+      t.add_vertex(pst::Vertex{counter, vertex_type(g, v_idx)}, vertex_id(g, v_idx));
+      vtx_to_dfs_num[v_idx] = counter;
+
+      if (s[f_idx].p_idx != pc::INVALID_ID) {
+        t.add_tree_edge(vtx_to_dfs_num[s[f_idx].p_idx], counter, pc::UNDEFINED_SIZE_T, s[f_idx].c);
+      }
+
+      counter++;
+
+      s[f_idx].nbr_begin = s[f_idx].cursor = nbrs.size();
+      g.get_neighbours(v_idx, nbrs);
     }
 
-    std::size_t v_handle = std::stoull (this->get_vertex(v_idx).get_handle());
-    std::size_t n_handle = std::stoull (this->get_vertex(n).get_handle());
+    const std::size_t nbr_begin = s[f_idx].nbr_begin;
+    const std::size_t nbr_end = nbrs.size();
 
-    if (n_handle != v_handle) {
-      return false;
+    // the black neighbour comes first, a grey edge to it is a self loop
+    std::size_t partner { pc::INVALID_IDX };
+    bool grey_loop { false };
+    if (nbr_begin < nbr_end && nbrs[nbr_begin].first == color::black) {
+      partner = nbrs[nbr_begin].second;
+      for (std::size_t i { nbr_begin + 1 }; i < nbr_end && !grey_loop; ++i) {
+        grey_loop = nbrs[i].second == partner;
+      }
     }
 
+    auto is_self_loop = [&](std::size_t n) -> bool {
+      return grey_loop && n == partner && is_parent_child(n, v_idx) && vertex_type(g, n) != v_type::dummy;
+    };
+
+    bool explored {true};
+    for (std::size_t& i = s[f_idx].cursor; i < nbr_end; ++i) {
+      auto [c, n] = nbrs[i];
+
+      if (st[n] == state::unvisited) {
+        // the cursor stays on n, it is looked at again once n is done
+        st[n] = state::on_stack;
+        s.push_back({v_idx, n, c, pc::INVALID_IDX, 0});
+        explored = false;
+        break;
+      }
 
-    for (auto e_idx : this->get_vertex(v_idx).get_grey_edges()) {
-      if (this->get_edge(e_idx).get_other_vertex(v_idx) == n) {
-        return true;
+      bool added = st[n] == state::done || (n == partner && i > nbr_begin);
+      if ((is_self_loop(n) || !is_parent_child(n, v_idx)) && !added) {
+        t.add_be(vtx_to_dfs_num[v_idx], vtx_to_dfs_num[n], pc::UNDEFINED_SIZE_T, pst::EdgeType::back_edge, c);
       }
     }
 
-    return false;
-  };
+    if (explored) {
+      st[v_idx] = state::done;
+      nbrs.resize(nbr_begin);
+      s.pop_back();
+    }
+  }
 
+  t.freeze();
 
-  while (!s.empty()) {
-    auto [p_idx, v_idx, c] = s.top();
+  return t;
+}
+} // namespace
 
-    biedged::Vertex const& v = this->get_vertex(v_idx);
 
-    if (!in_tree[v_idx]) {
-      t.add_vertex(pst::Vertex{counter, v.get_handle(), v.get_type()});
-      in_tree[v_idx] = true;
-      vtx_to_dfs_num[v_idx] = counter;
+pst::Tree BVariationGraph::compute_spanning_tree() const {
+  return dfs_spanning_tree(*this, std::pmr::get_default_resource());
+}
 
-      if (p_idx != pc::INVALID_ID) {
-        t.add_tree_edge(vtx_to_dfs_num[p_idx], counter, pc::UNDEFINED_SIZE_T, c);
-      }
 
-      counter++;
+/*
+  ===================
+  BVariationGraphView
+  ===================
+*/
+
+BVariationGraphView::BVariationGraphView(const povu::graph::Graph& g)
+  : g_(g), is_tip_(2 * g.size() + 1, false) {
+  for (auto [side, v_idx] : g.tips()) {
+    auto [l, r] = pu::frm_bidirected_idx(v_idx);
+    this->is_tip_[side == v_end::l ? l : r] = true;
+  }
+}
+
+std::size_t BVariationGraphView::size() const { return 2 * this->g_.size() + 1; }
+
+v_type BVariationGraphView::get_type(std::size_t vertex_idx) const {
+  if (vertex_idx == 0) { return v_type::dummy; }
+  return vertex_idx % 2 == 1 ? v_type::l : v_type::r;
+}
+
+std::size_t BVariationGraphView::get_id(std::size_t vertex_idx) const {
+  if (vertex_idx == 0) { return pc::DUMMY_VERTEX_ID; }
+  return this->g_.v_idx_to_id((vertex_idx - 1) / 2);
+}
+
+std::size_t BVariationGraphView::other_vertex(std::size_t e_idx, std::size_t v_idx, v_end s) const {
+  const povu::graph::Edge& e = this->g_.get_edge(e_idx);
+
+  // same as BVariationGraph, a self loop resolves to the side of v1 or v2
+  bool from_v1 = (s == v_end::l) ? e.get_v1_idx() != v_idx : e.get_v2_idx() == v_idx;
+  std::size_t n_idx = from_v1 ? e.get_v1_idx() : e.get_v2_idx();
+  v_end n_end = from_v1 ? e.get_v1_end() : e.get_v2_end();
+
+  auto [l, r] = pu::frm_bidirected_idx(n_idx);
+  return n_end == v_end::l ? l : r;
+}
+
+void BVariationGraphView::check_self_loops() const {
+  for (std::size_t v_idx{}; v_idx < this->g_.size(); ++v_idx) {
+    auto [i_l, i_r] = pu::frm_bidirected_idx(v_idx);
+
+    for (std::size_t e_idx : this->g_.get_edges_l(v_idx)) {
+      std::size_t n = this->other_vertex(e_idx, v_idx, v_end::l);
+      if (n != i_l) { continue; }
+
+      const povu::graph::Edge& e = this->g_.get_edge(e_idx);
+      auto [l, r] = pu::frm_bidirected_idx(e.get_v2_idx());
+      std::cout << "error edge e: " << e.get_v1_idx() << std::endl;
+      std::cout << "v_idx " << v_idx << " " << e.get_v1_idx() << " " << e.get_v2_end() << std::endl;
+      std::cout << "n " << n << "r " << r << " l " << l << std::endl;
+      throw std::invalid_argument(
+        std::format("[povu::graph::biedged::Edge] Self-loops are not allowed {} {}", n, i_l));
     }
 
-    bool explored {true};
-    for (auto [c, n] : this->get_neighbours(v_idx)) {
-      if (!visited[n]) {
-        s.push({v_idx, n, c});
-        visited[n] = true;
-        explored = false;
+    for (std::size_t e_idx : this->g_.get_edges_r(v_idx)) {
+      if (this->other_vertex(e_idx, v_idx, v_end::r) == i_r) {
+        std::cout << "i_r "<< i_r << std::endl;
         break;
       }
-      else if ((is_self_loop(n, v_idx) || !is_parent_child(n, v_idx)) && !back_edges.count({n, v_idx}))  {
-        t.add_be(vtx_to_dfs_num[v_idx], vtx_to_dfs_num[n], pc::UNDEFINED_SIZE_T, pst::EdgeType::back_edge, c);
-        back_edges.insert({v_idx, n});
-      }
     }
+  }
+}
+
+void BVariationGraphView::get_neighbours(std::size_t vertex_idx,
+                                         std::vector<std::pair<color, std::size_t>>& neighbours) const {
+  if (vertex_idx == 0) {
+    if (this->g_.tips().empty()) { return; }
+
+    auto to_biedged = [](side_n_id_t t) {
+      auto [l, r] = pu::frm_bidirected_idx(t.v_idx);
+      return t.v_end == v_end::l ? l : r;
+    };
+
+    // the entry tip first, the DFS reaches the whole component from it
+    side_n_id_t entry = this->g_.entry_tip();
+    neighbours.push_back({color::gray, to_biedged(entry)});
+    for (side_n_id_t t : this->g_.tips()) {
+      if (t.v_idx != entry.v_idx || t.v_end != entry.v_end) { neighbours.push_back({color::gray, to_biedged(t)}); }
+    }
+    return;
+  }
 
+  std::size_t u = vertex_idx;
+  std::size_t v_idx = (u - 1) / 2;
+  v_end s = this->get_type(u) == v_type::l ? v_end::l : v_end::r;
 
-    if (explored) { s.pop(); }
+  neighbours.push_back({color::black, s == v_end::l ? u + 1 : u - 1});
+
+  // (neighbour, rank of the edge in the side adjacency)
+  std::vector<std::pair<std::size_t, std::size_t>>& grey = this->scratch_;
+  grey.clear();
+  std::span<const std::size_t> e_idxs = this->g_.get_edges(v_idx, s);
+  for (std::size_t i{}; i < e_idxs.size(); ++i) {
+    std::size_t n = this->other_vertex(e_idxs[i], v_idx, s);
+    if (n != u) { grey.push_back({n, i}); }
   }
 
-  //#ifdef DEBUG   // check the correctness of the tree
-  // validate_spanning_tree(*this, t, dfs_num_to_vtx);
-  //#endif
+  // one grey edge per neighbour, made at the first edge between the two
+  std::sort(grey.begin(), grey.end());
+  grey.erase(std::unique(grey.begin(), grey.end(),
+                         [](auto const& a, auto const& b) { return a.first == b.first; }),
+             grey.end());
 
-  return t;
+  // grey edges are made going through the sides in biedged index order, so an
+  // edge to a smaller vertex is older than the ones made from this side
+  auto key = [u](std::pair<std::size_t, std::size_t> const& x) {
+    return std::make_pair(std::min(u, x.first), x.second);
+  };
+  std::sort(grey.begin(), grey.end(), [&](auto const& a, auto const& b) { return key(a) < key(b); });
+
+  for (auto [n, _] : grey) { neighbours.push_back({color::gray, n}); }
+
+  // edges to the dummy vertex are made last
+  if (this->is_tip_[u]) { neighbours.push_back({color::gray, 0}); }
+}
+
+pst::Tree BVariationGraphView::compute_spanning_tree(std::pmr::memory_resource* mr) const {
+  this->check_self_loops();
+  return dfs_spanning_tree(*this, mr);
 }
 
 }; // namespace biedged
@@ -2,6 +2,10 @@
 #define BIEDGED_HPP
 
 #include <cstddef>
+#include <memory_resource>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include "./graph.hpp"
 //#include "./bidirected.hpp"
@@ -77,10 +81,10 @@ class Vertex {
   pgt::VertexType type; // is this a 5' or a 3' vertex
 
   /*
-    the name of the vertex in the input GFA
-    note that 2 BEC vertices have the same handle
+    the id of the vertex in the input GFA, pc::DUMMY_VERTEX_ID for the dummy
+    note that 2 BEC vertices have the same id
    */
-  std::string handle; // rename to id and store a size_t
+  std::size_t id_;
 
   // index of the vertex in the vertex vector
   std::size_t vertex_idx;
@@ -90,14 +94,15 @@ public:
   // constructor(s)
   // --------------
   Vertex();
-  Vertex(const std::string& id, std::size_t vertex_idx, VertexType vertex_type);
+  Vertex(std::size_t id, std::size_t vertex_idx, VertexType vertex_type);
 
 
   // ---------
   // getter(s)
   // ---------
   bool is_reversed() const;
-  const std::string& get_handle() const;
+  std::size_t get_id() const;
+  std::string get_handle() const; // the id as a string, for output
   VertexType get_type() const;
   std::set<std::size_t> const& get_grey_edges() const;
   std::size_t get_black_edge() const;
@@ -158,6 +163,8 @@ public:
   const Vertex& get_vertex(std::size_t vertex_idx) const;
   const std::vector<size_t> &get_dummy_vertices() const;
   std::vector<std::pair<color, std::size_t>> get_neighbours(std::size_t vertex_idx) const;
+  // appends the neighbours of the vertex to neighbours
+  void get_neighbours(std::size_t vertex_idx, std::vector<std::pair<color, std::size_t>>& neighbours) const;
 
 
   // -------
@@ -171,8 +178,8 @@ public:
                        std::size_t v2, VertexType v2_type,
                        color c, std::string label);
 
-  void add_vertex(std::string handle_str, VertexType vertex_type);
-  bool replace_vertex(std::size_t vertex_idx, std::string handle_str, VertexType vertex_type);
+  void add_vertex(std::size_t v_id, VertexType vertex_type);
+  bool replace_vertex(std::size_t vertex_idx, std::size_t v_id, VertexType vertex_type);
   void update_eq_classes(pst::Tree &tree);
 
 
@@ -192,5 +199,52 @@ public:
   pst::Tree compute_spanning_tree() const;
 };
 
+/**
+ * An implicit biedged view of a bidirected graph
+ *
+ * Vertex 0 is the dummy vertex, the left and right vertices of the bidirected
+ * vertex at index i are 2i + 1 and 2i + 2. Black edges follow from the indexes
+ * and grey edges are read from the side adjacency of the bidirected graph, so
+ * nothing is materialised. Neighbours come in the same order as those of the
+ * BVariationGraph built from the same graph which makes the spanning trees
+ * identical.
+ */
+class BVariationGraphView {
+  const povu::graph::Graph& g_;
+  std::vector<bool> is_tip_; // indexed by biedged vertex
+
+  // scratch space for get_neighbours
+  mutable std::vector<std::pair<std::size_t, std::size_t>> scratch_;
+
+  // the biedged vertex at the other end of the edge at e_idx seen from side s of v_idx
+  std::size_t other_vertex(std::size_t e_idx, std::size_t v_idx, pgt::v_end s) const;
+
+  // print and throw for the self loops biedging rejects
+  void check_self_loops() const;
+
+public:
+  BVariationGraphView(const povu::graph::Graph& g);
+
+  // number of biedged vertices including the dummy vertex
+  std::size_t size() const;
+  VertexType get_type(std::size_t vertex_idx) const;
+  // the id of the vertex in the input GFA, pc::DUMMY_VERTEX_ID for the dummy vertex
+  std::size_t get_id(std::size_t vertex_idx) const;
+
+  /**
+   * @brief the black neighbour first, then the grey neighbours in the order
+   * their edges would have been created and the dummy vertex last
+   *
+   * appends them to neighbours
+   */
+  void get_neighbours(std::size_t vertex_idx, std::vector<std::pair<color, std::size_t>>& neighbours) const;
+
+  /**
+   * @brief Compute the DFS spanning tree of the graph, the tree and the DFS
+   * scratch are allocated from mr
+   */
+  pst::Tree compute_spanning_tree(std::pmr::memory_resource* mr = std::pmr::get_default_resource()) const;
+};
+
 }; // namespace biedged
 #endif
@@ -1,5 +1,4 @@
 #include "./bracket_list.hpp"
-#include <list>
 #include "../common/types.hpp"
 
 namespace povu::bracket_list {
@@ -11,6 +10,9 @@ using namespace povu::constants;
  * -------
  */
 
+Bracket::Bracket()
+  : back_edge_id_(UNDEFINED_SIZE_T), recent_size_(UNDEFINED_SIZE_T), recent_class_(UNDEFINED_SIZE_T){}
+
 Bracket::Bracket(std::size_t backedge_id)
   : back_edge_id_(backedge_id), recent_size_(UNDEFINED_SIZE_T), recent_class_(UNDEFINED_SIZE_T){}
 
@@ -22,50 +24,92 @@ void Bracket::set_recent_class(std::size_t c) { this->recent_class_ = c; }
 
 
 /*
- * BracketList Wrapper
- * -------------------
+ * BracketPool
+ * -----------
  */
 
-WBracketList::WBracketList() {
-  this->brackets = std::list<Bracket>{};
-  this->bracket_map = std::unordered_map<std::size_t, std::list<Bracket>::iterator>{};
+BracketPool::BracketPool(std::pmr::memory_resource* mr) : brackets_(mr) {}
+
+void BracketPool::reserve(std::size_t back_edge_count) {
+  this->brackets_.reserve(back_edge_count);
 }
 
-std::size_t WBracketList::size() const {
-  return this->brackets.size();
+void BracketPool::resize(std::size_t back_edge_count) {
+  this->brackets_.resize(back_edge_count);
 }
 
-void WBracketList::push(Bracket br) {
-  this->brackets.push_front(br);
-  this->bracket_map[br.back_edge_id()] = this->brackets.begin();
+void BracketPool::push(BracketList& l, std::size_t be_idx, std::size_t be_id) {
+  if (be_idx >= this->brackets_.size()) { this->brackets_.resize(be_idx + 1); }
+
+  Bracket& b = this->brackets_[be_idx];
+  b = Bracket(be_id);
+  b.next_ = l.head;
+  b.in_list_ = true;
+
+  if (l.head != INVALID_IDX) { this->brackets_[l.head].prev_ = be_idx; }
+  else { l.tail = be_idx; }
+
+  l.head = be_idx;
+  ++l.size;
 }
 
-Bracket& WBracketList::top() {
-  return this->brackets.front();
+void BracketPool::del(BracketList& l, std::size_t be_idx) {
+  if (be_idx >= this->brackets_.size() || !this->brackets_[be_idx].in_list_) { return; }
+
+  Bracket& b = this->brackets_[be_idx];
+
+  if (b.prev_ != INVALID_IDX) { this->brackets_[b.prev_].next_ = b.next_; }
+  else { l.head = b.next_; }
+
+  if (b.next_ != INVALID_IDX) { this->brackets_[b.next_].prev_ = b.prev_; }
+  else { l.tail = b.prev_; }
+
+  b.prev_ = b.next_ = INVALID_IDX;
+  b.in_list_ = false;
+  --l.size;
 }
 
-void WBracketList::del(std::size_t be_id) {
-  // check if bracket_map has the backedge_id
-  // TODO: the be_id should always be in the bracket_map, why the need to check?
-  if (this->bracket_map.find(be_id) == this->bracket_map.end()) {
-    return;
-    // throw std::runtime_error("Bracket not found");
+void BracketPool::concat(BracketList& parent, BracketList& child) {
+  if (child.empty()) { return; }
+
+  if (parent.empty()) {
+    parent = child;
   }
-  this->brackets.erase(this->bracket_map[be_id]);
-  this->bracket_map.erase(be_id);
+  else {
+    this->brackets_[child.tail].next_ = parent.head;
+    this->brackets_[parent.head].prev_ = child.tail;
+    parent.head = child.head;
+    parent.size += child.size;
+  }
+
+  child = BracketList{};
 }
 
-BracketList& WBracketList::get_bracket_list() {
-  return this->brackets;
+Bracket& BracketPool::top(const BracketList& l) {
+  return this->brackets_[l.head];
 }
 
-void WBracketList::concat(WBracketList* child) {
-  this->brackets.splice(this->brackets.begin(), child->get_bracket_list());
+void BracketPool::remap(const std::pmr::vector<std::size_t>& new_idx, std::size_t size, std::pmr::vector<BracketList>& lists) {
+  auto to_new = [&](std::size_t i) { return i == INVALID_IDX ? i : new_idx[i]; };
 
-  // update the bracket_map by iterating through the list
-  for (auto it = this->brackets.begin(); it != this->brackets.end(); ++it) {
-    this->bracket_map[it->back_edge_id()] = it;
+  std::pmr::vector<Bracket> moved(size, this->brackets_.get_allocator());
+  for (std::size_t i{}; i < this->brackets_.size() && i < new_idx.size(); ++i) {
+    if (new_idx[i] == INVALID_IDX) { continue; }
+    Bracket& b = moved[new_idx[i]];
+    b = this->brackets_[i];
+    b.prev_ = to_new(b.prev_);
+    b.next_ = to_new(b.next_);
   }
+  this->brackets_ = std::move(moved);
+
+  for (BracketList& l : lists) {
+    l.head = to_new(l.head);
+    l.tail = to_new(l.tail);
+  }
+}
+
+void BracketPool::set_back_edge_id(std::size_t be_idx, std::size_t be_id) {
+  this->brackets_[be_idx].back_edge_id_ = be_id;
 }
 
 } // namespace povu::bracket_list
@@ -1,29 +1,37 @@
 #ifndef B_LIST_HPP
 #define B_LIST_HPP
 
-#include <list>
 #include <cstddef>
-#include <unordered_map>
+#include <memory_resource>
+#include <vector>
 
+#include "../common/types.hpp"
 
-namespace povu::bracket_list {
-class Bracket;
-typedef std::list<Bracket> BracketList;
 
+namespace povu::bracket_list {
+class BracketPool;
 
 /*
  * Bracket
  * -------
  *  holds metadata about a back edge
  *
+ *  a bracket is also a node of the intrusive doubly linked list it is in, its
+ *  neighbours are referred to by their slot in the BracketPool
  */
 class Bracket {
   std::size_t back_edge_id_;
   std::size_t recent_size_;
   std::size_t recent_class_; // TODO: rename to class?
 
+  std::size_t prev_ { povu::constants::INVALID_IDX };
+  std::size_t next_ { povu::constants::INVALID_IDX };
+  bool in_list_ { false };
+
+  friend class BracketPool;
+
 public:
-  //Bracket(std::size_t backedge_id, std::size_t recent_size, std::size_t recent_class);
+  Bracket();
   Bracket(std::size_t backedge_id);
 
   std::size_t back_edge_id();
@@ -37,24 +45,51 @@ public:
 };
 
 /*
- * BracketList wrapper
- * -------------------
- *
- *
+ * BracketList
+ * -----------
+ * the top, bottom and size of a list whose nodes live in a BracketPool
+ */
+struct BracketList {
+  std::size_t head { povu::constants::INVALID_IDX }; // top
+  std::size_t tail { povu::constants::INVALID_IDX };
+  std::size_t size { 0 };
+
+  bool empty() const { return this->size == 0; }
+};
+
+/*
+ * BracketPool
+ * -----------
+ * the brackets of a tree, the bracket of a back edge sits in the slot of the
+ * back edge index. A back edge is in at most one list at a time so push, del,
+ * concat and size are all O(1).
  */
-class WBracketList {
-  BracketList brackets;
-  std::unordered_map<std::size_t, std::list<Bracket>::iterator> bracket_map;
+class BracketPool {
+  std::pmr::vector<Bracket> brackets_;
 
 public:
-  WBracketList();
-  void push(Bracket br);
-  std::size_t size() const;
-  Bracket& top();
-  BracketList& get_bracket_list();
-  std::unordered_map<std::size_t, std::list<Bracket>::iterator> get_bracket_map();
-  void del(std::size_t backedge_id);
-  void concat(WBracketList* other);
+  BracketPool() = default;
+  explicit BracketPool(std::pmr::memory_resource* mr);
+
+  void reserve(std::size_t back_edge_count);
+  void resize(std::size_t back_edge_count);
+
+  // push the bracket of a back edge onto the top of l
+  void push(BracketList& l, std::size_t be_idx, std::size_t be_id);
+
+  // remove the bracket of a back edge from l, a no-op if it is in no list
+  void del(BracketList& l, std::size_t be_idx);
+
+  // put the brackets of child on top of those of parent, leaves child empty
+  void concat(BracketList& parent, BracketList& child);
+
+  Bracket& top(const BracketList& l);
+
+  // move the bracket in slot i to slot new_idx[i], those mapped to INVALID_IDX
+  // are dropped, the links and the lists follow
+  void remap(const std::pmr::vector<std::size_t>& new_idx, std::size_t size, std::pmr::vector<BracketList>& lists);
+
+  void set_back_edge_id(std::size_t be_idx, std::size_t be_id);
 };
 
 } // namespace povu::bracket_list
@@ -1,9 +1,12 @@
+#include <algorithm>
 #include <cstddef>
 #include <iostream>
 #include <limits>
+#include <memory_resource>
+#include <set>
+#include <span>
 #include <tuple>
 #include <unordered_map>
-#include <unordered_set>
 #include <stack>
 #include <utility>
 #include <vector>
@@ -42,18 +45,56 @@ inline flubble forwardise(pt::id_t start_id, pgt::or_t start_or, pt::id_t end_id
   }
 }
 
+// one more than the largest class in stack_, classes index the scratch below
+std::size_t class_bound(const std::pmr::vector<oic>& stack_) {
+  std::size_t bound {};
+  for (const oic& x : stack_) { bound = std::max(bound, x.cls + 1); }
+  return bound;
+}
+
 /**
  * @brief Compute the equivalence class stack
  *
- * @param t The spanning tree
+ * @param t The spanning tree, the stack and its scratch come from its memory
+ * resource
  * @return The equivalence class stack
  */
-std::vector<oic> compute_eq_class_stack(pst::Tree& t) {
+std::pmr::vector<oic> compute_eq_class_stack(pst::Tree& t) {
   std::string fn_name = std::format("[povu::algorithms::flubble_tree::{}]", __func__);
 
+  std::pmr::memory_resource* mr = t.resource();
+
+  // the stack of a vertex is a list of nodes in a pool, linked by index, so
+  // that splicing the stack of a child into that of its parent is constant
+  // time and a push costs no allocation of its own
+  struct node {
+    oic x;
+    std::size_t next;
+  };
+  struct node_list {
+    std::size_t head { pc::INVALID_IDX };
+    std::size_t tail { pc::INVALID_IDX };
+  };
+  std::pmr::vector<node> pool(mr);
+  pool.reserve(t.size());
+
+  // put the nodes of c at the front or the back of l, leaves c empty
+  auto splice = [&](node_list& l, node_list& c, bool at_back) {
+    if (c.head == pc::INVALID_IDX) { return; }
+
+    if (l.head == pc::INVALID_IDX) { l = c; }
+    else if (at_back) { pool[l.tail].next = c.head; l.tail = c.tail; }
+    else { pool[c.tail].next = l.head; l.head = c.head; }
+
+    c = node_list{};
+  };
+
   // TODO: rename s to eq class stack
-  std::vector<std::list<oic> *> s (t.size(), nullptr);
-  std::set<std::size_t> seen;
+  std::pmr::vector<node_list> s (t.size(), mr);
+  // the sides of a vertex are joined by a black edge and the vertex is added
+  // from the side seen first, the other side is marked here. Indexed by tree
+  // vertex so that the cost does not depend on the order of the ids.
+  std::pmr::vector<bool> seen(t.size(), false, mr);
   std::size_t g_v_id {}; // the sequence id of the vertex as in the GFA
   std::size_t curr_class { pc::UNDEFINED_SIZE_T };
 
@@ -61,24 +102,19 @@ std::vector<oic> compute_eq_class_stack(pst::Tree& t) {
   auto add_to_stack = [&](std::size_t v) {
     const pst::Vertex& curr_vtx = t.get_vertex(v);
 
-    if (curr_vtx.is_leaf()) {
-      s[v] = new std::list<oic>{};
+    if (t.is_leaf(v)) {
+      return;
     }
-    else if (curr_vtx.get_children().size() > 1) { // is a branching point
-      s[v] = new std::list<oic>{};
-
+    else if (t.get_children(v).size() > 1) { // is a branching point
       for (auto c : t.get_children(v)) {
-        auto it = (curr_vtx.hi() == t.get_vertex(c).hi()) ? s[v]->end() : s[v]->begin();
-        s[v]->splice(it, *s[c]);
-        delete s[c];
-        s[c] = nullptr;
+        splice(s[v], s[c], curr_vtx.hi() == t.get_vertex(c).hi());
       }
     }
     else { // linear and has one child
-      std::size_t child_v_idx = *t.get_children(v).begin();
+      std::size_t child_v_idx = t.get_children(v).front();
 
       s[v] = s[child_v_idx];
-      s[child_v_idx] = nullptr;
+      s[child_v_idx] = node_list{};
     }
   };
 
@@ -90,24 +126,24 @@ std::vector<oic> compute_eq_class_stack(pst::Tree& t) {
     pgt::v_type curr_vtx_type = t.get_vertex(v).type();
 
     if (curr_vtx_type != pgt::v_type::dummy) {
-      g_v_id = std::stoull(t.get_vertex(v).name());
+      g_v_id = t.get_vertex_id(v);
     }
 
-    if (t.is_root(v) || seen.find(g_v_id) != seen.end()) { continue; }
-    seen.insert(g_v_id);
+    if (t.is_root(v) || seen[v]) { continue; }
 
     pgt::or_t curr_or;
 
     const pst::Edge& e =  t.get_parent_edge(v);
     if (e.get_color() == color::black) {
+      seen[e.get_parent_v_idx()] = true;
       curr_class = e.get_class();
       curr_or = curr_vtx_type == pgt::v_type::r ? pgt::or_t::forward : pgt::or_t::reverse;
     }
     else {
       bool found_black_edge { false };
 
-      const std::set<std::size_t>& obe_idxs = t.get_obe_idxs(v);
-      const std::set<std::size_t>& ibe_idxs = t.get_ibe_idxs(v);
+      std::span<const std::size_t> obe_idxs = t.get_obe_idxs(v);
+      std::span<const std::size_t> ibe_idxs = t.get_ibe_idxs(v);
 
       for (std::size_t be_idx : obe_idxs) {
         if (t.get_backedge(be_idx).get_color() == color::black) {
@@ -129,15 +165,20 @@ std::vector<oic> compute_eq_class_stack(pst::Tree& t) {
     }
 
     if (curr_class != pc::UNDEFINED_SIZE_T) {
-      s[v]->push_front({curr_or, g_v_id, curr_class});
+      pool.push_back({{curr_or, g_v_id, curr_class}, s[v].head});
+      if (s[v].head == pc::INVALID_IDX) { s[v].tail = pool.size() - 1; }
+      s[v].head = pool.size() - 1;
     }
     else {
-      throw std::runtime_error(std::format("{} No class found for vertex: {}", fn_name, t.get_vertex(v).name()));
+      throw std::runtime_error(std::format("{} No class found for vertex: {}", fn_name, t.get_vertex_name(v)));
     }
   }
 
-  std::vector<oic> stack_(s[t.get_root_idx()]->begin(), s[t.get_root_idx()]->end());
-  delete s[t.get_root_idx()];
+  std::pmr::vector<oic> stack_(mr);
+  stack_.reserve(pool.size());
+  for (std::size_t i { s[t.get_root_idx()].head }; i != pc::INVALID_IDX; i = pool[i].next) {
+    stack_.push_back(pool[i].x);
+  }
 
   return stack_;
 }
@@ -145,7 +186,7 @@ std::vector<oic> compute_eq_class_stack(pst::Tree& t) {
 /**
   * @brief Enumerate the flubbles
  */
-pvtr::Tree<flubble> construct_flubble_tree(const std::vector<oic>& stack_, const std::vector<std::size_t>& next_seen) {
+pvtr::Tree<flubble> construct_flubble_tree(const std::pmr::vector<oic>& stack_, const std::pmr::vector<std::size_t>& next_seen) {
   std::string fn_name = std::format("[povu::algorithms::flubble_tree::{}]", __func__);
 
   pvtr::Tree<flubble> ft;
@@ -154,8 +195,9 @@ pvtr::Tree<flubble> construct_flubble_tree(const std::vector<oic>& stack_, const
     std::size_t cl; // class
     std::size_t idx; // index in stack_
   };
-  std::stack<ci> s;
-  std::unordered_set<std::size_t> in_s; // classes in s
+  std::pmr::memory_resource* mr = next_seen.get_allocator().resource();
+  std::stack<ci, std::pmr::vector<ci>> s { std::pmr::vector<ci>(mr) };
+  std::pmr::vector<bool> in_s(class_bound(stack_), false, mr); // classes in s
 
   std::size_t prt_v { ft.root_idx() }; // parent vertex
 
@@ -163,11 +205,11 @@ pvtr::Tree<flubble> construct_flubble_tree(const std::vector<oic>& stack_, const
   for (std::size_t i {}; i < stack_.size(); ++i) {
     auto [or_curr, id_curr, cl_curr] = stack_[i];
 
-    if (in_s.count(cl_curr)) {
+    if (in_s[cl_curr]) {
 
       while (!s.empty() && s.top().cl != cl_curr) {
         s.pop();
-        in_s.erase(cl_curr);
+        in_s[cl_curr] = false;
       }
 
       s.pop();
@@ -186,20 +228,20 @@ pvtr::Tree<flubble> construct_flubble_tree(const std::vector<oic>& stack_, const
     }
 
     s.push({cl_curr, i});
-    in_s.insert(cl_curr);
+    in_s[cl_curr] = true;
   }
 
   return ft;
 }
 
-void compute_eq_class_metadata(const std::vector<oic> &stack_, std::vector<std::size_t>& next_seen) {
+void compute_eq_class_metadata(const std::pmr::vector<oic> &stack_, std::pmr::vector<std::size_t>& next_seen) {
 
-  std::unordered_map<std::size_t, std::size_t> next_seen_map;
-  next_seen_map.reserve(stack_.size());
+  // the index in stack_ a class was last seen at going backwards
+  std::pmr::vector<std::size_t> next_seen_map(class_bound(stack_), pc::INVALID_IDX, next_seen.get_allocator());
 
   for (std::size_t i {stack_.size()};  i-- > 0; ) {
     auto [or_curr, id_curr, cl_curr] = stack_[i];
-    std::size_t next_idx = (next_seen_map.contains(cl_curr)) ? next_seen_map[cl_curr] : i;
+    std::size_t next_idx = next_seen_map[cl_curr] != pc::INVALID_IDX ? next_seen_map[cl_curr] : i;
     next_seen[i] = next_idx;
     next_seen_map[cl_curr] = i;
   }
@@ -208,7 +250,7 @@ void compute_eq_class_metadata(const std::vector<oic> &stack_, std::vector<std::
 /**
   * @brief Enumerate the flubbles
  */
-std::vector<flubble> find_flubbles(const std::vector<oic>& stack_) {
+std::vector<flubble> find_flubbles(const std::pmr::vector<oic>& stack_) {
   std::string fn_name = std::format("[povu::algorithms::flubble_tree::{}]", __func__);
 
   std::vector<flubble> flubbles;
@@ -235,12 +277,45 @@ std::vector<flubble> find_flubbles(const std::vector<oic>& stack_) {
   return flubbles;
 }
 
+/**
+ * @brief put the chains back in place of the vertices that stand for them
+ *
+ * a chain walked in reverse is walked from its last vertex with each vertex in
+ * the other orientation, all of it is in the class of its vertex
+ */
+std::pmr::vector<oic> expand_chains(const std::pmr::vector<oic>& stack_, const povu::graph::chain_map& chains) {
+  std::pmr::vector<oic> expanded(stack_.get_allocator());
+  expanded.reserve(stack_.size());
+
+  auto flip = [](pgt::or_t o) { return o == pgt::or_t::forward ? pgt::or_t::reverse : pgt::or_t::forward; };
+
+  for (const oic& x : stack_) {
+    std::span<const pgt::id_or> chain = chains.get(x.id);
+    if (chain.empty()) {
+      expanded.push_back(x);
+    }
+    else if (x.orientation == pgt::or_t::forward) {
+      for (auto [id, o] : chain) { expanded.push_back({o, id, x.cls}); }
+    }
+    else {
+      for (auto it = chain.rbegin(); it != chain.rend(); ++it) { expanded.push_back({flip(it->orientation), it->v_idx, x.cls}); }
+    }
+  }
+
+  return expanded;
+}
+
 pvtr::Tree<flubble> st_to_ft(pst::Tree& t) {
+  return st_to_ft(t, povu::graph::chain_map{});
+}
+
+pvtr::Tree<flubble> st_to_ft(pst::Tree& t, const povu::graph::chain_map& chains) {
   std::string fn_name = std::format("[povu::algorithms::{}]", __func__);
 
-  std::vector<oic> s{compute_eq_class_stack(t)};
+  std::pmr::vector<oic> s{compute_eq_class_stack(t)};
+  if (!chains.empty()) { s = expand_chains(s, chains); }
 
-  std::vector<std::size_t> next_seen (s.size(), pc::INVALID_IDX);
+  std::pmr::vector<std::size_t> next_seen (s.size(), pc::INVALID_IDX, t.resource());
   compute_eq_class_metadata(s, next_seen);
 
 
@@ -255,7 +330,7 @@ std::vector<flubble> enumerate(pst::Tree& t) {
   std::chrono::duration<double> timeRefRead;
   auto t0 = pt::Time::now();
 
-  std::vector<oic> s { compute_eq_class_stack(t) };
+  std::pmr::vector<oic> s { compute_eq_class_stack(t) };
 
   bool time {true};
 
@@ -276,4 +351,20 @@ std::vector<flubble> enumerate(pst::Tree& t) {
   return flubbles;
 }
 
+pvtr::Tree<flubble> merge(const std::vector<pvtr::Tree<flubble>>& fts) {
+  pvtr::Tree<flubble> ft;
+
+  for (const pvtr::Tree<flubble>& b : fts) {
+    // the vertex at index i > 0 of b moves to index offset + i
+    std::size_t offset = ft.size() - 1;
+    for (std::size_t i { 1 }; i < b.size(); ++i) {
+      std::size_t v_idx = ft.add_vertex(b.get_vertex(i));
+      std::size_t p_idx = b.get_parent_idx(i);
+      ft.add_edge(p_idx == b.root_idx() ? ft.root_idx() : offset + p_idx, v_idx);
+    }
+  }
+
+  return ft;
+}
+
 }
@@ -4,6 +4,7 @@
 
 #include <vector>
 
+#include "../graph/graph.hpp"
 #include "../graph/spanning_tree.hpp"
 #include "../graph/tree.hpp"
 #include "../common/types.hpp"
@@ -24,7 +25,23 @@ std::vector<graph_types::canonical_sese> find_seses(pst::Tree& t);
  *
  */
 pvtr::Tree<pgt::flubble> st_to_ft(pst::Tree& t);
+
+/**
+ * @brief spanning tree of a compacted graph (see compact_chains) to bubble tree
+ *
+ * the vertices that stand for chains are replaced by the chains in the eq class
+ * stack, so the flubbles are reported with the ids of the input graph
+ */
+pvtr::Tree<pgt::flubble> st_to_ft(pst::Tree& t, const povu::graph::chain_map& chains);
 std::vector<pgt::flubble> enumerate(pst::Tree& t);
+
+/**
+ * @brief put the flubble trees of the blocks of a component under one root
+ *
+ * the vertices of each tree keep their pre-order and follow those of the trees
+ * before it
+ */
+pvtr::Tree<pgt::flubble> merge(const std::vector<pvtr::Tree<pgt::flubble>>& fts);
 }
 
 
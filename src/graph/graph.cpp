@@ -1,14 +1,18 @@
 #include "./graph.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cassert>
 #include <cstddef>
-#include <stack>
-#include <unordered_set>
 #include <format>
+#include <stdexcept>
 #include <string>
 #include <sys/types.h>
+#include <thread>
 
 namespace povu::graph {
 using namespace povu::graph_types;
 namespace pgt = povu::graph_types;
+namespace pc = povu::constants;
 
 
 /*
@@ -35,68 +39,103 @@ pgt::side_n_id_t Edge::get_other_vertex(std::size_t v_id) const {
  */
 Vertex::Vertex(std::size_t v_id) : v_id{v_id} {}
 std::size_t Vertex::id() const { return v_id; }
-void Vertex::add_edge_l(std::size_t e_id) { e_l.insert(e_id); }
-void Vertex::add_edge_r(std::size_t e_id) { e_r.insert(e_id); }
-const std::set<std::size_t>& Vertex::get_edges_l() const { return e_l; }
-const std::set<std::size_t>& Vertex::get_edges_r() const { return e_r; }
 
 /*
   Graph
   -----
  */
-Graph::Graph() {}
-Graph::Graph(std::size_t v_count, std::size_t e_count) {
-  this->vertices.reserve(v_count);
-  this->edges.reserve(e_count);
+Graph::Graph() : s_{std::make_shared<graph_store>()} {}
+Graph::Graph(std::size_t v_count, std::size_t e_count) : s_{std::make_shared<graph_store>()} {
+  this->s_->vertices.reserve(v_count);
+  this->s_->edges.reserve(e_count);
+  this->s_->v_id_to_idx.reserve(v_count);
 }
 
+Graph::Graph(std::shared_ptr<graph_store> s, std::size_t v_begin, std::size_t v_end,
+             std::size_t e_begin, std::size_t e_end, std::set<pgt::side_n_id_t>&& tips)
+  : s_{std::move(s)}, v_begin_{v_begin}, v_end_{v_end}, e_begin_{e_begin}, e_end_{e_end},
+    tips_{std::move(tips)} {}
+
 void Graph::add_vertex(std::size_t v_id) {
-  vertices.push_back(Vertex{v_id});
-  this->v_id_to_idx_.insert(v_id, vertices.size() - 1);
+  this->s_->vertices.push_back(Vertex{v_id});
+  this->s_->v_id_to_idx.insert(v_id, this->s_->vertices.size() - 1);
+  this->v_end_ = this->s_->vertices.size();
 }
 
 std::size_t Graph::v_idx_to_id(std::size_t v_idx) const {
-  return this->v_id_to_idx_.get_key(v_idx);
+  return this->s_->vertices[this->v_begin_ + v_idx].id();
 }
 
 std::size_t Graph::v_id_to_idx(std::size_t v_id) const {
-  return this->v_id_to_idx_.get_value(v_id);
+  std::size_t idx = this->s_->v_id_to_idx.get_idx(v_id);
+  if (idx == pc::INVALID_IDX || idx < this->v_begin_ || idx >= this->v_end_) { return pc::INVALID_IDX; }
+  return idx - this->v_begin_;
 }
 
-std::size_t Graph::size() const { return this->vertices.size(); }
-std::size_t Graph::edge_count() const { return this->edges.size(); }
+std::size_t Graph::size() const { return this->v_end_ - this->v_begin_; }
+std::size_t Graph::edge_count() const { return this->e_end_ - this->e_begin_; }
 const std::set<pgt::side_n_id_t> &Graph::tips() const { return this->tips_; }
-const Vertex& Graph::get_vertex_by_idx(std::size_t v_idx) const { return vertices[v_idx]; }
+const Vertex& Graph::get_vertex_by_idx(std::size_t v_idx) const { return this->s_->vertices[this->v_begin_ + v_idx]; }
 const Vertex &Graph::get_vertex_by_id(std::size_t v_id) const {
-  return vertices[this->v_id_to_idx_.get_value(v_id)];
+  return this->get_vertex_by_idx(this->v_id_to_idx(v_id));
+}
+
+const Edge& Graph::get_edge(std::size_t e_id) const { return this->s_->edges[this->e_begin_ + e_id]; }
+
+std::span<const std::size_t> Graph::get_edges_l(std::size_t v_idx) const {
+  assert(this->s_->frozen);
+  const std::vector<std::size_t>& off = this->s_->adj_off;
+  std::size_t side = 2 * (this->v_begin_ + v_idx);
+  return std::span<const std::size_t>(this->s_->adj.data() + off[side], off[side + 1] - off[side]);
+}
+
+std::span<const std::size_t> Graph::get_edges_r(std::size_t v_idx) const {
+  assert(this->s_->frozen);
+  const std::vector<std::size_t>& off = this->s_->adj_off;
+  std::size_t side = 2 * (this->v_begin_ + v_idx) + 1;
+  return std::span<const std::size_t>(this->s_->adj.data() + off[side], off[side + 1] - off[side]);
 }
 
-const Edge& Graph::get_edge(std::size_t e_id) const { return edges[e_id]; }
+std::span<const std::size_t> Graph::get_edges(std::size_t v_idx, pgt::v_end end) const {
+  return end == pgt::v_end::l ? this->get_edges_l(v_idx) : this->get_edges_r(v_idx);
+}
 
 void Graph::add_tip(std::size_t v_id, pgt::v_end end) {
-  std::size_t v_idx = this->v_id_to_idx_.get_value(v_id);
+  std::size_t v_idx = this->v_id_to_idx(v_id);
   this->tips_.insert(pgt::side_n_id_t{end, v_idx} );
 }
 
-void Graph::add_edge(std::size_t v1_id, pgt::v_end v1_end, std::size_t v2_id, pgt::v_end v2_end) {
-  std::size_t v1_idx = this->v_id_to_idx_.get_value(v1_id);
-  std::size_t v2_idx = this->v_id_to_idx_.get_value(v2_id);
-  edges.push_back(Edge{v1_idx, v1_end, v2_idx, v2_end});
-  std::size_t e_idx = edges.size() - 1;
+void Graph::set_entry_tip(std::size_t v_id, pgt::v_end end) {
+  this->entry_tip_ = pgt::side_n_id_t{end, this->v_id_to_idx(v_id)};
+}
 
-  if (v1_end == pgt::v_end::l) {
-    this->vertices[v1_idx].add_edge_l(e_idx);
-  }
-  else {
-    this->vertices[v1_idx].add_edge_r(e_idx);
-  }
+pgt::side_n_id_t Graph::entry_tip() const {
+  return this->entry_tip_.has_value() ? this->entry_tip_.value() : *this->tips_.begin();
+}
 
-  if (v2_end == pgt::v_end::l) {
-    this->vertices[v2_idx].add_edge_l(e_idx);
-  }
-  else {
-    this->vertices[v2_idx].add_edge_r(e_idx);
+void Graph::add_edge(std::size_t v1_id, pgt::v_end v1_end, std::size_t v2_id, pgt::v_end v2_end) {
+  std::size_t v1_idx = this->s_->v_id_to_idx.get_idx(v1_id);
+  std::size_t v2_idx = this->s_->v_id_to_idx.get_idx(v2_id);
+  if (v1_idx == pc::INVALID_IDX || v2_idx == pc::INVALID_IDX) {
+    throw std::invalid_argument(std::format("[povu::graph::{}] no vertex with id {} for the edge {} {} {} {}", __func__,
+                                            v1_idx == pc::INVALID_IDX ? v1_id : v2_id,
+                                            v1_id, v1_end == pgt::v_end::l ? '+' : '-',
+                                            v2_id, v2_end == pgt::v_end::l ? '+' : '-'));
   }
+  this->s_->edges.push_back(Edge{v1_idx, v1_end, v2_idx, v2_end});
+  this->e_end_ = this->s_->edges.size();
+  this->s_->frozen = false;
+}
+
+void Graph::freeze() {
+  build_csr(this->s_->edges, this->s_->vertices.size(), this->s_->adj_off, this->s_->adj);
+  this->s_->frozen = true;
+}
+
+void Graph::freeze(std::vector<std::size_t>&& adj_off, std::vector<std::size_t>&& adj) {
+  this->s_->adj_off = std::move(adj_off);
+  this->s_->adj = std::move(adj);
+  this->s_->frozen = true;
 }
 
 void Graph::summary() const {
@@ -105,103 +144,606 @@ void Graph::summary() const {
   std::cout << "\t" << "edge count: " << this->edge_count() << std::endl;
 }
 
-std::vector<povu::graph::Graph> componetize(const povu::graph::Graph& g, const core::config& app_config) {
+
+/*
+  chain_map
+  ---------
+ */
+std::size_t chain_map::size() const { return this->off_.size() - 1; }
+bool chain_map::empty() const { return this->size() == 0; }
+
+std::span<const pgt::id_or> chain_map::get(std::size_t v_id) const {
+  std::size_t c = this->rep_to_chain_.get_idx(v_id);
+  if (c == pc::INVALID_IDX) { return {}; }
+  return std::span<const pgt::id_or>(this->steps_.data() + this->off_[c], this->off_[c + 1] - this->off_[c]);
+}
+
+void chain_map::add(std::size_t v_id, std::span<const pgt::id_or> steps) {
+  this->rep_to_chain_.insert(v_id, this->size());
+  this->steps_.insert(this->steps_.end(), steps.begin(), steps.end());
+  this->off_.push_back(this->steps_.size());
+}
+
+
+/*
+  componetize
+  -----------
+ */
+namespace {
+/**
+ * union-find over vertex indexes that threads can update concurrently
+ *
+ * a root is only ever linked below a smaller root with a CAS, so the root of a
+ * set is always its smallest member
+ */
+class concurrent_dsu {
+  std::vector<std::atomic<std::size_t>> parent_;
+
+public:
+  concurrent_dsu(std::size_t n) : parent_(n) {
+    for (std::size_t i {}; i < n; ++i) { this->parent_[i].store(i, std::memory_order_relaxed); }
+  }
+
+  std::size_t find(std::size_t x) {
+    while (true) {
+      std::size_t p = this->parent_[x].load(std::memory_order_relaxed);
+      if (p == x) { return x; }
+      std::size_t gp = this->parent_[p].load(std::memory_order_relaxed);
+      // path halving, losing the race only means less compression
+      if (gp != p) { this->parent_[x].compare_exchange_weak(p, gp, std::memory_order_relaxed); }
+      x = gp;
+    }
+  }
+
+  void unite(std::size_t a, std::size_t b) {
+    while (true) {
+      a = this->find(a);
+      b = this->find(b);
+      if (a == b) { return; }
+      if (a < b) { std::swap(a, b); }
+      // link the larger root below the smaller, retry if a stopped being a root
+      std::size_t expected = a;
+      if (this->parent_[a].compare_exchange_strong(expected, b, std::memory_order_acq_rel)) { return; }
+    }
+  }
+};
+
+/**
+ * @brief run f(begin, end) over [0, n) split across up to thread_count threads
+ */
+template <typename F>
+void parallel_for(std::size_t n, unsigned int thread_count, std::size_t min_chunk, F f) {
+  std::size_t t_count = std::max<std::size_t>(1, std::min<std::size_t>(thread_count, n / min_chunk));
+  if (t_count == 1) { f(0, n); return; }
+
+  std::vector<std::thread> threads;
+  std::size_t chunk = (n + t_count - 1) / t_count;
+  for (std::size_t t {}; t < t_count; ++t) {
+    std::size_t begin = std::min(n, t * chunk);
+    std::size_t end = std::min(n, begin + chunk);
+    threads.emplace_back(f, begin, end);
+  }
+  for (std::thread& t : threads) { t.join(); }
+}
+} // namespace
+
+std::vector<Graph> componetize(Graph&& g, const core::config& app_config, std::size_t min_chunk) {
   std::string fn_name = std::format("[povu::graph_ops::{}]", __func__);
   if (app_config.verbosity() > 4) { std::cerr << fn_name << std::endl; }
 
-  std::unordered_set<std::size_t> visited, explored;
-  std::stack<std::size_t> s;
+  auto t0 = pt::Time::now();
+
+  graph_store& s = *g.s_;
+  const std::size_t v_count = s.vertices.size();
+  const std::size_t e_count = s.edges.size();
+
+  // -----
+  // assign each vertex the smallest vertex index in its component
+  // -----
+  concurrent_dsu dsu(v_count);
+  parallel_for(e_count, app_config.thread_count(), min_chunk, [&](std::size_t begin, std::size_t end) {
+    for (std::size_t e_idx { begin }; e_idx < end; ++e_idx) {
+      dsu.unite(s.edges[e_idx].get_v1_idx(), s.edges[e_idx].get_v2_idx());
+    }
+  });
+
+  std::vector<std::size_t> comp_of(v_count);
+  parallel_for(v_count, app_config.thread_count(), min_chunk, [&](std::size_t begin, std::size_t end) {
+    for (std::size_t v_idx { begin }; v_idx < end; ++v_idx) { comp_of[v_idx] = dsu.find(v_idx); }
+  });
+
+  // number the components in order of their smallest vertex, a root is reached
+  // before any other member of its component
+  std::size_t comp_count {};
+  for (std::size_t v_idx {}; v_idx < v_count; ++v_idx) {
+    comp_of[v_idx] = comp_of[v_idx] == v_idx ? comp_count++ : comp_of[comp_of[v_idx]];
+  }
+
+  // -----
+  // new positions, vertices grouped by component then ordered by id and edges
+  // grouped by component keeping their relative order
+  // -----
+  std::vector<std::size_t> v_begin(comp_count + 1, 0), e_begin(comp_count + 1, 0);
+  for (std::size_t v_idx {}; v_idx < v_count; ++v_idx) { ++v_begin[comp_of[v_idx] + 1]; }
+  for (const Edge& e : s.edges) { ++e_begin[comp_of[e.get_v1_idx()] + 1]; }
+  for (std::size_t c {}; c < comp_count; ++c) {
+    v_begin[c + 1] += v_begin[c];
+    e_begin[c + 1] += e_begin[c];
+  }
 
-  s.push(0);
-  visited.insert(0);
+  std::vector<std::size_t> v_order(v_count); // new position -> old index
+  {
+    std::vector<std::size_t> pos(v_begin.begin(), v_begin.end() - 1);
+    for (std::size_t v_idx {}; v_idx < v_count; ++v_idx) { v_order[pos[comp_of[v_idx]]++] = v_idx; }
+  }
 
-  std::vector<povu::graph::Graph> components;
+  auto by_id = [&](std::size_t a, std::size_t b) { return s.vertices[a].id() < s.vertices[b].id(); };
+  for (std::size_t c {}; c < comp_count; ++c) {
+    auto first = v_order.begin() + v_begin[c];
+    auto last = v_order.begin() + v_begin[c + 1];
+    if (!std::is_sorted(first, last, by_id)) { std::sort(first, last, by_id); }
+  }
 
-  std::set<std::size_t> curr_edges;
-  std::set<std::size_t> curr_vertices;
-  std::set<pgt::side_n_id_t> curr_tips;
+  std::vector<std::size_t> v_pos(v_count); // old index -> new position
+  for (std::size_t p {}; p < v_count; ++p) { v_pos[v_order[p]] = p; }
+
+  std::vector<std::size_t> e_pos(e_count); // old index -> new position
+  {
+    std::vector<std::size_t> pos(e_begin.begin(), e_begin.end() - 1);
+    for (std::size_t e_idx {}; e_idx < e_count; ++e_idx) { e_pos[e_idx] = pos[comp_of[s.edges[e_idx].get_v1_idx()]]++; }
+  }
 
-  auto update = [&](std::size_t e_idx, std::size_t curr_v, bool& is_vtx_explored) {
-    std::size_t adj_v = g.get_edge(e_idx).get_other_vertex(curr_v).v_idx;
-    if (adj_v != curr_v && visited.find(adj_v) == visited.end()) {
-      s.push(adj_v);
-      visited.insert(adj_v);
-      is_vtx_explored = false;
+  // -----
+  // move the store into the new order, edges and adjacency refer to vertices
+  // and edges by their index within the component
+  // -----
+  {
+    std::vector<std::size_t> e_order(e_count); // new position -> old index
+    for (std::size_t e_idx {}; e_idx < e_count; ++e_idx) { e_order[e_pos[e_idx]] = e_idx; }
+
+    std::vector<Edge> edges;
+    edges.reserve(e_count);
+    for (std::size_t e_idx : e_order) {
+      const Edge& e = s.edges[e_idx];
+      std::size_t c_start = v_begin[comp_of[e.get_v1_idx()]];
+      edges.push_back(Edge{v_pos[e.get_v1_idx()] - c_start, e.get_v1_end(),
+                           v_pos[e.get_v2_idx()] - c_start, e.get_v2_end()});
     }
-  };
+    s.edges = std::move(edges);
+  }
 
-  while (!s.empty()) {
-    std::size_t v_idx = s.top();
-    const povu::graph::Vertex& v = g.get_vertex_by_idx(v_idx);
-    bool is_vtx_explored { true };
+  {
+    std::vector<std::size_t> adj_off(2 * v_count + 1, 0);
+    std::vector<std::size_t> adj;
+    adj.reserve(s.adj.size());
+    for (std::size_t p {}; p < v_count; ++p) {
+      std::size_t v_idx = v_order[p];
+      std::size_t c_start = e_begin[comp_of[v_idx]];
+      for (std::size_t side { 2 * v_idx }; side < 2 * v_idx + 2; ++side) {
+        // the old lists are ascending and e_pos is monotone within a component
+        for (std::size_t i { s.adj_off[side] }; i < s.adj_off[side + 1]; ++i) { adj.push_back(e_pos[s.adj[i]] - c_start); }
+        adj_off[2 * p + (side - 2 * v_idx) + 1] = adj.size();
+      }
+    }
+    s.adj_off = std::move(adj_off);
+    s.adj = std::move(adj);
+  }
+
+  {
+    std::vector<Vertex> vertices;
+    vertices.reserve(v_count);
+    pt::IdMap v_id_to_idx;
+    v_id_to_idx.reserve(v_count);
+    for (std::size_t p {}; p < v_count; ++p) {
+      vertices.push_back(s.vertices[v_order[p]]);
+      v_id_to_idx.insert(vertices.back().id(), p);
+    }
+    s.vertices = std::move(vertices);
+    s.v_id_to_idx = std::move(v_id_to_idx);
+  }
+
+  // a vertex contributes at most one tip, the left one if it has both
+  std::vector<std::set<pgt::side_n_id_t>> comp_tips(comp_count);
+  for (auto [end, v_idx] : g.tips()) {
+    if (end == pgt::v_end::r && g.tips().contains({pgt::v_end::l, v_idx})) { continue; }
+    std::size_t c = comp_of[v_idx];
+    comp_tips[c].insert({end, v_pos[v_idx] - v_begin[c]});
+  }
+
+  std::vector<Graph> components;
+  components.reserve(comp_count);
+  for (std::size_t c {}; c < comp_count; ++c) {
+    components.push_back(Graph(g.s_, v_begin[c], v_begin[c + 1], e_begin[c], e_begin[c + 1], std::move(comp_tips[c])));
+  }
+
+  if (app_config.verbosity() > 1) {
+    povu::utils::report_time(std::cerr, fn_name, "finding components", pt::Time::now() - t0);
+  }
 
-    std::set<std::size_t> const& e_l = v.get_edges_l();
-    std::set<std::size_t> const& e_r = v.get_edges_r();
+  return components;
+}
+
+
+/*
+  split_at_bridges
+  ----------------
+ */
+std::vector<Graph> split_at_bridges(const Graph& g, std::size_t min_block_size) {
+  const std::size_t v_count = g.size();
+  if (g.tips().empty()) { return {}; }
 
-    for (std::size_t e_idx: e_l) { update(e_idx, v_idx, is_vtx_explored); }
-    for (std::size_t e_idx: e_r) { update(e_idx, v_idx, is_vtx_explored); }
+  std::vector<std::size_t> tip_count(v_count, 0);
+  for (auto [_, v_idx] : g.tips()) { ++tip_count[v_idx]; }
+  const std::size_t total_tips { g.tips().size() };
 
+  auto other_end = [&](std::size_t e_idx, std::size_t v_idx) -> std::size_t {
+    const Edge& e = g.get_edge(e_idx);
+    return e.get_v1_idx() == v_idx ? e.get_v2_idx() : e.get_v1_idx();
+  };
 
-    if (is_vtx_explored) {
-      //
-      curr_vertices.insert(v.id());
-      curr_edges.insert(e_l.begin(), e_l.end());
-      curr_edges.insert(e_r.begin(), e_r.end());
+  auto side_at = [&](std::size_t e_idx, std::size_t v_idx) -> pgt::v_end {
+    const Edge& e = g.get_edge(e_idx);
+    return e.get_v1_idx() == v_idx ? e.get_v1_end() : e.get_v2_end();
+  };
+
+  // the edge is the only one at its side of v_idx
+  auto is_link = [&](std::size_t e_idx, std::size_t v_idx) -> bool {
+    return g.get_edges(v_idx, side_at(e_idx, v_idx)).size() == 1;
+  };
 
-      if (g.tips().contains({pgt::v_end::l, v_idx})) {
-        curr_tips.insert({pgt::v_end::l, v.id()});
+  // -----
+  // find the bridges with an iterative DFS over the vertices, a parallel edge
+  // is a back edge so it is never a bridge and self loops are skipped
+  // -----
+  std::vector<std::size_t> disc(v_count, pc::INVALID_IDX);
+  std::vector<std::size_t> low(v_count);
+  std::vector<std::size_t> parent_e(v_count, pc::INVALID_IDX);
+  std::vector<std::size_t> sub_tips(tip_count); // tips in the DFS subtree
+  std::vector<std::size_t> pending(v_count, 1); // size of the block still open at a vertex
+  std::vector<bool> is_cut(g.edge_count(), false);
+  std::vector<std::size_t> order; // vertices in DFS order
+  order.reserve(v_count);
+
+  struct frame {
+    std::size_t v_idx;
+    std::size_t pos; // next incident edge, those of the left side then the right
+  };
+  std::vector<frame> s;
+
+  std::size_t root = g.entry_tip().v_idx;
+  disc[root] = low[root] = 0;
+  order.push_back(root);
+  s.push_back({root, 0});
+
+  while (!s.empty()) {
+    auto& [v_idx, pos] = s.back();
+    std::span<const std::size_t> l = g.get_edges_l(v_idx);
+    std::span<const std::size_t> r = g.get_edges_r(v_idx);
+
+    if (pos < l.size() + r.size()) {
+      std::size_t e_idx = pos < l.size() ? l[pos] : r[pos - l.size()];
+      ++pos;
+      std::size_t n = other_end(e_idx, v_idx);
+
+      if (n == v_idx || e_idx == parent_e[v_idx]) { continue; }
+
+      if (disc[n] == pc::INVALID_IDX) {
+        disc[n] = low[n] = order.size();
+        parent_e[n] = e_idx;
+        order.push_back(n);
+        s.push_back({n, 0}); // invalidates v_idx and pos
       }
-      else if (g.tips().contains({pgt::v_end::r, v_idx})) {
-        curr_tips.insert({pgt::v_end::r, v.id()});
+      else {
+        low[v_idx] = std::min(low[v_idx], disc[n]);
       }
+      continue;
+    }
 
-      //
-      explored.insert(v_idx);
-      s.pop();
+    std::size_t c = v_idx;
+    s.pop_back();
+    if (s.empty()) { break; }
+
+    std::size_t p = s.back().v_idx;
+    low[p] = std::min(low[p], low[c]);
+    sub_tips[p] += sub_tips[c];
+
+    bool cut = low[c] > disc[p] && sub_tips[c] > 0 && sub_tips[c] < total_tips && pending[c] >= min_block_size &&
+               is_link(parent_e[c], p) && is_link(parent_e[c], c);
+    if (cut) { is_cut[parent_e[c]] = true; }
+    else { pending[p] += pending[c]; }
+  }
+
+  // -----
+  // number the blocks in the order the DFS enters them
+  // -----
+  std::vector<std::size_t> block_of(v_count);
+  std::vector<std::size_t> block_v_count { 1 };
+  block_of[root] = 0;
+  for (std::size_t i { 1 }; i < order.size(); ++i) {
+    std::size_t v_idx = order[i];
+    std::size_t e_idx = parent_e[v_idx];
+    if (is_cut[e_idx]) {
+      block_of[v_idx] = block_v_count.size();
+      block_v_count.push_back(0);
+    }
+    else {
+      block_of[v_idx] = block_of[other_end(e_idx, v_idx)];
     }
+    ++block_v_count[block_of[v_idx]];
+  }
 
-    if (s.empty()) {
-      povu::graph::Graph curr_vg(curr_vertices.size(), curr_edges.size());
+  const std::size_t block_count = block_v_count.size();
+  if (block_count == 1) { return {}; }
 
-      for (std::size_t v_id: curr_vertices) {
-        curr_vg.add_vertex(v_id);
-      }
+  std::vector<std::size_t> block_e_count(block_count, 0);
+  for (std::size_t e_idx {}; e_idx < g.edge_count(); ++e_idx) {
+    if (!is_cut[e_idx]) { ++block_e_count[block_of[g.get_edge(e_idx).get_v1_idx()]]; }
+  }
 
-      for (std::size_t e_id: curr_edges) {
-        const povu::graph::Edge &e = g.get_edge(e_id);
-        std::size_t v1_idx = e.get_v1_idx();
-        pgt::v_end v1_end = e.get_v1_end();
-        std::size_t v1_id = g.v_idx_to_id(v1_idx);
+  // -----
+  // copy the blocks out keeping the relative order of vertices and edges so
+  // that the DFS of a block visits them as the DFS of g would
+  // -----
+  std::vector<Graph> blocks;
+  blocks.reserve(block_count);
+  for (std::size_t b {}; b < block_count; ++b) { blocks.push_back(Graph(block_v_count[b], block_e_count[b])); }
 
-        std::size_t v2_idx = e.get_v2_idx();
-        pgt::v_end v2_end = e.get_v2_end();
-        std::size_t v2_id = g.v_idx_to_id(v2_idx);
+  for (std::size_t v_idx {}; v_idx < v_count; ++v_idx) {
+    blocks[block_of[v_idx]].add_vertex(g.v_idx_to_id(v_idx));
+  }
 
-        curr_vg.add_edge(v1_id, v1_end, v2_id, v2_end);
-      }
+  for (std::size_t e_idx {}; e_idx < g.edge_count(); ++e_idx) {
+    if (is_cut[e_idx]) { continue; }
+    const Edge& e = g.get_edge(e_idx);
+    blocks[block_of[e.get_v1_idx()]].add_edge(g.v_idx_to_id(e.get_v1_idx()), e.get_v1_end(),
+                                              g.v_idx_to_id(e.get_v2_idx()), e.get_v2_end());
+  }
+
+  for (auto [end, v_idx] : g.tips()) { blocks[block_of[v_idx]].add_tip(g.v_idx_to_id(v_idx), end); }
+
+  {
+    pgt::side_n_id_t entry = g.entry_tip();
+    blocks[0].set_entry_tip(g.v_idx_to_id(entry.v_idx), entry.v_end);
+  }
+
+  for (std::size_t i { 1 }; i < order.size(); ++i) {
+    std::size_t c = order[i];
+    std::size_t e_idx = parent_e[c];
+    if (!is_cut[e_idx]) { continue; }
 
-      for (auto [s, id] : curr_tips) {
-        curr_vg.add_tip(id, s);
+    std::size_t p = other_end(e_idx, c);
+    blocks[block_of[p]].add_tip(g.v_idx_to_id(p), side_at(e_idx, p));
+    blocks[block_of[c]].add_tip(g.v_idx_to_id(c), side_at(e_idx, c));
+    blocks[block_of[c]].set_entry_tip(g.v_idx_to_id(c), side_at(e_idx, c));
+  }
+
+  for (Graph& b : blocks) { b.freeze(); }
+
+  return blocks;
+}
+
+
+/*
+  compact_chains
+  --------------
+ */
+std::pair<Graph, chain_map> compact_chains(const Graph& g) {
+  const std::size_t v_count = g.size();
+
+  auto flip = [](pgt::v_end e) { return e == pgt::v_end::l ? pgt::v_end::r : pgt::v_end::l; };
+
+  // the vertex and side at the other end of the edge at e_idx seen from v_idx
+  auto other_side = [&](std::size_t e_idx, std::size_t v_idx, pgt::v_end end) -> pgt::side_n_id_t {
+    const Edge& e = g.get_edge(e_idx);
+    if (e.get_v1_idx() == v_idx && e.get_v1_end() == end) { return {e.get_v2_end(), e.get_v2_idx()}; }
+    return {e.get_v1_end(), e.get_v1_idx()};
+  };
+
+  // the edge if it is the only one at this side and at its other side
+  auto link_at = [&](std::size_t v_idx, pgt::v_end end) -> std::size_t {
+    std::span<const std::size_t> es = g.get_edges(v_idx, end);
+    if (es.size() != 1) { return pc::INVALID_IDX; }
+    auto [n_end, n] = other_side(es[0], v_idx, end);
+    return n != v_idx && g.get_edges(n, n_end).size() == 1 ? es[0] : pc::INVALID_IDX;
+  };
+
+  // -----
+  // find the chains
+  // -----
+  std::vector<std::size_t> chain_of(v_count, pc::INVALID_IDX);
+  std::vector<pgt::side_n_id_t> outer; // the left then the right outer side of each chain
+  std::vector<std::size_t> first_v; // smallest vertex index in each chain
+  std::vector<std::size_t> off { 0 };
+  std::vector<pgt::id_or> steps;
+  std::vector<std::size_t> members;
+
+  std::vector<bool> done(v_count, false);
+
+  for (std::size_t v_idx {}; v_idx < v_count; ++v_idx) {
+    if (done[v_idx]) { continue; }
+    if (link_at(v_idx, pgt::v_end::l) == pc::INVALID_IDX && link_at(v_idx, pgt::v_end::r) == pc::INVALID_IDX) { continue; }
+
+    // walk to an end, the walk comes back to v_idx if the chain is a cycle
+    std::size_t curr { v_idx };
+    pgt::v_end end { pgt::v_end::l };
+    bool is_cycle { false };
+    for (std::size_t e_idx; (e_idx = link_at(curr, end)) != pc::INVALID_IDX;) {
+      auto [n_end, n] = other_side(e_idx, curr, end);
+      done[n] = true;
+      if (n == v_idx) { is_cycle = true; break; }
+      curr = n;
+      end = flip(n_end);
+    }
+    if (is_cycle) { continue; }
+
+    // walk the chain from that end to the other
+    const pgt::side_n_id_t l_outer { end, curr };
+    members.clear();
+    members.push_back(curr);
+    done[curr] = true;
+    end = flip(end);
+    for (std::size_t e_idx; (e_idx = link_at(curr, end)) != pc::INVALID_IDX;) {
+      auto [n_end, n] = other_side(e_idx, curr, end);
+      members.push_back(n);
+      done[n] = true;
+      curr = n;
+      end = flip(n_end);
+    }
+    const pgt::side_n_id_t r_outer { end, curr };
+
+    // a chain whose ends are joined would become a self loop
+    bool joined { false };
+    for (pgt::side_n_id_t o : { l_outer, r_outer }) {
+      for (std::size_t e_idx : g.get_edges(o.v_idx, o.v_end)) {
+        std::size_t n = other_side(e_idx, o.v_idx, o.v_end).v_idx;
+        if (n == l_outer.v_idx || n == r_outer.v_idx) { joined = true; }
+      }
+    }
+    if (joined) { continue; }
+
+    std::size_t c = first_v.size();
+    first_v.push_back(*std::min_element(members.begin(), members.end()));
+    outer.push_back(l_outer);
+    outer.push_back(r_outer);
+
+    // a vertex is walked forward if it is entered by its left side
+    pgt::v_end in_end = l_outer.v_end;
+    for (std::size_t i {}; i < members.size(); ++i) {
+      std::size_t m = members[i];
+      chain_of[m] = c;
+      steps.push_back({g.v_idx_to_id(m), in_end == pgt::v_end::l ? pgt::or_t::forward : pgt::or_t::reverse});
+      if (i + 1 < members.size()) {
+        in_end = other_side(link_at(m, flip(in_end)), m, flip(in_end)).v_end;
       }
+    }
+    off.push_back(steps.size());
+  }
 
-     components.push_back(curr_vg);
-     curr_vertices.clear();
-     curr_edges.clear();
-     curr_tips.clear();
-     //curr_vg = povu::graph::Graph();
+  // -----
+  // build the compacted graph
+  // -----
+  const std::size_t chain_count = first_v.size();
+  chain_map chains;
 
-     for (std::size_t v_idx{}; v_idx < g.size(); ++v_idx) {
-       if (explored.find(v_idx) == explored.end()) {
-         s.push(v_idx);
-         visited.insert(v_idx);
-         break;
-       }
-     }
+  std::size_t link_count {};
+  for (std::size_t c {}; c < chain_count; ++c) { link_count += off[c + 1] - off[c] - 1; }
+
+  Graph cg(v_count - link_count, g.edge_count() - link_count);
+
+  auto rep_id = [&](std::size_t c) { return steps[off[c]].v_idx; };
+
+  for (std::size_t v_idx {}; v_idx < v_count; ++v_idx) {
+    std::size_t c = chain_of[v_idx];
+    if (c == pc::INVALID_IDX) {
+      cg.add_vertex(g.v_idx_to_id(v_idx));
+    }
+    else if (first_v[c] == v_idx) {
+      cg.add_vertex(rep_id(c));
+      chains.add(rep_id(c), std::span<const pgt::id_or>(steps.data() + off[c], off[c + 1] - off[c]));
     }
   }
 
-  return components;
+  // the id and side of a vertex side in the compacted graph
+  auto to_cg = [&](std::size_t v_idx, pgt::v_end end) -> std::pair<std::size_t, pgt::v_end> {
+    std::size_t c = chain_of[v_idx];
+    if (c == pc::INVALID_IDX) { return {g.v_idx_to_id(v_idx), end}; }
+    const pgt::side_n_id_t& l = outer[2 * c];
+    return {rep_id(c), (l.v_idx == v_idx && l.v_end == end) ? pgt::v_end::l : pgt::v_end::r};
+  };
+
+  for (std::size_t e_idx {}; e_idx < g.edge_count(); ++e_idx) {
+    const Edge& e = g.get_edge(e_idx);
+    std::size_t c = chain_of[e.get_v1_idx()];
+    // an edge inside a chain links two of its vertices
+    if (c != pc::INVALID_IDX && c == chain_of[e.get_v2_idx()] && link_at(e.get_v1_idx(), e.get_v1_end()) == e_idx) {
+      continue;
+    }
+
+    auto [v1_id, v1_end] = to_cg(e.get_v1_idx(), e.get_v1_end());
+    auto [v2_id, v2_end] = to_cg(e.get_v2_idx(), e.get_v2_end());
+    cg.add_edge(v1_id, v1_end, v2_id, v2_end);
+  }
+
+  if (!g.tips().empty()) {
+    for (auto [end, v_idx] : g.tips()) {
+      auto [id, cg_end] = to_cg(v_idx, end);
+      cg.add_tip(id, cg_end);
+    }
+
+    pgt::side_n_id_t entry = g.entry_tip();
+    auto [id, cg_end] = to_cg(entry.v_idx, entry.v_end);
+    cg.set_entry_tip(id, cg_end);
+  }
+
+  cg.freeze();
+
+  return {std::move(cg), std::move(chains)};
 }
 
 
+/*
+  is_flubble_free
+  ---------------
+ */
+bool is_flubble_free(const Graph& g) {
+  // a tree, every vertex side with no edge is a tip so every subtree has one
+  if (g.edge_count() + 1 == g.size()) { return true; }
+
+  if (g.edge_count() != g.size()) { return false; }
+
+  // a simple cycle
+  for (std::size_t v_idx {}; v_idx < g.size(); ++v_idx) {
+    if (g.get_edges_l(v_idx).size() != 1 || g.get_edges_r(v_idx).size() != 1) { return false; }
+  }
+
+  return true;
+}
+
+
+/*
+  sort_bfs
+  --------
+ */
+Graph sort_bfs(const Graph& g) {
+  const std::size_t v_count = g.size();
+  const std::size_t e_count = g.edge_count();
+
+  std::vector<std::size_t> roots;
+  if (!g.tips().empty()) { roots.push_back(g.entry_tip().v_idx); }
+  std::vector<std::size_t> order = bfs_order(g, roots);
+  std::vector<std::size_t> new_idx(v_count);
+  for (std::size_t i {}; i < v_count; ++i) { new_idx[order[i]] = i; }
+
+  // edges by the smaller new index of their ends, a stable counting sort
+  auto key = [&](std::size_t e_idx) {
+    const Edge& e = g.get_edge(e_idx);
+    return std::min(new_idx[e.get_v1_idx()], new_idx[e.get_v2_idx()]);
+  };
+
+  std::vector<std::size_t> e_off(v_count + 1, 0);
+  for (std::size_t e_idx {}; e_idx < e_count; ++e_idx) { ++e_off[key(e_idx) + 1]; }
+  for (std::size_t i { 1 }; i <= v_count; ++i) { e_off[i] += e_off[i - 1]; }
+  std::vector<std::size_t> e_order(e_count);
+  for (std::size_t e_idx {}; e_idx < e_count; ++e_idx) { e_order[e_off[key(e_idx)]++] = e_idx; }
+
+  Graph sg(v_count, e_count);
+  for (std::size_t v_idx : order) { sg.add_vertex(g.v_idx_to_id(v_idx)); }
+
+  for (std::size_t e_idx : e_order) {
+    const Edge& e = g.get_edge(e_idx);
+    sg.add_edge(g.v_idx_to_id(e.get_v1_idx()), e.get_v1_end(), g.v_idx_to_id(e.get_v2_idx()), e.get_v2_end());
+  }
+
+  if (!g.tips().empty()) {
+    for (auto [end, v_idx] : g.tips()) { sg.add_tip(g.v_idx_to_id(v_idx), end); }
+
+    pgt::side_n_id_t entry = g.entry_tip();
+    sg.set_entry_tip(g.v_idx_to_id(entry.v_idx), entry.v_end);
+  }
+
+  sg.freeze();
+
+  return sg;
+}
+
 } // namespace povu::graph
@@ -1,6 +1,11 @@
 #ifndef PV_GRAPH_HPP
 #define PV_GRAPH_HPP
+#include <algorithm>
+#include <memory>
+#include <optional>
+#include <span>
 #include <tuple>
+#include <utility>
 #include <vector>
 #include <set>
 #include <map>
@@ -12,6 +17,7 @@
 namespace povu::graph {
 namespace pgt = povu::graph_types;
 namespace pu = povu::utils;
+namespace pt = povu::types;
 
 // undirected edge
 class Edge {
@@ -31,30 +37,140 @@ public:
 };
 
 
+/**
+ * @brief build a CSR adjacency of vertex sides from a list of edges
+ *
+ * The left side of the vertex at index v is side 2v and the right side is
+ * 2v + 1. The edges of side i are adj[adj_off[i] .. adj_off[i+1]) in ascending
+ * edge index order. An edge with both ends on the same side is listed once.
+ *
+ * Works for any edge type with get_v{1,2}_idx and get_v{1,2}_end.
+ */
+template <typename E>
+void build_csr(const std::vector<E>& edges, std::size_t v_count,
+               std::vector<std::size_t>& adj_off, std::vector<std::size_t>& adj) {
+  auto side = [](std::size_t v_idx, pgt::v_end end) {
+    return 2 * v_idx + (end == pgt::v_end::l ? 0 : 1);
+  };
+
+  // count the edges incident with each side
+  adj_off.assign(2 * v_count + 1, 0);
+  for (const E& e : edges) {
+    std::size_t s1 = side(e.get_v1_idx(), e.get_v1_end());
+    std::size_t s2 = side(e.get_v2_idx(), e.get_v2_end());
+    ++adj_off[s1 + 1];
+    if (s1 != s2) { ++adj_off[s2 + 1]; }
+  }
+
+  for (std::size_t i{1}; i < adj_off.size(); ++i) { adj_off[i] += adj_off[i - 1]; }
+
+  // fill in edge order so that each side lists its edges in ascending order
+  adj.assign(adj_off.back(), 0);
+  std::vector<std::size_t> pos(adj_off.begin(), adj_off.end() - 1);
+  for (std::size_t e_idx{}; e_idx < edges.size(); ++e_idx) {
+    std::size_t s1 = side(edges[e_idx].get_v1_idx(), edges[e_idx].get_v1_end());
+    std::size_t s2 = side(edges[e_idx].get_v2_idx(), edges[e_idx].get_v2_end());
+    adj[pos[s1]++] = e_idx;
+    if (s1 != s2) { adj[pos[s2]++] = e_idx; }
+  }
+}
+
+
+/**
+ * @brief the vertex indexes of g in breadth first order
+ *
+ * A search is started from each of the roots in turn that an earlier one did
+ * not reach and then from each vertex that is still unreached, in index order.
+ * The vertices of a level are kept in index order, so an input that is already
+ * sorted keeps the relative order of e.g. the vertices of a bubble.
+ *
+ * Works for any frozen graph type with size, get_edges and get_edge whose edges
+ * have get_other_vertex.
+ */
+template <typename G>
+std::vector<std::size_t> bfs_order(const G& g, std::span<const std::size_t> roots) {
+  const std::size_t v_count = g.size();
+
+  std::vector<std::size_t> order;
+  order.reserve(v_count);
+  std::vector<bool> seen(v_count, false);
+
+  // order doubles as the queue, [begin, end) is the level being expanded
+  auto bfs = [&](std::size_t root) {
+    if (seen[root]) { return; }
+    seen[root] = true;
+    order.push_back(root);
+
+    for (std::size_t begin { order.size() - 1 }, end { order.size() }; begin < end; begin = end, end = order.size()) {
+      for (std::size_t i { begin }; i < end; ++i) {
+        for (pgt::v_end side : { pgt::v_end::l, pgt::v_end::r }) {
+          for (std::size_t e_idx : g.get_edges(order[i], side)) {
+            std::size_t n = g.get_edge(e_idx).get_other_vertex(order[i]).v_idx;
+            if (!seen[n]) { seen[n] = true; order.push_back(n); }
+          }
+        }
+      }
+      std::sort(order.begin() + end, order.end());
+    }
+  };
+
+  for (std::size_t root : roots) { bfs(root); }
+  for (std::size_t v_idx {}; v_idx < v_count; ++v_idx) { bfs(v_idx); }
+
+  return order;
+}
+
+
 class Vertex {
   std::size_t v_id;
-  std::set<std::size_t> e_l;
-  std::set<std::size_t> e_r;
 
 public:
   Vertex(std::size_t v_id);
   std::size_t id() const;
-  void add_edge_l(std::size_t e_id);
-  void add_edge_r(std::size_t e_id);
-  const std::set<std::size_t>& get_edges_l() const;
-  const std::set<std::size_t>& get_edges_r() const;
 };
 
-class Graph {
+/**
+ * the vertices, edges and CSR adjacency behind a Graph
+ *
+ * shared by a graph and the component views componetize splits off it
+ */
+struct graph_store {
   std::vector<Vertex> vertices;
   std::vector<Edge> edges;
-  pu::TwoWayMap<std::size_t, std::size_t> v_id_to_idx_; // TODO: reserve size
+  pt::IdMap v_id_to_idx;
+
+  std::vector<std::size_t> adj_off;
+  std::vector<std::size_t> adj;
+  bool frozen { false };
+};
+
+/**
+ * The incident edges of each vertex side are held in a CSR layout (see
+ * build_csr) which is built by freeze() once all edges have been added.
+ *
+ * A graph is a window [v_begin, v_end) of vertices and [e_begin, e_end) of
+ * edges over a graph_store. A loaded graph spans the whole store, a component
+ * spans the part of it that componetize moved the component into. Copies share
+ * the store.
+ */
+class Graph {
+  std::shared_ptr<graph_store> s_;
+  std::size_t v_begin_ { 0 };
+  std::size_t v_end_ { 0 };
+  std::size_t e_begin_ { 0 };
+  std::size_t e_end_ { 0 };
   std::set<pgt::side_n_id_t> tips_;
+  std::optional<pgt::side_n_id_t> entry_tip_; // see entry_tip
+
+  friend std::vector<Graph> componetize(Graph&& g, const core::config& app_config, std::size_t min_chunk);
 
 public:
   // constructors
   Graph();
   Graph(std::size_t v_count, std::size_t e_count);
+  // a view over part of a store, edges in it use indexes local to the view
+  Graph(std::shared_ptr<graph_store> s, std::size_t v_begin, std::size_t v_end,
+        std::size_t e_begin, std::size_t e_end, std::set<pgt::side_n_id_t>&& tips);
 
   // getters
 
@@ -64,20 +180,139 @@ public:
   std::size_t size() const; // number of vertices
   std::size_t edge_count() const;
   const std::set<pgt::side_n_id_t>& tips() const;
+  // the tip a DFS from the dummy vertex enters the graph by, the first tip
+  // unless one was set. There must be at least one tip.
+  pgt::side_n_id_t entry_tip() const;
   const Edge& get_edge(std::size_t e_idx) const;
   const Vertex& get_vertex_by_idx(std::size_t v_id) const;
   const Vertex& get_vertex_by_id(std::size_t v_idx) const;
 
+  // incident edges of a vertex side, the graph must be frozen
+  std::span<const std::size_t> get_edges_l(std::size_t v_idx) const;
+  std::span<const std::size_t> get_edges_r(std::size_t v_idx) const;
+  std::span<const std::size_t> get_edges(std::size_t v_idx, pgt::v_end end) const;
+
   // setters
   void add_tip(std::size_t v_id, pgt::v_end end);
+  void set_entry_tip(std::size_t v_id, pgt::v_end end);
   void add_vertex(std::size_t v_id);
+  /**
+   * @throws std::invalid_argument if either id is not that of a vertex
+   */
   void add_edge(std::size_t v1_id, pgt::v_end v1_end, std::size_t v2_id, pgt::v_end v2_end);
 
+  /**
+   * @brief build the CSR adjacency from the edges added so far
+   */
+  void freeze();
+
+  /**
+   * @brief adopt a CSR adjacency that was built elsewhere e.g. read from an index
+   */
+  void freeze(std::vector<std::size_t>&& adj_off, std::vector<std::size_t>&& adj);
+
   // other
   void summary() const;
 };
 
-std::vector<povu::graph::Graph> componetize(const povu::graph::Graph& g, const core::config& app_config);
+/**
+ * the chains of vertices that the vertices of a compacted graph stand for
+ *
+ * a chain is held as the ids of its vertices in the order they are walked from
+ * the left side of its vertex to the right side, each with the orientation it
+ * is walked in
+ */
+class chain_map {
+  pt::IdMap rep_to_chain_; // id of the vertex standing for a chain -> chain
+  std::vector<std::size_t> off_ { 0 };
+  std::vector<pgt::id_or> steps_;
+
+public:
+  chain_map() = default;
+
+  std::size_t size() const; // number of chains
+  bool empty() const;
+
+  // the chain of the vertex with the id v_id, empty if it is not a chain
+  std::span<const pgt::id_or> get(std::size_t v_id) const;
+
+  void add(std::size_t v_id, std::span<const pgt::id_or> steps);
+};
+
+/**
+ * @brief split a graph into its connected components
+ *
+ * Components are found with a concurrent union-find over the edges. The store
+ * of g is then reordered so that each component is a contiguous range of
+ * vertices and edges, and the components are returned as views over it.
+ * Components are ordered by their smallest vertex index in g, vertices within a
+ * component by id and edges by their index in g.
+ *
+ * The edges and vertices are split across --threads in chunks of at least
+ * min_chunk, a graph with fewer than two chunks of them is done serially. The
+ * components do not depend on the number of threads.
+ */
+const std::size_t COMPONETIZE_MIN_CHUNK { 1 << 16 };
+std::vector<Graph> componetize(Graph&& g, const core::config& app_config,
+                               std::size_t min_chunk = COMPONETIZE_MIN_CHUNK);
+
+/**
+ * @brief split a component at bridges into blocks that can be deconstructed on
+ * their own
+ *
+ * Bridges are found with an iterative DFS from the vertex of the entry tip. A
+ * bridge is only cut if there is a tip on either side of it and it is the only
+ * edge at both of its vertex sides. The dummy vertex then closes every cycle
+ * through the bridge, so the ends of the bridge become tips of their blocks
+ * without changing the cycle equivalence classes, and the two ends are next to
+ * each other in the class of the bridge, so no flubble crosses it. The flubble
+ * tree of the component is then the flubble trees of its blocks under one
+ * root. A block is entered by its end of the bridge the way the DFS of the
+ * whole component enters it.
+ *
+ * 2-edge-connected blocks are merged along the bridges until they have at
+ * least min_block_size vertices, except the block of the entry tip, so that a
+ * chain of small bubbles is not cut into as many jobs.
+ *
+ * Blocks are ordered as the DFS of the component enters them. Returns an empty
+ * vector if nothing was cut.
+ */
+std::vector<Graph> split_at_bridges(const Graph& g, std::size_t min_block_size);
+
+/**
+ * @brief collapse each maximal chain of vertices joined by edges that are the
+ * only edge at both of their sides into one vertex
+ *
+ * Every cycle through a vertex of such a chain goes through all of it, so the
+ * vertex that stands for it is in the same cycle equivalence class and the
+ * chain can be put back into the eq class stack in its place (see chain_map).
+ * The vertex takes the id of the first vertex of the chain and its sides are
+ * the outer sides of the ends. A chain that is a cycle or whose ends are joined
+ * by an edge is left as it is.
+ *
+ * Vertices, edges and tips keep their relative order, a chain sits at the
+ * position of its smallest vertex.
+ */
+std::pair<Graph, chain_map> compact_chains(const Graph& g);
+
+/**
+ * @brief true if the component g can not contain a flubble, i.e. it is a tree
+ * (no cycle in the biedged graph other than through the dummy vertex) or a
+ * single simple cycle. O(V)
+ *
+ * Its flubble tree is the root alone so it need not be deconstructed.
+ */
+bool is_flubble_free(const Graph& g);
+
+/**
+ * @brief a copy of g with its vertices in bfs_order from its entry tip and its
+ * edges ordered by the position of their first end
+ *
+ * In an unsorted input the neighbours of a vertex can be anywhere in the
+ * store. In this order the DFS of the biedged graph mostly touches vertices
+ * and edges that are close together. Ids, tips and the entry tip are kept.
+ */
+Graph sort_bfs(const Graph& g);
 
 } // namespace povu::graph
 #endif
@@ -0,0 +1,194 @@
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <limits>
+
+#include "./seq_store.hpp"
+
+namespace povu::seq_store {
+
+namespace {
+constexpr char BASES[] { 'A', 'C', 'G', 'T' };
+constexpr char LOWER[] { 'a', 'c', 'g', 't' };
+
+// the longest run a run can hold, longer runs are split
+constexpr std::size_t MAX_RUN { std::numeric_limits<std::uint32_t>::max() };
+
+// 2 bit code of a base in either case, -1 if it has to be stored as an exception
+constexpr std::array<std::int8_t, 256> make_codes() {
+  std::array<std::int8_t, 256> t {};
+  for (auto& c : t) { c = -1; }
+  t['A'] = 0; t['C'] = 1; t['G'] = 2; t['T'] = 3;
+  t['a'] = 0; t['c'] = 1; t['g'] = 2; t['t'] = 3;
+  return t;
+}
+
+// the 4 bases packed in a byte, in order and as a reverse complement
+constexpr std::array<std::array<char, 4>, 256> make_lut(bool rc) {
+  std::array<std::array<char, 4>, 256> t {};
+  for (std::size_t b {}; b < 256; ++b) {
+    for (std::size_t k {}; k < 4; ++k) {
+      std::size_t code = (b >> (k * 2)) & 3;
+      if (rc) { t[b][3 - k] = BASES[3 - code]; }
+      else { t[b][k] = BASES[code]; }
+    }
+  }
+  return t;
+}
+
+constexpr std::array<std::int8_t, 256> CODES = make_codes();
+constexpr std::array<std::array<char, 4>, 256> FWD = make_lut(false);
+constexpr std::array<std::array<char, 4>, 256> RC = make_lut(true);
+} // namespace
+
+
+/*
+ * SeqStore
+ * --------
+ */
+
+// getters
+// -------
+std::size_t SeqStore::size() const { return this->len_; }
+
+std::size_t SeqStore::exception_count() const { return this->exceptions_.size(); }
+
+std::size_t SeqStore::lower_run_count() const { return this->lower_.size(); }
+
+std::size_t SeqStore::byte_size() const {
+  return this->packed_.capacity() + this->lower_.capacity() * sizeof(lower_run)
+    + this->exceptions_.capacity() * sizeof(exception_run);
+}
+
+template <typename R>
+std::size_t SeqStore::first_run_after(const std::vector<R>& runs, std::size_t pos) {
+  auto it = std::partition_point(runs.begin(), runs.end(), [pos](const R& r) { return r.pos + r.len <= pos; });
+  return it - runs.begin();
+}
+
+char SeqStore::at(std::size_t pos, bool rc) const {
+  std::size_t r = first_run_after(this->exceptions_, pos);
+  if (r < this->exceptions_.size() && this->exceptions_[r].pos <= pos) { return this->exceptions_[r].c; }
+  std::uint8_t c = this->code(pos);
+  std::size_t l = first_run_after(this->lower_, pos);
+  if (l < this->lower_.size() && this->lower_[l].pos <= pos) { return LOWER[c]; }
+  return BASES[rc ? 3 - c : c];
+}
+
+SeqView SeqStore::view(std::size_t off, std::size_t len, bool rc) const {
+  return SeqView(this, off, len, rc);
+}
+
+char* SeqStore::decode(std::size_t off, std::size_t len, bool rc, char* out) const {
+  const std::size_t end = off + len;
+  std::size_t p = off;
+
+  // out index of the base at position q
+  auto out_idx = [&](std::size_t q) { return rc ? end - 1 - q : q - off; };
+
+  // unaligned head, then whole bytes, then the tail
+  for (; p < end && (p & 3); ++p) { out[out_idx(p)] = BASES[rc ? 3 - this->code(p) : this->code(p)]; }
+
+  if (!rc) {
+    for (; p + 4 <= end; p += 4) { std::memcpy(out + (p - off), FWD[this->packed_[p >> 2]].data(), 4); }
+  }
+  else {
+    for (; p + 4 <= end; p += 4) { std::memcpy(out + (end - 4 - p), RC[this->packed_[p >> 2]].data(), 4); }
+  }
+
+  for (; p < end; ++p) { out[out_idx(p)] = BASES[rc ? 3 - this->code(p) : this->code(p)]; }
+
+  // lower the soft-masked bases, they are not complemented
+  for (std::size_t r { first_run_after(this->lower_, off) };
+       r < this->lower_.size() && this->lower_[r].pos < end; ++r) {
+    const lower_run& run = this->lower_[r];
+    std::size_t q_end = std::min(end, run.pos + run.len);
+    for (std::size_t q { std::max(off, run.pos) }; q < q_end; ++q) { out[out_idx(q)] = LOWER[this->code(q)]; }
+  }
+
+  // patch in the exceptions
+  for (std::size_t r { first_run_after(this->exceptions_, off) };
+       r < this->exceptions_.size() && this->exceptions_[r].pos < end; ++r) {
+    const exception_run& run = this->exceptions_[r];
+    std::size_t q_end = std::min(end, run.pos + run.len);
+    for (std::size_t q { std::max(off, run.pos) }; q < q_end; ++q) { out[out_idx(q)] = run.c; }
+  }
+
+  return out + len;
+}
+
+void SeqStore::append_to(std::size_t off, std::size_t len, bool rc, std::string& out) const {
+  std::size_t n = out.size();
+  out.resize(n + len);
+  this->decode(off, len, rc, out.data() + n);
+}
+
+// setters & modifiers
+// -------------------
+void SeqStore::reserve(std::size_t bases) { this->packed_.reserve((bases + 3) / 4); }
+
+template <typename R>
+bool SeqStore::extend_run(std::vector<R>& runs, std::size_t pos) {
+  if (runs.empty()) { return false; }
+  R& last = runs.back();
+  if (last.pos + last.len != pos || last.len == MAX_RUN) { return false; }
+  ++last.len;
+  return true;
+}
+
+std::size_t SeqStore::append(std::string_view seq) {
+  std::size_t off = this->len_;
+
+  this->packed_.resize((this->len_ + seq.size() + 3) / 4, 0);
+
+  for (char ch : seq) {
+    std::size_t pos = this->len_++;
+    std::int8_t c = CODES[static_cast<unsigned char>(ch)];
+
+    if (c >= 0) {
+      this->packed_[pos >> 2] |= static_cast<std::uint8_t>(c << ((pos & 3) * 2));
+      if (ch >= 'a' && !extend_run(this->lower_, pos)) { this->lower_.push_back(lower_run{pos, 1}); }
+      continue;
+    }
+
+    if (!this->exceptions_.empty() && this->exceptions_.back().c == ch && extend_run(this->exceptions_, pos)) {
+      continue;
+    }
+    this->exceptions_.push_back(exception_run{pos, 1, ch});
+  }
+
+  return off;
+}
+
+
+/*
+ * SeqView
+ * -------
+ */
+SeqView::iterator SeqView::begin() const {
+  if (this->len_ == 0) { return this->end(); }
+
+  if (!this->rc_) {
+    return iterator(this->s_, this->off_, 0, SeqStore::first_run_after(this->s_->exceptions_, this->off_),
+                    SeqStore::first_run_after(this->s_->lower_, this->off_), false);
+  }
+
+  std::size_t last = this->off_ + this->len_ - 1;
+  // the number of runs that start at or before last
+  auto starts_by = [last]<typename R>(const std::vector<R>& runs) {
+    return std::partition_point(runs.begin(), runs.end(), [last](const R& r) { return r.pos <= last; }) - runs.begin();
+  };
+  return iterator(this->s_, last, 0, starts_by(this->s_->exceptions_), starts_by(this->s_->lower_), true);
+}
+
+char SeqView::back() const {
+  return this->rc_ ? this->s_->at(this->off_, true) : this->s_->at(this->off_ + this->len_ - 1, false);
+}
+
+std::string SeqView::to_string() const {
+  std::string s(this->len_, '\0');
+  this->decode(s.data());
+  return s;
+}
+
+} // namespace povu::seq_store
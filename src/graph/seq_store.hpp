@@ -0,0 +1,210 @@
+#ifndef SEQ_STORE_HPP
+#define SEQ_STORE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+namespace povu::seq_store {
+class SeqView;
+
+/*
+ * SeqStore
+ * --------
+ * graph-wide arena for vertex labels
+ *
+ * A, C, G and T are packed at 2 bits per base, 4 bases per byte, regardless of
+ * case. Lower case (soft-masked) bases are kept in a sorted list of runs that
+ * mark which positions to lower on decode. Any other byte (N, IUPAC codes) is
+ * kept in a sorted list of runs of identical bytes keyed by position which
+ * overrides the packed bits and the case. Like povu::utils::complement, the
+ * complement of an exception or of a lower case base is itself.
+ *
+ * A run longer than a uint32_t can count is split in two.
+ *
+ * The store is append only, a label is addressed by its offset and length.
+ */
+class SeqStore {
+  /** a run of lower case letters */
+  struct lower_run {
+    std::size_t pos;
+    std::uint32_t len;
+  };
+
+  /** a run of identical bytes that are not one of ACGT in either case */
+  struct exception_run {
+    std::size_t pos;
+    std::uint32_t len;
+    char c;
+  };
+
+  std::vector<std::uint8_t> packed_;
+  std::vector<lower_run> lower_;
+  std::vector<exception_run> exceptions_;
+  std::size_t len_ { 0 };
+
+  friend class SeqView;
+
+  std::uint8_t code(std::size_t pos) const { return (this->packed_[pos >> 2] >> ((pos & 3) * 2)) & 3; }
+
+  // index of the first run which ends after pos
+  template <typename R>
+  static std::size_t first_run_after(const std::vector<R>& runs, std::size_t pos);
+
+  // the base at pos, complemented if rc
+  char at(std::size_t pos, bool rc) const;
+
+  // extend the last run by one if it ends at pos, else start a new one
+  template <typename R>
+  static bool extend_run(std::vector<R>& runs, std::size_t pos);
+
+public:
+  // --------------
+  // constructor(s)
+  // --------------
+  SeqStore() = default;
+
+  // ---------
+  // getter(s)
+  // ---------
+  // total number of bases held
+  std::size_t size() const;
+  std::size_t exception_count() const;
+  std::size_t lower_run_count() const;
+  // bytes used by the packed bases and the runs
+  std::size_t byte_size() const;
+
+  /**
+   * @brief a non-allocating view of the bases in [off, off + len)
+   *
+   * @param rc if true the view yields the reverse complement
+   */
+  SeqView view(std::size_t off, std::size_t len, bool rc = false) const;
+
+  /**
+   * @brief decode the bases in [off, off + len) into a caller provided buffer
+   *
+   * @param out must have room for len chars
+   * @return one past the last char written
+   */
+  char* decode(std::size_t off, std::size_t len, bool rc, char* out) const;
+
+  // decode and append to out
+  void append_to(std::size_t off, std::size_t len, bool rc, std::string& out) const;
+
+  // ---------------------
+  // setter(s) & modifiers
+  // ---------------------
+  void reserve(std::size_t bases);
+
+  /**
+   * @brief append a sequence to the store
+   *
+   * @return the offset of the sequence in the store
+   */
+  std::size_t append(std::string_view seq);
+};
+
+
+/*
+ * SeqView
+ * -------
+ * a label or its reverse complement as a range of chars, nothing is decoded
+ * until dereferenced
+ */
+class SeqView {
+  const SeqStore* s_ { nullptr };
+  std::size_t off_ { 0 };
+  std::size_t len_ { 0 };
+  bool rc_ { false };
+
+public:
+  class iterator {
+    const SeqStore* s_ { nullptr };
+    std::size_t pos_ { 0 };  // position in the store, moves backwards when rc
+    std::size_t i_ { 0 };    // position in the view
+    std::size_t run_ { 0 };  // exception run cursor
+    std::size_t lrun_ { 0 }; // lower case run cursor
+    bool rc_ { false };
+
+    // whether the run cursor r of runs is on a run that holds pos_
+    template <typename R>
+    bool in_run(const std::vector<R>& runs, std::size_t r) const {
+      if (!this->rc_) { return r < runs.size() && runs[r].pos <= this->pos_; }
+      // when rc the cursor counts the runs that start at or before pos_
+      return r > 0 && runs[r - 1].pos + runs[r - 1].len > this->pos_;
+    }
+
+    template <typename R>
+    void advance(const std::vector<R>& runs, std::size_t& r) const {
+      if (!this->rc_) { if (r < runs.size() && runs[r].pos + runs[r].len <= this->pos_) { ++r; } }
+      else if (r > 0 && runs[r - 1].pos > this->pos_) { --r; }
+    }
+
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = char;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = char;
+
+    iterator() = default;
+    iterator(const SeqStore* s, std::size_t pos, std::size_t i, std::size_t run, std::size_t lrun, bool rc)
+      : s_{s}, pos_{pos}, i_{i}, run_{run}, lrun_{lrun}, rc_{rc} {}
+
+    char operator*() const {
+      static constexpr char BASES[] { 'A', 'C', 'G', 'T' };
+      static constexpr char LOWER[] { 'a', 'c', 'g', 't' };
+      const std::vector<SeqStore::exception_run>& ex = this->s_->exceptions_;
+
+      if (this->in_run(ex, this->run_)) { return ex[this->rc_ ? this->run_ - 1 : this->run_].c; }
+      if (this->in_run(this->s_->lower_, this->lrun_)) { return LOWER[this->s_->code(this->pos_)]; }
+      return BASES[this->rc_ ? 3 - this->s_->code(this->pos_) : this->s_->code(this->pos_)];
+    }
+
+    iterator& operator++() {
+      ++this->i_;
+      if (!this->rc_) { ++this->pos_; } else { --this->pos_; }
+      this->advance(this->s_->exceptions_, this->run_);
+      this->advance(this->s_->lower_, this->lrun_);
+      return *this;
+    }
+
+    iterator operator++(int) { iterator tmp = *this; ++*this; return tmp; }
+
+    bool operator==(const iterator& other) const { return this->i_ == other.i_; }
+    bool operator!=(const iterator& other) const { return this->i_ != other.i_; }
+  };
+
+  // --------------
+  // constructor(s)
+  // --------------
+  SeqView() = default;
+  SeqView(const SeqStore* s, std::size_t off, std::size_t len, bool rc)
+    : s_{s}, off_{off}, len_{len}, rc_{rc} {}
+
+  // ---------
+  // getter(s)
+  // ---------
+  std::size_t size() const { return this->len_; }
+  bool empty() const { return this->len_ == 0; }
+  bool is_rc() const { return this->rc_; }
+
+  iterator begin() const;
+  iterator end() const { return iterator(this->s_, 0, this->len_, 0, 0, this->rc_); }
+
+  char front() const { return *this->begin(); }
+  char back() const;
+
+  // decode the whole view into a caller provided buffer of at least size() chars
+  char* decode(char* out) const { return this->s_->decode(this->off_, this->len_, this->rc_, out); }
+  std::string to_string() const;
+};
+
+} // namespace povu::seq_store
+
+#endif
@@ -1,15 +1,9 @@
-#include <cmath>
+#include <cassert>
 #include <cstddef>
 #include <format>
 #include <iostream>
 #include <limits>
-#include <map>
-#include <set>
-#include <stdexcept>
 #include <string>
-#include <sys/types.h>
-#include <unistd.h>
-#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -28,10 +22,10 @@ using namespace povu::graph_types;
  * ----
  */
 // constructor(s)
-Edge::Edge(): null_(true) {}
+Edge::Edge(): id_(INVALID_ID), src(INVALID_IDX), tgt(INVALID_IDX), class_(INVALID_ID), color_(color::black) {}
 
 Edge::Edge(std::size_t id, std::size_t src, std::size_t tgt, color c):
-  id_(id), src(src), tgt(tgt), null_(false), color_(c) {}
+  id_(id), src(src), tgt(tgt), color_(c) {}
 
 // getters
 std::size_t Edge::id() const { return this->id_; }
@@ -55,8 +49,7 @@ void Edge::set_class(std::size_t c) { this->class_ = c; }
  */
 
 BackEdge::BackEdge(std::size_t id,  std::size_t src,  std::size_t tgt, EdgeType t, pgt::color c)
-  : id_(id), src(src), tgt(tgt), class_(INVALID_ID), recent_class_(INVALID_ID),
-    recent_size_(INVALID_ID), type_(t), null_(false), color_(c) {}
+  : id_(id), src(src), tgt(tgt), class_(INVALID_ID), type_(t), color_(c) {}
 
 std::size_t BackEdge::id() const { return this->id_; }
 std::size_t BackEdge::get_src() const { return this->src; }
@@ -79,36 +72,21 @@ EdgeType BackEdge::type() const { return this->type_; }
  */
 // Constructor(s)
 
-Vertex::Vertex(std::size_t dfs_num, const std::string &name, VertexType type_)
-  : dfs_num_(dfs_num), parent_id(INVALID_ID), name_(name), type_(type_),
-    hi_(std::numeric_limits<size_t>::max()), null_(false){}
+Vertex::Vertex(std::size_t dfs_num, VertexType type_)
+  : dfs_num_(dfs_num), parent_id(INVALID_ID), hi_(std::numeric_limits<size_t>::max()), type_(type_) {}
 
 
 // getters
-std::string const& Vertex::name() const { return this->name_; }
 VertexType Vertex::type() const { return this->type_; }
 std::size_t  Vertex::hi() const { return this->hi_; }
 std::size_t  Vertex::dfs_num() const { return this->dfs_num_; }
-bool Vertex::is_leaf() const { return this->children.empty(); }
 std::size_t  Vertex::parent() const { return this->parent_id; }
-std::set<size_t> const &Vertex::get_ibe() const { return this->ibe; }
-std::set<size_t> const &Vertex::get_obe() const { return this->obe; }
 size_t const& Vertex::get_parent_idx() const { return this->parent_id; }
 size_t Vertex::get_parent_e_idx() const { return this->parent_id; }
-std::set<size_t> const& Vertex::get_children() const { return this->children; }
-bool Vertex::is_root() const {
-  return !this->null_ && this->parent_id == INVALID_IDX;
-}
-
-bool Vertex::is_null() const { return this->null_; }
+bool Vertex::is_root() const { return this->parent_id == INVALID_IDX; }
 
 // setters
-void Vertex::unset_null(){ this->null_ = false;}
-void Vertex::add_obe(std::size_t obe_id) { this->obe.insert(obe_id); }
-void Vertex::add_ibe(std::size_t ibe_id) { this->ibe.insert(ibe_id); }
-void Vertex::add_child(std::size_t e_id) { this->children.insert(e_id); }
 void Vertex::set_parent(std::size_t n_id) { this->parent_id = n_id; }
-void Vertex::set_name(std::string const& name) { this->name_ = name; }
 void Vertex::set_type(VertexType t) { this->type_ = t; }
 void Vertex::set_hi(std::size_t val) { this->hi_ = val; }
 void Vertex::set_dfs_num(std::size_t idx) { this->dfs_num_ = idx; }
@@ -120,46 +98,21 @@ void Vertex::set_dfs_num(std::size_t idx) { this->dfs_num_ = idx; }
 
 // Constructor(s)
 
-Tree::Tree(std::size_t size) :
-  nodes(std::vector<Vertex>{}),
-  tree_edges(std::vector<Edge>{}),
-  back_edges(std::vector<BackEdge>{}),
-  //bracket_lists(std::vector<BracketList*>{}),
-  sort_(std::vector<std::size_t>{}),
-  sort_g(std::vector<std::size_t>{}),
-  equiv_class_count_(0) {
+Tree::Tree(std::size_t size, std::pmr::memory_resource* mr)
+  : nodes(mr), ids_(mr), tree_edges(mr), back_edges(mr),
+    child_off_(mr), children_(mr), obe_off_(mr), obe_(mr), ibe_off_(mr), ibe_(mr),
+    added_ibe_head_(mr), added_ibe_tail_(mr), added_ibe_next_(mr),
+    bracket_lists(size, mr), brackets(mr),
+    edge_id_map_(mr), te_g_idx_(mr), be_g_idx_(mr),
+    equiv_class_count_(0) {
   this->nodes.reserve(size);
+  this->ids_.reserve(size);
   this->tree_edges.reserve(size);
+  this->te_g_idx_.reserve(size);
   this->back_edges.reserve(size);
-  // this->bracket_lists.reserve(size);
-  // TODO: is this necessary?
-  this->bracket_lists = std::vector<WBracketList*>(size, nullptr);
-}
-
-Tree::~Tree(){
-  this->nodes.clear();
-  this->tree_edges.clear();
-  this->back_edges.clear();
-  for (std::size_t i = 0; i < this->bracket_lists.size(); ++i) {
-    if (this->bracket_lists.at(i) != nullptr) {
-      delete this->bracket_lists[i];
-    }
-    //else {
-    //  std::cout << "Bracket list " << i << " is null" << std::endl;
-    //}
-  }
-  this->bracket_lists.clear();
-
-  this->sort_.clear();
-  this->sort_g.clear();
-}
-
-void Tree::set_sort(std::size_t idx, std::size_t vertex) {
-  this->sort_.at(idx) = vertex;
-}
-
-void Tree::set_sort_g(std::size_t idx, std::size_t vertex) {
-  this->sort_g.at(idx) = vertex;
+  this->be_g_idx_.reserve(size);
+  this->edge_id_map_.reserve(2 * size);
+  this->brackets.reserve(size);
 }
 
 void Tree::set_dfs_num(std::size_t vertex, std::size_t dfs_num) {
@@ -170,8 +123,9 @@ void Tree::set_vertex_type(std::size_t vertex, VertexType type) {
   this->nodes.at(vertex).set_type(type);
 }
 
-void Tree::add_vertex(Vertex&& v) {
+void Tree::add_vertex(Vertex&& v, std::size_t v_id) {
   this->nodes.push_back(v);
+  this->ids_.push_back(v_id);
 }
 
 Vertex& Tree::get_root()  { return this->nodes.at(this->get_root_idx()); }
@@ -181,6 +135,7 @@ std::size_t Tree::get_root_idx() const { return this->root_node_index; }
 std::size_t Tree::size() const { return this->nodes.size(); }
 std::size_t Tree::tree_edge_count() const { return this->tree_edges.size(); }
 std::size_t Tree::back_edge_count() const { return this->back_edges.size(); }
+std::pmr::memory_resource* Tree::resource() const { return this->nodes.get_allocator().resource(); }
 
 Vertex const &Tree::get_vertex(std::size_t vertex) const {
   return this->nodes.at(vertex);
@@ -196,111 +151,51 @@ Vertex const& Tree::get_p_vtx(std::size_t v_idx) const {
   return this->get_vertex(p_idx);
 }
 
-
-std::size_t Tree::list_size(std::size_t vertex) {
-  return this->bracket_lists.at(vertex)->size();
+std::size_t Tree::get_vertex_id(std::size_t vertex) const {
+  return this->ids_.at(vertex);
 }
 
-std::size_t Tree::get_hi(std::size_t vertex) {
-  return this->nodes.at(vertex).hi();
+std::string Tree::get_vertex_name(std::size_t vertex) const {
+  return vertex_name(this->ids_.at(vertex));
 }
 
-std::set<std::pair<std::size_t, std::size_t>>
-Tree::get_children_w_id(std::size_t vertex) {
-  std::set<std::pair<std::size_t, std::size_t>> res{};
-  for (auto e_idx : this->nodes.at(vertex).get_children()) {
-    res.insert(
-      std::make_pair(
-        this->tree_edges.at(e_idx).id(),
-        this->tree_edges.at(e_idx).get_child()
-      )
-   );
-  }
-  return res;
-}
-
-std::vector<Edge> Tree::get_child_edges(std::size_t vertex) {
-  std::vector<Edge> v{};
 
-  for (auto e_idx : this->nodes.at(vertex).get_children()) {
-    v.push_back(this->tree_edges.at(e_idx));
-  }
-
-  return v;
+std::size_t Tree::list_size(std::size_t vertex) {
+  return this->bracket_lists.at(vertex).size;
 }
 
-Edge const& Tree::get_parent_edge(std::size_t vertex) const {
-  return this->tree_edges.at(this->nodes.at(vertex).get_parent_idx());
+std::size_t Tree::get_hi(std::size_t vertex) {
+  return this->nodes.at(vertex).hi();
 }
 
-std::set<std::size_t> Tree::get_obe_idxs(std::size_t vertex) {
-  std::set<std::size_t> v {};
-
-  for (auto be_idx : this->nodes.at(vertex).get_obe()) {
-    v.insert(be_idx);
-  }
-
-  return v;
+std::span<const std::size_t> Tree::get_children(std::size_t vertex) const {
+  assert(this->frozen_);
+  const std::size_t* b = this->children_.data() + this->child_off_[vertex];
+  return std::span<const std::size_t>(b, this->child_off_[vertex + 1] - this->child_off_[vertex]);
 }
 
-std::set<std::size_t> Tree::get_ibe_idxs(std::size_t vertex) {
-  std::set<std::size_t> v{};
-
-  for (auto be_idx : this->nodes.at(vertex).get_ibe()) {
-    v.insert(be_idx);
-  }
-
-  return v;
+std::span<const std::size_t> Tree::get_obe_idxs(std::size_t vertex) const {
+  assert(this->frozen_);
+  const std::size_t* b = this->obe_.data() + this->obe_off_[vertex];
+  return std::span<const std::size_t>(b, this->obe_off_[vertex + 1] - this->obe_off_[vertex]);
 }
 
-std::set<std::pair<std::size_t, std::size_t>>
-Tree::get_obe_w_id(std::size_t vertex) {
-  std::set<std::pair<std::size_t, std::size_t>> res{};
-  for (auto e_idx : this->nodes.at(vertex).get_obe()) {
-    res.insert(
-      std::make_pair(
-        this->back_edges.at(e_idx).id(),
-        this->back_edges.at(e_idx).get_tgt())
-    );
-  }
-  return res;
-}
-
-std::set<std::pair<std::size_t, std::size_t>>
-Tree::get_ibe_w_id(std::size_t vertex) {
-  std::set<std::pair<std::size_t, std::size_t>> res{};
-  for (auto e_idx : this->nodes.at(vertex).get_ibe()) {
-    res.insert(
-      std::make_pair(
-        this->back_edges.at(e_idx).id(),
-        this->back_edges.at(e_idx).get_src())
-    );
-  }
-  return res;
+std::span<const std::size_t> Tree::get_ibe_idxs(std::size_t vertex) const {
+  assert(this->frozen_);
+  const std::size_t* b = this->ibe_.data() + this->ibe_off_[vertex];
+  return std::span<const std::size_t>(b, this->ibe_off_[vertex + 1] - this->ibe_off_[vertex]);
 }
 
-std::set<std::size_t> Tree::get_children(std::size_t vertex) {
-  std::set<std::size_t> res {};
-  for (auto e_idx : this->nodes.at(vertex).get_children()) {
-    res.insert(this->tree_edges.at(e_idx).get_child());
-  }
-  return res;
+std::size_t Tree::first_added_ibe(std::size_t vertex) const {
+  return this->added_ibe_head_[vertex];
 }
 
-std::set<std::size_t> Tree::get_ibe(std::size_t vertex) {
-  std::set<std::size_t> res {};
-  for (auto e_idx : this->nodes.at(vertex).get_ibe()) {
-    res.insert(this->back_edges.at(e_idx).get_src());
-  }
-  return res;
+std::size_t Tree::next_added_ibe(std::size_t backedge_idx) const {
+  return this->added_ibe_next_[backedge_idx - this->frozen_be_count_];
 }
 
-std::set<std::size_t> Tree::get_obe(std::size_t vertex) {
-  std::set<std::size_t> res{};
-  for (auto e_idx : this->nodes.at(vertex).get_obe()) {
-    res.insert(this->back_edges.at(e_idx).get_tgt());
-  }
-  return res;
+Edge const& Tree::get_parent_edge(std::size_t vertex) const {
+  return this->tree_edges.at(this->nodes.at(vertex).get_parent_idx());
 }
 
 bool Tree::is_root(std::size_t vertex) const {
@@ -308,19 +203,7 @@ bool Tree::is_root(std::size_t vertex) const {
 }
 
 bool Tree::is_leaf(std::size_t vertex) const {
-  return this->get_vertex(vertex).is_leaf();
-}
-
-bool Tree::has_child(std::size_t vertex, std::size_t child_idx)  {
-  return this->get_children(vertex).count(child_idx);
-}
-
-bool Tree::has_ibe(std::size_t vertex, std::size_t qry_idx)  {
-  return this->get_ibe(vertex).count(qry_idx);
-}
-
-bool Tree::has_obe(std::size_t vertex, std::size_t qry_idx)  {
-  return this->get_obe(vertex).count(qry_idx);
+  return this->get_children(vertex).empty();
 }
 
 Edge& Tree::get_incoming_edge(std::size_t vertex) {
@@ -343,7 +226,16 @@ const Edge& Tree::get_tree_edge(std::size_t edge_idx) const {
 }
 
 std::size_t Tree::get_graph_edge_id(std::size_t tree_edge_id) const {
-    return this->tree_graph_idx_map_.at(tree_edge_id);
+  auto [t, idx] = this->edge_id_map_.at(tree_edge_id);
+  return t == EdgeType::tree_edge ? this->te_g_idx_[idx] : this->be_g_idx_[idx];
+}
+
+std::size_t Tree::get_tree_edge_g_idx(std::size_t edge_idx) const {
+  return this->te_g_idx_.at(edge_idx);
+}
+
+std::size_t Tree::get_backedge_g_idx(std::size_t backedge_idx) const {
+  return this->be_g_idx_.at(backedge_idx);
 }
 
 const std::pair<EdgeType, std::size_t>& Tree::get_edge_idx(std::size_t edge_id) const {
@@ -355,69 +247,147 @@ BackEdge& Tree::get_backedge(std::size_t backedge_idx) {
 }
 
 BackEdge &Tree::get_backedge_ref_given_id(std::size_t backedge_id) {
-  std::size_t be_idx = this->be_id_to_idx_map_.at(backedge_id);
+  std::size_t be_idx = this->edge_id_map_.at(backedge_id).second;
   return this->back_edges.at(be_idx);
 }
 
 BackEdge Tree::get_backedge_given_id(std::size_t backedge_id) {
-  std::size_t be_idx = this->be_id_to_idx_map_.at(backedge_id);
+  std::size_t be_idx = this->edge_id_map_.at(backedge_id).second;
   return this->back_edges[be_idx];
 }
 
 void Tree::add_tree_edge(std::size_t frm, std::size_t to, std::size_t g_edge_idx, color c) {
+  assert(!this->frozen_);
   std::size_t edge_idx = this->tree_edges.size();
   std::size_t edge_count = edge_idx + this->back_edges.size();
   this->tree_edges.push_back(Edge(edge_count, frm, to, c));
+  this->te_g_idx_.push_back(g_edge_idx);
 
-  //if (this->g_edge_idx_map.count(g_edge_idx)) {
-    //std::cerr << "TE g_e id" << g_edge_idx << " id " << edge_count << "\n";
-        //throw std::runtime_error("Tree Edge already exists");
-  //}
-
-  this->g_edge_idx_map[g_edge_idx] = std::make_pair(EdgeType::tree_edge, edge_idx);
-
-  this->tree_graph_idx_map_[edge_count] = g_edge_idx;
-
-  this->edge_id_map_[edge_count] = std::make_pair(EdgeType::tree_edge, edge_idx);
-
-  this->nodes[frm].unset_null();
-  this->nodes[to].unset_null();
+  this->edge_id_map_.push_back(std::make_pair(EdgeType::tree_edge, edge_idx));
 
-  this->nodes[frm].add_child(edge_idx);
   this->nodes[to].set_parent(edge_idx);
 }
 
 std::size_t Tree::add_be(std::size_t frm, std::size_t to, EdgeType t, color c) {
+  return this->add_be(frm, to, UNDEFINED_SIZE_T, t, c);
+}
+
+std::size_t Tree::add_be(std::size_t frm, std::size_t to, std::size_t g_edge_id, EdgeType t, color c) {
   std::size_t back_edge_idx = this->back_edges.size();
   std::size_t edge_count = back_edge_idx + this->tree_edges.size();
   this->back_edges.push_back(BackEdge(edge_count, frm, to, t, c));
-  this->nodes[frm].add_obe(back_edge_idx);
-  this->nodes[to].add_ibe(back_edge_idx);
+  this->be_g_idx_.push_back(t != EdgeType::capping_back_edge ? g_edge_id : UNDEFINED_SIZE_T);
 
-  this->be_id_to_idx_map_[edge_count] = back_edge_idx;
+  this->edge_id_map_.push_back(std::make_pair(EdgeType::back_edge, back_edge_idx));
+
+  if (this->frozen_) {
+    this->added_ibe_next_.push_back(INVALID_IDX);
+    this->chain_added_be(back_edge_idx);
+  }
 
   return back_edge_idx;
 }
 
-std::size_t Tree::add_be(std::size_t frm, std::size_t to, std::size_t g_edge_id, EdgeType t, color c) {
-  std::size_t back_edge_idx = this->back_edges.size();
-  std::size_t edge_count = back_edge_idx + this->tree_edges.size();
-  this->back_edges.push_back(BackEdge(edge_count, frm, to, t, c));
+void Tree::chain_added_be(std::size_t backedge_idx) {
+  std::size_t to = this->back_edges[backedge_idx].get_tgt();
+  std::size_t& tail = this->added_ibe_tail_.at(to);
+  if (tail == INVALID_IDX) { this->added_ibe_head_[to] = backedge_idx; }
+  else { this->added_ibe_next_[tail - this->frozen_be_count_] = backedge_idx; }
+  tail = backedge_idx;
+}
+
+void Tree::reserve_be_slots() {
+  assert(this->frozen_ && this->back_edges.size() == this->frozen_be_count_);
+  std::size_t n = this->size();
+  std::size_t m = this->frozen_be_count_ + n;
+
+  this->back_edges.resize(m, BackEdge(INVALID_ID, INVALID_IDX, INVALID_IDX, EdgeType::back_edge));
+  this->be_g_idx_.resize(m, UNDEFINED_SIZE_T);
+  this->edge_id_map_.resize(this->tree_edges.size() + m);
+  this->added_ibe_next_.assign(n, INVALID_IDX);
+  this->brackets.resize(m);
+  this->slotted_ = true;
+}
 
-  if (t != EdgeType::capping_back_edge) {
-    this->tree_graph_idx_map_[edge_count] = g_edge_id;
-    this->g_edge_idx_map[g_edge_id] = std::make_pair(EdgeType::back_edge, back_edge_idx);
+std::size_t Tree::add_be_to_slot(std::size_t frm, std::size_t to, EdgeType t, bool chain) {
+  assert(this->slotted_);
+  std::size_t back_edge_idx = this->frozen_be_count_ + frm;
+  std::size_t id = back_edge_idx + this->tree_edges.size();
+  this->back_edges[back_edge_idx] = BackEdge(id, frm, to, t);
+  this->edge_id_map_[id] = std::make_pair(EdgeType::back_edge, back_edge_idx);
+
+  if (chain) { this->chain_added_be(back_edge_idx); }
+
+  return back_edge_idx;
+}
+
+void Tree::compact_be_slots() {
+  assert(this->slotted_);
+  std::size_t n = this->size();
+  std::size_t f = this->frozen_be_count_;
+  std::size_t te_count = this->tree_edges.size();
+
+  std::pmr::vector<std::size_t> new_idx(f + n, INVALID_IDX, this->resource());
+  for (std::size_t i{}; i < f; ++i) { new_idx[i] = i; }
+
+  std::pmr::vector<BackEdge> compacted(this->back_edges.begin(), this->back_edges.begin() + f, this->resource());
+  for (std::size_t v{n - 1}; v < INVALID_IDX; --v) {
+    const BackEdge& be = this->back_edges[f + v];
+    if (be.get_src() == INVALID_IDX) { continue; }
+
+    std::size_t back_edge_idx = compacted.size();
+    new_idx[f + v] = back_edge_idx;
+    compacted.push_back(BackEdge(back_edge_idx + te_count, be.get_src(), be.get_tgt(), be.type()));
+    compacted.back().set_class(be.get_class());
+  }
+
+  std::size_t m = compacted.size();
+  this->back_edges = std::move(compacted);
+  this->be_g_idx_.resize(m);
+  this->edge_id_map_.resize(te_count + m);
+  for (std::size_t i{f}; i < m; ++i) {
+    this->edge_id_map_[te_count + i] = std::make_pair(EdgeType::back_edge, i);
   }
 
-  this->edge_id_map_[edge_count] = std::make_pair(EdgeType::back_edge, back_edge_idx);
+  this->added_ibe_head_.assign(n, INVALID_IDX);
+  this->added_ibe_tail_.assign(n, INVALID_IDX);
+  this->added_ibe_next_.assign(m - f, INVALID_IDX);
+  for (std::size_t i{f}; i < m; ++i) { this->chain_added_be(i); }
 
-  this->nodes[frm].add_obe(back_edge_idx);
-  this->nodes.at(to).add_ibe(back_edge_idx);
+  this->brackets.remap(new_idx, m, this->bracket_lists);
+  for (std::size_t i{f}; i < m; ++i) { this->brackets.set_back_edge_id(i, this->back_edges[i].id()); }
 
+  this->slotted_ = false;
+}
 
-  this->be_id_to_idx_map_[edge_count] = back_edge_idx;
+void Tree::freeze() {
+  std::size_t n = this->size();
 
-  return back_edge_idx;
+  // counting sort of the edges by vertex, stable so each range is ascending
+  auto csr = [n](std::size_t m, auto key, std::pmr::vector<std::size_t>& off, std::pmr::vector<std::size_t>& out) {
+    off.assign(n + 1, 0);
+    for (std::size_t i{}; i < m; ++i) { ++off[key(i) + 1]; }
+    for (std::size_t i{1}; i <= n; ++i) { off[i] += off[i - 1]; }
+
+    out.assign(m, 0);
+    std::pmr::vector<std::size_t> pos(off.begin(), off.end() - 1, off.get_allocator());
+    for (std::size_t i{}; i < m; ++i) { out[pos[key(i)]++] = i; }
+  };
+
+  csr(this->tree_edges.size(), [&](std::size_t e) { return this->tree_edges[e].get_parent(); },
+      this->child_off_, this->children_);
+  // store the child vertex rather than the tree edge
+  for (std::size_t& e_idx : this->children_) { e_idx = this->tree_edges[e_idx].get_child(); }
+
+  csr(this->back_edges.size(), [&](std::size_t b) { return this->back_edges[b].get_src(); },
+      this->obe_off_, this->obe_);
+  csr(this->back_edges.size(), [&](std::size_t b) { return this->back_edges[b].get_tgt(); },
+      this->ibe_off_, this->ibe_);
+
+  this->frozen_be_count_ = this->back_edges.size();
+  this->added_ibe_head_.assign(n, INVALID_IDX);
+  this->added_ibe_tail_.assign(n, INVALID_IDX);
+  this->frozen_ = true;
 }
 
 
@@ -427,26 +397,13 @@ void Tree::set_hi(std::size_t vertex, std::size_t val) {
 
 /**
  * insert the elements of the child bracket list at the
- * beginning of the parent bracket list
- *
- * TODO: make constant time
+ * beginning of the parent bracket list in constant time
  *
  * @param parent_vertex
  * @param child_vertex
 */
 void Tree::concat_bracket_lists(std::size_t parent_vertex, std::size_t child_vertex) {
-  std::string fn_name = std::format("[povu::spanning_tree::Tree::{}]", __func__);
-
-  WBracketList* bl_p = this->bracket_lists[parent_vertex];
-  WBracketList* bl_c = this->bracket_lists[child_vertex];
-
-  if (bl_p == nullptr) {
-    this->bracket_lists[parent_vertex] = bl_c;
-    this->bracket_lists[child_vertex] = nullptr;
-  }
-  else {
-    bl_p->concat(bl_c);
-  }
+  this->brackets.concat(this->bracket_lists[parent_vertex], this->bracket_lists[child_vertex]);
 }
 
 // TODO: once deleted do we care to reflect changes in the concated ones?
@@ -456,67 +413,38 @@ void Tree::concat_bracket_lists(std::size_t parent_vertex, std::size_t child_ver
  * given a vertex id and a backedge idx
  */
 void Tree::del_bracket(std::size_t vertex, std::size_t backedge_idx) {
-  std::string fn_name = std::format("[povu::spanning_tree::Tree::{}]", __func__);
-
-  std::size_t be_id = this->back_edges.at(backedge_idx).id();
-  this->bracket_lists[vertex]->del(be_id);
+  this->brackets.del(this->bracket_lists[vertex], backedge_idx);
 }
 
 
 void Tree::push(std::size_t vertex, std::size_t backege_idx) {
-  std::string fn_name = std::format("[povu::spanning_tree::{}]", __func__);
-
-  // TODO: based on the Tree constructor we expect the pointer at v_idx will
-  // never be null why then do we need to check for null else code fails
-  // we then create a  bracket using the backedge ID
-
-  if (this->bracket_lists[vertex] == nullptr) {
-    this->bracket_lists[vertex] = new WBracketList{};
-  }
-
-  this->bracket_lists[vertex]->push(Bracket(this->back_edges.at(backege_idx).id()));
+  // the bracket lives in the slot of the backedge and carries its ID
+  this->brackets.push(this->bracket_lists[vertex], backege_idx, this->back_edges.at(backege_idx).id());
 }
 
 
-BracketList& Tree::get_bracket_list(std::size_t vertex) {
-  std::string fn_name = std::format("[povu::spanning_tree::{}]", __func__);
-  if (this->bracket_lists[vertex] == nullptr) {
-    throw std::runtime_error(std::format("{} Bracket list is null", fn_name));
-  }
-
-  return this->bracket_lists[vertex]->get_bracket_list();
+BracketList const& Tree::get_bracket_list(std::size_t vertex) const {
+  return this->bracket_lists[vertex];
 }
 
 
 Bracket& Tree::top(std::size_t vertex) {
-  std::string fn_name = std::format("[povu::spanning_tree::{}]", __func__);
-
-  return this->bracket_lists[vertex]->top();
+  return this->brackets.top(this->bracket_lists[vertex]);
 }
 
 
 std::size_t Tree::new_class() { return this->equiv_class_count_++; }
 
+void Tree::relabel_classes(std::function<std::size_t(std::size_t)> const& f, std::size_t class_count) {
+  auto relabel = [&](std::size_t c) { return c == UNDEFINED_SIZE_T ? c : f(c); };
 
-/**
- * Get the node id of the node with the given sort value
- *
- * The sort vector is sorted in ascending order based on the index from 0..n
- * the value at index zero in the sort vector (`sort_`) is the node id of the
- * node with the smallest sort value and so forth.
- * We can then use this node id to get the node from the nodes vector (`nodes`)
- *
- * @param[in] idx the sort value of the node
- * @return the node id of the node with the given sort value
- */
-std::size_t Tree::get_sorted(std::size_t idx) { return  this->sort_.at(idx);}
-
-std::size_t Tree::get_sorted_g(std::size_t idx) { return  this->sort_g.at(idx);}
+  for (Edge& e : this->tree_edges) { e.set_class(relabel(e.get_class())); }
+  for (BackEdge& be : this->back_edges) { be.set_class(relabel(be.get_class())); }
 
-const std::map<std::size_t, std::pair<EdgeType, std::size_t>>& Tree::get_g_edge_idx_map() const {
-  return this->g_edge_idx_map;
+  this->equiv_class_count_ = class_count;
 }
 
+
 void Tree::print_dot() {
   std::cout << std::format(
     "graph G {{\n"
@@ -527,14 +455,15 @@ void Tree::print_dot() {
 
   for (std::size_t i{}; i < this->size(); i++){
     std::string v_type_str = this->get_vertex(i).type() == VertexType::l ? "-" : "+";
-    std::cout << std::format("\t{} [label =  \"{} ({}{})\"];\n", i, i, this->get_vertex(i).name(), v_type_str);
+    std::cout << std::format("\t{} [label =  \"{} ({}{})\"];\n", i, i, this->get_vertex_name(i), v_type_str);
   }
 
   for (std::size_t i{}; i < this->size(); i++) {
-    for (auto c : this->get_child_edges(i)) {
-      std::string cl = c.get_class_idx() > 10000
+    for (std::size_t c_idx : this->get_children(i)) {
+      const Edge& c = this->get_parent_edge(c_idx);
+      std::string cl = c.get_class() > 10000
                            ? "\u2205"
-                           : std::to_string(c.get_class_idx());
+                           : std::to_string(c.get_class());
 
       std::string color = c.get_color() == color::gray ? "gray" : "black";
 
@@ -542,10 +471,16 @@ void Tree::print_dot() {
                                i, c.get_child(), c.id(), cl, color);
     }
 
-    for (auto o: this->get_obe_w_id(i)) {
-      std::string cl = o.first > 10000 ? "\u2205" : std::to_string(o.first);
+    // the out back edges, those added after freeze come last
+    std::vector<std::size_t> obe_idxs(this->get_obe_idxs(i).begin(), this->get_obe_idxs(i).end());
+    for (std::size_t be_idx{this->frozen_be_count_}; be_idx < this->back_edge_count(); ++be_idx) {
+      if (this->back_edges[be_idx].get_src() == i) { obe_idxs.push_back(be_idx); }
+    }
+
+    for (std::size_t be_idx : obe_idxs) {
+      const BackEdge& be = this->back_edges[be_idx];
+      std::string cl = be.id() > 10000 ? "\u2205" : std::to_string(be.id());
       // a capping backedge is red and can never have been gray
-      BackEdge be = this->get_backedge_given_id(o.first);
 
       bool is_capping = be.is_capping_backedge();
 
@@ -555,9 +490,9 @@ void Tree::print_dot() {
 
       if (is_capping) {
         color = "red";
-      } else if (this->get_backedge_given_id(o.first).get_color() == color::gray) {
+      } else if (be.get_color() == color::gray) {
         color = "gray";
-      } else if (this->get_backedge_given_id(o.first).get_color() == color::black) {
+      } else if (be.get_color() == color::black) {
         color = "black";
       } else {
         color = "blue";
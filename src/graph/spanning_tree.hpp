@@ -2,12 +2,11 @@
 #define SPANNING_TREE_HPP
 
 #include <cstddef>
+#include <functional>
+#include <memory_resource>
+#include <span>
 #include <string>
 #include <vector>
-#include <set>
-#include <list>
-#include <map>
-#include <unordered_map>
 
 #include "../common/types.hpp"
 #include "./bracket_list.hpp"
@@ -43,23 +42,8 @@ class Edge {
   std::size_t src; // target vertex
   std::size_t tgt; // source vertex
 
-  // does a tree edge need color?
-  // color edge_color;
-
   std::size_t class_; // equivalnce class id
 
-  // TODO: is size used?
-  // not used in tree edge
-  std::size_t size;      // (recent size) size of the bracket list
-  // std::size_t recent_class; // (recent class) id of the topmost backedge
-
-  std::size_t backedge_id; // TODO: used??
-
-  // not used in tree edge
-  // std::size_t id; // (recent class)
-  // Bracket* b; // if it is a backedge
-  bool null_;
-
   color color_;
 
 public:
@@ -114,16 +98,9 @@ class BackEdge {
   std::size_t src; // target vertex
   std::size_t tgt; // source vertex
 
-
-  // TODO: why this duplication?
   std::size_t class_; // equivalnce class id
-  std::size_t recent_class_; //
-  std::size_t recent_size_; //
 
-  // TODO: use an enum here
-  //bool capping_back_edge_; // is a capping back edge // TODO: remove, use type_
   EdgeType type_;
-  bool null_;
 
   color color_;
 
@@ -151,24 +128,14 @@ public:
  * Vertex
  * ------
  *
- * TODO: remove unused methods
+ * the per vertex scalars, the children and back edges of a vertex are ranges
+ * in the CSR arrays of the Tree
  */
 class Vertex {
   // dfsnum of the node in toposort
   std::size_t dfs_num_;
 
-  std::size_t parent_id; // id to idx // index to the tree edge vector ?
-
-  // indexes of the children edges in the tree_edges vector
-  std::set<std::size_t> children; // children // index to the tree edge vector
-
-  std::set<size_t> obe; // out back edges
-  std::set<size_t> ibe;  // in back edges
-
-  // TODO: remove
-  std::string name_ {}; // id/name of the vertex in the input GFA
-
-  pgt::VertexType type_;
+  std::size_t parent_id; // index of the tree edge to the parent
 
   /*
    dfs_num of the highest node originating from an outgoing backedge from this
@@ -176,98 +143,93 @@ class Vertex {
    */
   std::size_t hi_;
 
-  bool null_;
+  pgt::VertexType type_;
 
 public:
   // --------------
   // constructor(s)
   // --------------
-  //Vertex(); // creates a root with parent id set to and id of zero
-  //Vertex(std::size_t id, std::size_t parent_id);
-  Vertex(std::size_t dfs_num, const std::string& name, VertexType type_);
+  Vertex(std::size_t dfs_num, VertexType type_);
   // ---------
   // getter(s)
   // ---------
   bool is_root() const;
-  bool is_leaf() const;
   std::size_t dfs_num() const;
   std::size_t parent() const; // TODO: remove
   std::size_t hi() const; // TODO: remove
-  std::string const& name() const;
   VertexType type() const;
 
-  std::set<size_t> const& get_obe() const;
-  std::set<size_t> const& get_ibe() const;
-  bool is_null() const;
-
   // get the index of the edge that points to the parent in the tree
 
   size_t const& get_parent_idx() const; // TODO: remove, superceded by get_parent_edge_idx
   size_t get_parent_e_idx() const;
 
-  std::set<size_t> const& get_children() const;
-
   // ---------
   // setter(s)
   // ---------
-  void add_obe(std::size_t obe_id);
-  void add_ibe(std::size_t ibe_id);
-  void add_child(std::size_t e_id);
-  void unset_null(); // sets null to false;
 
   // the index of the parent node in the tree vertex
   void set_parent(std::size_t n_id);
-  void set_name(std::string const&name);
   void set_type(VertexType t);
   void set_hi(std::size_t val);
   // the dfs num of the node
   void set_dfs_num(std::size_t idx);
 };
 
+/*
+ * Tree
+ * ----
+ *
+ * Vertices and edges are added during the DFS, freeze() then lays the children
+ * and back edges of each vertex out in CSR arrays in DFS order. Back edges added
+ * after freeze (capping and simplifying back edges) are chained per target
+ * vertex.
+ */
 class Tree {
   // no of nodes in the tree
-  std::vector<Vertex> nodes;
-  std::vector<Edge> tree_edges;
-  std::vector<BackEdge> back_edges;
+  std::pmr::vector<Vertex> nodes;
+  // id of each vertex in the input GFA, pc::DUMMY_VERTEX_ID for the dummy
+  std::pmr::vector<std::size_t> ids_;
+  std::pmr::vector<Edge> tree_edges;
+  std::pmr::vector<BackEdge> back_edges;
+
+  // the children of v are children_[child_off_[v] .. child_off_[v+1])
+  std::pmr::vector<std::size_t> child_off_;
+  std::pmr::vector<std::size_t> children_;
+
+  // the indexes of the out and in back edges of v, in ascending order
+  std::pmr::vector<std::size_t> obe_off_;
+  std::pmr::vector<std::size_t> obe_;
+  std::pmr::vector<std::size_t> ibe_off_;
+  std::pmr::vector<std::size_t> ibe_;
+
+  bool frozen_ { false };
+  // number of back edges when the tree was frozen
+  std::size_t frozen_be_count_ {};
+
+  // in back edges added after freeze, a list per target vertex, linked through
+  // added_ibe_next_ which is indexed by back edge index - frozen_be_count_
+  std::pmr::vector<std::size_t> added_ibe_head_;
+  std::pmr::vector<std::size_t> added_ibe_tail_;
+  std::pmr::vector<std::size_t> added_ibe_next_;
+
+  // back edges added after freeze go in the slot of their source vertex, at
+  // frozen_be_count_ + source, until compact_be_slots
+  bool slotted_ { false };
 
-  // TODO: move the bracket list don't keep creating a new one
   // a BracketList for each node
   // the list of backedges bracketing a node
-  // a bracketList is a backedge with some metadata around it
-  //std::vector<BracketList *> bracket_lists;
-  std::vector<WBracketList*> bracket_lists;
+  // the brackets themselves live in the pool, one slot per backedge
+  std::pmr::vector<BracketList> bracket_lists;
+  BracketPool brackets;
 
-  // the index of an edge or backedge in the input graph
-  // key is the graph_idx and the value is the tree_idx or the backedge idx
-  std::map<std::size_t, std::pair<EdgeType, std::size_t>> g_edge_idx_map;
+  // the edge id is the index, the value is the type of the edge and its index
+  // in the tree_edges or back_edges vector
+  std::pmr::vector<std::pair<EdgeType, std::size_t>> edge_id_map_;
 
-  // tree idx to graph edge idx
-  std::map<std::size_t, std::size_t> tree_graph_idx_map_;
-
-  // a map from the back edge id to the index in the back_edges vector
-  std::map<std::size_t, std::size_t> be_id_to_idx_map_;
-
-  // a map from the back edge id to the index in the back_edges vector
-  std::map<std::size_t, std::size_t> te_id_to_idx_map_;
-
-  /*
-    a map from the edge id (in the spanning tree) to the index in the tree_edges
-    vector or the back_edges vector
-   */
-  std::map<std::size_t, std::pair<EdgeType, std::size_t>> edge_id_map_;
-
-  // Holds the topo mapping of the tree
-  // the index is the position in the toposort
-  // the value at a poistion is the index in nodes
-  // topo sort vector
-  std::vector<std::size_t> sort_;
-
-  // sort based on the input graph
-  // the index in the vertex is the index in the input graph
-  // and the value is the index in the tree
-  std::vector<std::size_t> sort_g;
-
-  // TODO: replace sort and sort_g with a two way map or remove both
+  // the index of each tree edge and back edge in the input graph
+  std::pmr::vector<std::size_t> te_g_idx_;
+  std::pmr::vector<std::size_t> be_g_idx_;
 
   static const size_t root_node_index {}; // 0
 
@@ -279,12 +241,9 @@ public:
   // --------------
   // constructor(s)
   // --------------
-  Tree(std::size_t size);
-
-  // ---------
-  // destructor(s)
-  // ---------
-  ~Tree();
+  // the containers of the tree and the scratch of the algorithms run on it
+  // come from mr
+  Tree(std::size_t size, std::pmr::memory_resource* mr = std::pmr::get_default_resource());
 
   // ---------
   // getter(s)
@@ -297,6 +256,8 @@ public:
   std::size_t tree_edge_count() const;
   std::size_t back_edge_count() const;
 
+  std::pmr::memory_resource* resource() const;
+
 
   Vertex const &get_vertex(std::size_t vertex) const;
   Vertex& get_vertex_mut(std::size_t vertex);
@@ -304,45 +265,29 @@ public:
   // if v_idx is the root, caues undefined behaviour
   Vertex const& get_p_vtx(std::size_t v_idx) const;
 
+  std::size_t get_vertex_id(std::size_t vertex) const;
+  // the id as a string, for output
+  std::string get_vertex_name(std::size_t vertex) const;
 
-  // given  tree edge index return a the child
-  // returns a node index
-  // a set?
-
-
-  // takes a vertex index and returns pair:
-  //   first => backedge id
-  //   second =>  node idx of the target vertex
-  std::set<std::pair<std::size_t, std::size_t>> get_obe_w_id(std::size_t vertex);
-  std::set<std::pair<std::size_t, std::size_t>> get_ibe_w_id(std::size_t vertex);
-
-  // take a vertex index and return an edge id and the child node index
-  std::set<std::pair<std::size_t, std::size_t>> get_children_w_id(std::size_t vertex);
-
-
-  // return edges that point to children of the vertex
-  std::vector<Edge> get_child_edges(std::size_t vertex);
-
-
-  // get index of the  be in back_edges vector
-  std::set<std::size_t> get_obe_idxs(std::size_t vertex);
-  std::set<std::size_t> get_ibe_idxs(std::size_t vertex);
-
-  size_t list_size(std::size_t vertex);
-  size_t get_hi(std::size_t vertex);
+  // the indexes of the children of a vertex in DFS order, the tree must be frozen
+  std::span<const std::size_t> get_children(std::size_t vertex) const;
 
+  // get index of the be in back_edges vector, in ascending order
+  // only the back edges added before freeze
+  std::span<const std::size_t> get_obe_idxs(std::size_t vertex) const;
+  std::span<const std::size_t> get_ibe_idxs(std::size_t vertex) const;
 
   /**
-    * @brief get indexes of the vertices the obes from this vertex points to (tgt/targets)
+   * @brief iterate the in back edges of a vertex added after freeze
+   *
+   * for (b = first_added_ibe(v); b != INVALID_IDX; b = next_added_ibe(b))
+   * visits them in ascending order
    */
-    // TODO rename to get_obe_tgts
-  std::set<size_t> get_obe(std::size_t vertex); // get backedge target indexes
+  std::size_t first_added_ibe(std::size_t vertex) const;
+  std::size_t next_added_ibe(std::size_t backedge_idx) const;
 
-  /**
-    * @brief get sources of the vertices the ibes from this vertex points from (srcs)
-   */
-      // TODO rename to get_obe_srcs
-  std::set<size_t> get_ibe(std::size_t vertex);
+  size_t list_size(std::size_t vertex);
+  size_t get_hi(std::size_t vertex);
 
   /**
    * @brief a reference to the tree edge given the index in the tree_edges vector
@@ -352,16 +297,13 @@ public:
    */
   const Edge& get_tree_edge(std::size_t edge_idx) const;
 
-  /**
-    * @brief a reference to the tree edge given the edge id
-    *
-    * @param edge_id the id of the edge
-    * @return a reference to the edge
-   */
-  //const Edge& get_tree_edge_by_id(std::size_t edge_id) const;
-
+  // the index in the input graph of a tree or back edge given its edge id
   std::size_t get_graph_edge_id(std::size_t tree_edge_id) const;
 
+  // the index in the input graph of a tree edge or back edge given its index
+  std::size_t get_tree_edge_g_idx(std::size_t edge_idx) const;
+  std::size_t get_backedge_g_idx(std::size_t backedge_idx) const;
+
   const std::pair<EdgeType, std::size_t>& get_edge_idx(std::size_t edge_id) const;
 
   // return reference to a back edge given the
@@ -370,7 +312,6 @@ public:
   BackEdge& get_backedge_ref_given_id(std::size_t backedge_id);
   // given the back edge's unique back edge id return a reference to the backedge
   BackEdge get_backedge_given_id(std::size_t backedge_id);
-  std::set<std::size_t> get_children(std::size_t vertex);
 
   bool is_root(std::size_t vertex) const;
   bool is_leaf(std::size_t vertex) const;
@@ -389,35 +330,11 @@ public:
   std::size_t get_parent(std::size_t v_idx); // TODO: remove, superceded by get_parent_idx
   std::size_t get_parent_v_idx(std::size_t v_idx) const;
 
-  bool has_ibe(std::size_t vertex, std::size_t qry_idx);
-  bool has_obe(std::size_t vertex, std::size_t qry_idx);
-  bool has_child(std::size_t vertex, std::size_t qry_idx);
-
-  // the vertex id of the node at sort value idx
-  std::size_t get_sorted(std::size_t idx);
-
-  std::size_t get_sorted_g(std::size_t idx);
-
-  const std::map<std::size_t, std::pair<EdgeType, std::size_t>>& get_g_edge_idx_map() const;
-
   // -------
   // setters
   // -------
 
-  //void topo_sort();
-
-  // takes an index in toposort
-  // and a vertex and sets the vertex as value in the toposort
-  // vector
-  void set_sort(std::size_t idx, std::size_t vertex);
-
-  // takes an index in the input graph
-  // and a vertex and sets the vertex as value in the toposort
-  // vector
-  void set_sort_g(std::size_t idx, std::size_t vertex);
-
-
-  void add_vertex(Vertex&& v);
+  void add_vertex(Vertex&& v, std::size_t v_id);
 
   // set the dfs number of a vertex
   void set_dfs_num(std::size_t vertex, std::size_t dfs_num);
@@ -436,6 +353,9 @@ public:
                      std::size_t g_edge_idx,
                      color clr=color::black);
 
+  // build the CSR children and back edge ranges, no tree edges may be added after
+  void freeze();
+
   void set_hi(std::size_t vertex, std::size_t val);
 
   // vst
@@ -449,7 +369,32 @@ public:
   // return the current equivalence class count then increment it
   std::size_t new_class();
 
-  BracketList& get_bracket_list(std::size_t vertex);
+  // map the class of every tree and back edge through f, the tree then has class_count classes
+  void relabel_classes(std::function<std::size_t(std::size_t)> const& f, std::size_t class_count);
+
+  /*
+   * back edge slots
+   * ---------------
+   * cycle equivalence adds at most one capping or simplifying back edge per
+   * vertex. Giving each vertex a slot for it lets disjoint subtrees add back
+   * edges concurrently.
+   */
+
+  // reserve a back edge slot for every vertex, the tree must be frozen
+  void reserve_be_slots();
+
+  // add a back edge in the slot of frm, chain it onto to if chain is true
+  std::size_t add_be_to_slot(std::size_t frm, std::size_t to, EdgeType t, bool chain);
+
+  // chain an added back edge onto the in back edges of its target
+  void chain_added_be(std::size_t backedge_idx);
+
+  // drop the unused slots, the back edges, their ids and the in back edge
+  // chains end up as they would had the back edges been added with add_be
+  // in descending order of their source
+  void compact_be_slots();
+
+  BracketList const& get_bracket_list(std::size_t vertex) const;
 
   // ------------
   // I/O
@@ -1,7 +1,9 @@
+#include <algorithm>
 #include <format>
 #include <fstream>
 #include <cstddef>
 #include <iostream>
+#include <iterator>
 #include <ostream>
 #include <string>
 #include <vector>
@@ -16,100 +18,113 @@ namespace pc = povu::constants;
 namespace pu = povu::utils;
 
 /**
- * @brief Get the size of a file
- * @param fp file path
- * @return size of the file in bytes
+ * @brief read a whole file into a string
  */
-std::size_t get_file_size(const std::string& fp) {
-  std::streampos begin, end;
-  std::ifstream f (fp);
+std::string read_file(const std::string& fp) {
+  std::ifstream f(fp, std::ios::binary);
 
   if (!f) { FILE_ERROR(fp); }
 
-  begin = f.tellg();
-  f.seekg (0, std::ios::end);
-  end = f.tellg();
-  f.close();
-
-  return end-begin;
+  return std::string(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
 }
 
 
+namespace {
+const std::size_t FL_COLS {3}; // number of columns in a .fl file
+
 /**
- * read the entire file into a string
- * should be faster for small inputs to read the entire file into a string and
- * process it at once
- * will perform whitespace normalization/formatting
+ * @brief add the flubble on a line of flb text to canonical_fl if it is a leaf
  */
-void read_lines_to_vector_str(const std::string& fp, std::vector<std::string>* v) {
-  std::ifstream f{fp};
-  std::string temp;
-
-  if (!f) { FILE_ERROR(fp); }
+void add_if_canonical(const std::string& line, const std::string& name, std::vector<std::string>& tokens,
+                      std::vector<pgt::flubble>& canonical_fl) {
+  pu::split(line, pc::COL_SEP, &tokens);
 
-  // read each line into a string
-  while (std::getline(f, temp)) {
-    v->push_back(temp);
+  if (tokens.size() != FL_COLS) {
+    std::cerr << std::format("ERROR: invalid number of columns. Expected {}, got {} in file {}\n", FL_COLS, tokens.size(), name);
+    std::exit(1);
   }
-}
 
+  // if it is a dummy or not a leaf
+  if (tokens[1] == std::string(1, pc::NO_VALUE) || tokens[2] != std::string(1, pc::NO_VALUE)) {
+    tokens.clear();
+    return;
+  }
 
-void fp_to_vector (const std::string& fp, std::vector<std::string>* v) {
-  std::size_t file_size = get_file_size(fp);
+  pgt::flubble fl (tokens[1]) ;
+  canonical_fl.push_back(fl);
 
-  v->reserve(file_size);
-  read_lines_to_vector_str(fp, v);
-  v->shrink_to_fit();
+  tokens.clear();
 }
+} // namespace
 
 
 std::vector<pgt::flubble> read_canonical_fl(const std::string& fp) {
-  std::vector<pgt::flubble> canonical_fl;
+  return read_canonical_fl(read_file(fp), fp);
+}
 
-  std::vector<std::string> lines;
-  fp_to_vector(fp, &lines);
+
+std::vector<pgt::flubble> read_canonical_fl(std::string_view flb, const std::string& name) {
+  std::vector<pgt::flubble> canonical_fl;
 
   std::vector<std::string> tokens;
+  std::string line;
 
-  const std::size_t FL_COLS {3}; // number of columns in a .fl file
+  while (!flb.empty()) {
+    std::size_t end = flb.find('\n');
+    line.assign(flb.substr(0, end));
+    flb.remove_prefix(end == std::string_view::npos ? flb.size() : end + 1);
 
-  for (const std::string& line : lines) {
+    add_if_canonical(line, name, tokens, canonical_fl);
+  }
 
+  return canonical_fl;
+}
+
+
+pvtr::Tree<pgt::flubble> read_bub(std::string_view flb, const std::string& name) {
+  std::size_t line_count = std::count(flb.begin(), flb.end(), '\n');
+  pvtr::Tree<pgt::flubble> bt(line_count);
+
+  std::vector<std::string> tokens;
+  std::vector<std::string> children;
+  std::string line;
+
+  for (std::size_t i {}; !flb.empty(); ++i) {
+    std::size_t end = flb.find('\n');
+    line.assign(flb.substr(0, end));
+    flb.remove_prefix(end == std::string_view::npos ? flb.size() : end + 1);
+
+    tokens.clear();
     pu::split(line, pc::COL_SEP, &tokens);
 
-    if (tokens.size() != FL_COLS) {
-      std::cerr << std::format("ERROR: invalid number of columns. Expected {}, got {} in file {}\n", FL_COLS, tokens.size(), fp);
+    // the vertices are listed in order starting from the root
+    if (tokens.size() != FL_COLS || tokens[0] != std::to_string(i)) {
+      std::cerr << std::format("ERROR: invalid line {} in file {}\n", i + 1, name);
       std::exit(1);
     }
 
-    // if it is a dummy or not a leaf
-    if (tokens[1] == std::string(1, pc::NO_VALUE) || tokens[2] != std::string(1, pc::NO_VALUE)) {
-      tokens.clear();
-      continue;
+    if (i > 0) {
+      bt.add_vertex(tokens[1] == std::string(1, pc::NO_VALUE) ? pvtr::Vertex<pgt::flubble>(i)
+                                                               : pvtr::Vertex<pgt::flubble>(i, pgt::flubble(tokens[1])));
     }
 
-    pgt::flubble fl (tokens[1]) ;
-    canonical_fl.push_back(fl);
+    if (tokens[2] == std::string(1, pc::NO_VALUE)) { continue; }
 
-    tokens.clear();
+    children.clear();
+    pu::split(tokens[2], ',', &children);
+    for (const std::string& c : children) { bt.add_edge(i, std::stoull(c)); }
   }
 
-  return canonical_fl;
+  return bt;
 }
 
 
-void write_bub(const pvtr::Tree<pgt::flubble>& bt,
-               const std::string& base_name,
-               const core::config& app_config) {
-  // TODO: combine and pass as single arg
-  std::string bub_file_name = std::format("{}/{}.flb", std::string{app_config.get_output_dir()}, base_name); // file path and name
-  std::ofstream bub_file(bub_file_name);
+pvtr::Tree<pgt::flubble> read_bub(const std::string& fp) {
+  return read_bub(read_file(fp), fp);
+}
 
-  if (!bub_file.is_open()) {
-    std::cerr << "ERROR: could not open file " << bub_file_name << "\n";
-    std::exit(1);
-  }
 
+void write_bub(const pvtr::Tree<pgt::flubble>& bt, std::ostream& bub_file) {
   for (std::size_t i {}; i < bt.size(); ++i) {
 
     //std::cerr << "i: " << i << std::endl;
@@ -145,6 +160,22 @@ void write_bub(const pvtr::Tree<pgt::flubble>& bt,
       bub_file << "\n";
     }
   }
+}
+
+
+void write_bub(const pvtr::Tree<pgt::flubble>& bt,
+               const std::string& base_name,
+               const core::config& app_config) {
+  // TODO: combine and pass as single arg
+  std::string bub_file_name = std::format("{}/{}.flb", std::string{app_config.get_output_dir()}, base_name); // file path and name
+  std::ofstream bub_file(bub_file_name);
+
+  if (!bub_file.is_open()) {
+    std::cerr << "ERROR: could not open file " << bub_file_name << "\n";
+    std::exit(1);
+  }
+
+  write_bub(bt, bub_file);
 
   bub_file.close();
 }
@@ -0,0 +1,216 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+#include "./io.hpp"
+
+namespace povu::io::flf {
+
+/*
+  flf layout
+  ----------
+
+  all integers are in host byte order
+
+    header                    flf_header
+    blocks                    the flb text of each tree, in the order they were
+                              written
+    padding                   up to an 8 byte boundary
+    index   [component_count] entry, sorted by component id
+    footer                    flf_footer
+*/
+
+const char MAGIC[8] = { 'P', 'O', 'V', 'U', 'F', 'L', 'F', '\0' };
+const std::uint64_t VERSION { 1 };
+
+// the size of the buffer the blocks are written through
+const std::size_t WRITE_BUFFER_SIZE { 1 << 20 };
+
+struct flf_header {
+  char magic[8];
+  std::uint64_t version;
+};
+
+struct flf_footer {
+  std::uint64_t index_offset;
+  std::uint64_t component_count;
+  char magic[8];
+};
+
+inline std::uint64_t aligned(std::uint64_t n) { return (n + 7) & ~std::uint64_t{7}; }
+
+
+bool is_flf(const std::string& fp) {
+  std::ifstream f(fp, std::ios::binary);
+  char magic[sizeof(MAGIC)] {};
+  return f.read(magic, sizeof(magic)) && std::memcmp(magic, MAGIC, sizeof(MAGIC)) == 0;
+}
+
+
+/*
+  writer
+  ------
+ */
+
+writer::writer(const std::string& fp) : buf_(new char[WRITE_BUFFER_SIZE]), fp_(fp) {
+  this->out_.rdbuf()->pubsetbuf(this->buf_.get(), WRITE_BUFFER_SIZE);
+  this->out_.open(fp, std::ios::binary | std::ios::trunc);
+
+  if (!this->out_.is_open()) {
+    std::cerr << "ERROR: could not open file " << fp << "\n";
+    std::exit(1);
+  }
+
+  flf_header h {};
+  std::memcpy(h.magic, MAGIC, sizeof(MAGIC));
+  h.version = VERSION;
+  this->out_.write(reinterpret_cast<const char*>(&h), sizeof(h));
+  this->offset_ = sizeof(h);
+}
+
+void writer::add(const pvtr::Tree<pgt::flubble>& ft, std::size_t component_id) {
+  this->block_.str("");
+  povu::io::bub::write_bub(ft, this->block_);
+
+  std::string_view b = this->block_.view();
+  this->out_.write(b.data(), b.size());
+  this->index_.push_back({component_id, this->offset_, b.size()});
+  this->offset_ += b.size();
+}
+
+void writer::close() {
+  std::sort(this->index_.begin(), this->index_.end(),
+            [](const entry& a, const entry& b) { return a.component_id < b.component_id; });
+
+  const char padding[8] {};
+  std::uint64_t index_offset = aligned(this->offset_);
+  this->out_.write(padding, index_offset - this->offset_);
+
+  this->out_.write(reinterpret_cast<const char*>(this->index_.data()), this->index_.size() * sizeof(entry));
+
+  flf_footer f { index_offset, this->index_.size(), {} };
+  std::memcpy(f.magic, MAGIC, sizeof(MAGIC));
+  this->out_.write(reinterpret_cast<const char*>(&f), sizeof(f));
+
+  this->out_.close();
+  if (!this->out_) {
+    std::cerr << "ERROR: could not write file " << this->fp_ << "\n";
+    std::exit(1);
+  }
+}
+
+
+/*
+  reader
+  ------
+ */
+
+reader::reader(const std::string& fp) {
+  std::string fn_name { std::format("[povu::io::flf::{}]", __func__) };
+
+  int fd = ::open(fp.c_str(), O_RDONLY);
+  if (fd == -1) {
+    std::cerr << std::format("{} Couldn't open flf file {}.\n", fn_name, fp);
+    exit(1);
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) == -1) {
+    ::close(fd);
+    throw std::invalid_argument(std::format("{} Couldn't stat flf file {}", fn_name, fp));
+  }
+  this->size_ = st.st_size;
+
+  if (this->size_ < sizeof(flf_header) + sizeof(flf_footer)) {
+    ::close(fd);
+    throw std::invalid_argument(std::format("{} {} is too small to be a flf file", fn_name, fp));
+  }
+
+  void* m = mmap(nullptr, this->size_, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (m == MAP_FAILED) {
+    std::cerr << std::format("{} Couldn't mmap flf file {}.\n", fn_name, fp);
+    exit(1);
+  }
+  this->buf_ = static_cast<char*>(m);
+
+  // the destructor doesn't run if the constructor throws
+  try {
+    const flf_header* h = reinterpret_cast<const flf_header*>(this->buf_);
+    if (std::memcmp(h->magic, MAGIC, sizeof(MAGIC)) != 0 || h->version != VERSION) {
+      throw std::invalid_argument(std::format("{} {} is not a version {} flf file", fn_name, fp, VERSION));
+    }
+
+    // a writer that did not finish leaves no footer. The index is all that
+    // lies between index_offset and the footer, the size of the file bounds
+    // both so nothing below can overflow
+    flf_footer f;
+    const std::uint64_t footer_offset = this->size_ - sizeof(flf_footer);
+    std::memcpy(&f, this->buf_ + footer_offset, sizeof(f));
+    if (std::memcmp(f.magic, MAGIC, sizeof(MAGIC)) != 0 || f.index_offset % 8 != 0 ||
+        f.index_offset < sizeof(flf_header) || f.index_offset > footer_offset ||
+        f.component_count > (footer_offset - f.index_offset) / sizeof(entry) ||
+        f.index_offset + f.component_count * sizeof(entry) != footer_offset) {
+      throw std::invalid_argument(std::format("{} {} is truncated", fn_name, fp));
+    }
+
+    this->index_ = reinterpret_cast<const entry*>(this->buf_ + f.index_offset);
+    this->count_ = f.component_count;
+
+    // every block lies between the header and the index, and the index is
+    // sorted for block() to search it
+    for (std::size_t i {}; i < this->count_; ++i) {
+      const entry& e = this->index_[i];
+      if (e.offset < sizeof(flf_header) || e.offset > f.index_offset || e.size > f.index_offset - e.offset) {
+        throw std::invalid_argument(std::format("{} {} is corrupt: block {} is out of range", fn_name, fp, i));
+      }
+      if (i > 0 && this->index_[i - 1].component_id >= e.component_id) {
+        throw std::invalid_argument(std::format("{} {} is corrupt: index entry {} is out of order", fn_name, fp, i));
+      }
+    }
+  }
+  catch (...) {
+    munmap(this->buf_, this->size_);
+    throw;
+  }
+}
+
+reader::~reader() { if (this->buf_ != nullptr) { munmap(this->buf_, this->size_); } }
+
+std::size_t reader::size() const { return this->count_; }
+
+std::vector<std::size_t> reader::component_ids() const {
+  std::vector<std::size_t> ids;
+  ids.reserve(this->count_);
+  for (std::size_t i{}; i < this->count_; i++) { ids.push_back(this->index_[i].component_id); }
+  return ids;
+}
+
+std::string_view reader::block(std::size_t component_id) const {
+  const entry* end = this->index_ + this->count_;
+  const entry* e = std::lower_bound(this->index_, end, component_id,
+                                    [](const entry& a, std::size_t id) { return a.component_id < id; });
+
+  if (e == end || e->component_id != component_id) {
+    throw std::out_of_range(std::format("[povu::io::flf::{}] no component {} in the forest", __func__, component_id));
+  }
+
+  return std::string_view(this->buf_ + e->offset, e->size);
+}
+
+std::vector<pgt::flubble> reader::read_canonical_fl(std::size_t component_id) const {
+  return povu::io::bub::read_canonical_fl(this->block(component_id), std::format("component {}", component_id));
+}
+
+} // namespace povu::io::flf
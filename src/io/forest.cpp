@@ -0,0 +1,120 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <format>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "../common/scheduler.hpp"
+#include "../common/types.hpp"
+#include "../common/utils.hpp"
+#include "./io.hpp"
+
+namespace povu::io::forest {
+namespace pps = povu::scheduler;
+namespace pt = povu::types;
+
+namespace {
+/**
+ * @brief hashes a flubble by its boundaries
+ */
+struct flubble_hash {
+  std::size_t operator()(const std::pair<std::uint64_t, std::uint64_t>& b) const {
+    return std::hash<std::uint64_t>{}(pgt::hash_combine(b.first, b.second));
+  }
+};
+} // namespace
+
+std::vector<pgt::flubble> read_canonical_fl(const core::config& app_config) {
+  std::string fn_name = std::format("[povu::io::forest::{}]", __func__);
+
+  auto t0 = pt::Time::now();
+
+  std::filesystem::path forest_fp = app_config.get_forest_dir();
+  if (!std::filesystem::is_regular_file(forest_fp)) { forest_fp /= povu::io::flf::FOREST_FILE_NAME; }
+
+  // -----
+  // read each file or each tree of a forest file into a part of its own, a pft
+  // needs no parsing and is a single part
+  // -----
+  std::vector<std::vector<pgt::flubble>> parts;
+  std::vector<pps::task> tasks;
+  std::optional<povu::io::flf::reader> forest;
+  std::vector<std::filesystem::path> flubble_files;
+
+  if (std::filesystem::is_regular_file(forest_fp) && povu::io::pft::is_pft(forest_fp.string())) {
+    std::cerr << std::format("Reading flubble forest file: {}\n", forest_fp.string());
+    parts.push_back(povu::io::pft::reader(forest_fp.string()).canonical_fl());
+  }
+  else if (std::filesystem::is_regular_file(forest_fp) && povu::io::flf::is_flf(forest_fp.string())) {
+    std::cerr << std::format("Reading flubble forest file: {}\n", forest_fp.string());
+    forest.emplace(forest_fp.string());
+    std::vector<std::size_t> component_ids = forest->component_ids();
+
+    parts.resize(component_ids.size());
+    for (std::size_t i {}; i < component_ids.size(); ++i) {
+      std::size_t component_id = component_ids[i];
+      tasks.push_back({forest->block(component_id).size(),
+                       [&, i, component_id] { parts[i] = forest->read_canonical_fl(component_id); }});
+    }
+  }
+  else {
+    flubble_files = povu::io::generic::get_files(app_config.get_forest_dir(), ".flb");
+    std::cerr << std::format("Reading {} flubble files from {}\n", flubble_files.size(), app_config.get_forest_dir().string());
+
+    parts.resize(flubble_files.size());
+    for (std::size_t i {}; i < flubble_files.size(); ++i) {
+      tasks.push_back({std::filesystem::file_size(flubble_files[i]),
+                       [&, i] { parts[i] = povu::io::bub::read_canonical_fl(flubble_files[i].string()); }});
+    }
+  }
+
+  std::vector<pps::thread_stats> stats = pps::run(std::move(tasks), app_config.thread_count());
+  auto t1 = pt::Time::now();
+
+  // -----
+  // drop the flubbles seen in an earlier part then copy the parts into place
+  // -----
+  std::size_t total {};
+  for (const std::vector<pgt::flubble>& part : parts) { total += part.size(); }
+
+  std::unordered_set<std::pair<std::uint64_t, std::uint64_t>, flubble_hash> seen;
+  seen.reserve(total);
+
+  auto key = [](const pgt::flubble& fl) { return std::make_pair(pgt::pack(fl.start_), pgt::pack(fl.end_)); };
+
+  std::vector<std::size_t> offsets { 0 };
+  offsets.reserve(parts.size() + 1);
+  for (std::vector<pgt::flubble>& part : parts) {
+    std::erase_if(part, [&](const pgt::flubble& fl) { return !seen.insert(key(fl)).second; });
+    offsets.push_back(offsets.back() + part.size());
+  }
+
+  std::vector<pgt::flubble> canonical_flubbles(offsets.back(), pgt::flubble(pgt::id_n_orientation_t{}, pgt::id_n_orientation_t{}));
+
+  std::vector<pps::task> copies;
+  for (std::size_t i {}; i < parts.size(); ++i) {
+    copies.push_back({parts[i].size(), [&, i] {
+      std::copy(parts[i].begin(), parts[i].end(), canonical_flubbles.begin() + offsets[i]);
+      std::vector<pgt::flubble>().swap(parts[i]);
+    }});
+  }
+  pps::run(std::move(copies), app_config.thread_count());
+
+  if (app_config.verbosity() > 1) {
+    pps::report(std::cerr, fn_name, stats, t1 - t0);
+    povu::utils::report_time(std::cerr, fn_name, "reading flubbles", t1 - t0);
+    povu::utils::report_time(std::cerr, fn_name, "deduplicating and merging flubbles", pt::Time::now() - t1);
+    std::cerr << std::format("{} Read {} canonical flubbles, {} were duplicates\n",
+                             fn_name, canonical_flubbles.size(), total - canonical_flubbles.size());
+  }
+
+  return canonical_flubbles;
+}
+
+} // namespace povu::io::forest
@@ -1,18 +1,21 @@
+#include <algorithm>
 #include <cassert>
+#include <charconv>
 #include <cstddef>
 #include <cstdlib>
-// #include <exception>
+#include <cstring>
+#include <exception>
 #include <format>
 // #include <functional>
-#include <fstream>
 #include <iostream>
 //#include <map>
 #include <set>
-#include <sstream>
+#include <stdexcept>
 #include <string>
+#include <string_view>
 #include <sys/types.h>
 // #include <limits>
-// #include <thread>
+#include <thread>
 #include <tuple>
 #include <vector>
 
@@ -29,158 +32,388 @@ namespace io::from_gfa {
 namespace bd = povu::bidirected;
 namespace pg = povu::graph;
 namespace pgt = povu::graph_types;
+namespace pt = povu::types;
+namespace pc = povu::constants;
 using namespace povu::graph;
 
 
-std::vector<std::string> splitString(const std::string& str, char delimiter) {
-    std::vector<std::string> tokens;
-    std::stringstream ss(str);
-    std::string token;
+/*
+  GFA tokenizer
+  -------------
 
-    while (std::getline(ss, token, delimiter)) {
-        tokens.push_back(token);
+  walks a memory mapped GFA file line by line handing out string_views into the
+  mapped buffer so that no line or field is ever copied
+*/
+
+/**
+ * @brief RAII wrapper around a read only memory mapped GFA file
+ */
+struct mmapped_gfa {
+  char* buf { nullptr };
+  int fd { -1 };
+  std::size_t size {};
+
+  explicit mmapped_gfa(const char* filename) {
+    this->size = gfak::mmap_open(filename, this->buf, this->fd);
+    if (this->fd == -1) {
+      std::cerr << "Couldn't open GFA file " << filename << "." << std::endl;
+      exit(1);
     }
+  }
+
+  mmapped_gfa(const mmapped_gfa&) = delete;
+  mmapped_gfa& operator=(const mmapped_gfa&) = delete;
+
+  ~mmapped_gfa() { gfak::mmap_close(this->buf, this->fd, this->size); }
+
+  const char* begin() const { return this->buf; }
+  const char* end() const { return this->buf + this->size; }
+};
+
+/**
+ * @brief return the line that starts at p and advance p to the start of the
+ * next line
+ */
+inline std::string_view next_line(const char*& p, const char* end) {
+  const char* nl = static_cast<const char*>(std::memchr(p, '\n', end - p));
+  const char* line_end = nl == nullptr ? end : nl;
+
+  std::string_view line(p, line_end - p);
+  p = nl == nullptr ? end : nl + 1;
 
-    return tokens;
+  if (!line.empty() && line.back() == '\r') { line.remove_suffix(1); }
+
+  return line;
 }
 
+/**
+ * @brief return the tab separated field at pos and advance pos past it
+ */
+inline std::string_view next_field(std::string_view line, std::size_t& pos) {
+  if (pos >= line.size()) { return {}; }
 
-int foo(const char* filename, std::vector<std::size_t>& v_ids, std::vector<std::tuple<std::size_t, pgt::or_t, std::size_t, pgt::or_t>>& edges) {
-  std::ifstream file(filename); // Open the file
-  if (!file) {
-    std::cerr << "Unable to open file" << std::endl;
-    return 1;
-  }
+  std::size_t tab = line.find('\t', pos);
+  if (tab == std::string_view::npos) { tab = line.size(); }
 
-  std::string line;
-  std::vector<std::string> tokens;
+  std::string_view field = line.substr(pos, tab - pos);
+  pos = tab + 1;
 
-  while (std::getline(file, line)) {
-    tokens = splitString(line, '\t');
-    if (tokens[0] == "S") {
+  return field;
+}
 
-      v_ids.push_back(stoull(tokens[1]));
-    }
-    else if (tokens[0] == "L") {
-
-      std::size_t src = stoull(tokens[1]);
-      // char src_o = tokens[2][0];
-      pgt::or_t src_o = tokens[2][0] == '+' ? pgt::or_t::forward : pgt::or_t::reverse;
-      std::size_t snk = stoull(tokens[3]);
-      pgt::or_t snk_o = tokens[4][0] == '+' ? pgt::or_t::forward : pgt::or_t::reverse;
-      edges.push_back(std::make_tuple(src, src_o, snk, snk_o));
-    }
+/**
+ * @brief parse a numeric segment name in place
+ */
+inline std::size_t to_id(std::string_view s) {
+  std::size_t id {};
+  auto [ptr, ec] = std::from_chars(s.data(), s.data() + s.size(), id);
+  if (ec != std::errc() || ptr != s.data() + s.size()) {
+    throw std::invalid_argument(
+      std::format("[povu::io::{}] expected a numeric segment name but got {}", __func__, s));
   }
+  return id;
+}
 
-  file.close(); // Close the file
-  return 0;
+inline pgt::or_t to_or(std::string_view s) {
+  return !s.empty() && s.front() == '+' ? pgt::or_t::forward : pgt::or_t::reverse;
 }
 
+typedef std::tuple<std::size_t, pgt::or_t, std::size_t, pgt::or_t> gfa_link;
+
+// the L line of a link, for errors
+std::string link_str(const gfa_link& link) {
+  auto [src, src_or, snk, snk_or] = link;
+  return std::format("L {} {} {} {}", src, src_or == pgt::or_t::forward ? '+' : '-',
+                     snk, snk_or == pgt::or_t::forward ? '+' : '-');
+}
 
 /**
- * To a variation graph represented as a bidirected graph
- *
- *
- *
- * @param [in] filename The GFA file to read
- * @return A VariationGraph object from the GFA file
+ * @brief a P line staged as views into the mapped file, the comma separated
+ * steps are resolved to vertex indexes once all S lines have been seen
  */
-povu::graph::Graph to_pv_graph(const char* filename, const core::config& app_config) {
-  std::string fn_name { std::format("[povu::io::{}]", __func__) };
+struct gfa_path {
+  std::string_view name;
+  std::string_view steps;
+};
 
+/**
+ * @brief the S, L and P records found in one chunk of a GFA file
+ *
+ * labels and paths are views into the mapped file and are only filled in when
+ * the caller asks for them
+ */
+struct gfa_chunk {
   std::vector<std::size_t> v_ids;
+  std::vector<std::string_view> labels;
+  std::vector<gfa_link> edges;
+  std::vector<gfa_path> paths;
+  std::size_t path_count {};
+};
 
-  std::vector<std::tuple<std::size_t, pgt::or_t, std::size_t, pgt::or_t>> edges;
+/**
+ * @brief collect the records of an mmapped GFA buffer
+ *
+ * Only the first byte of lines that aren't needed is looked at. P lines are
+ * counted and, unless keep_paths is set, skipped over with a single memchr to
+ * the next newline, as are W lines and headers.
+ */
+void scan_records(const char* p, const char* end, bool keep_labels, bool keep_paths, gfa_chunk& chunk) {
+  while (p < end) {
+    if (*p == 'P') { ++chunk.path_count; }
 
-  foo(filename, v_ids, edges);
+    if (*p != 'S' && *p != 'L' && !(*p == 'P' && keep_paths)) {
+      const char* nl = static_cast<const char*>(std::memchr(p, '\n', end - p));
+      p = nl == nullptr ? end : nl + 1;
+      continue;
+    }
 
-  pg::Graph g(v_ids.size(), edges.size());
+    std::string_view line = next_line(p, end);
+    std::size_t pos {};
+    std::string_view rec = next_field(line, pos);
+    if (rec.size() != 1) { continue; }
 
+    if (rec.front() == 'S') {
+      chunk.v_ids.push_back(to_id(next_field(line, pos)));
+      if (keep_labels) { chunk.labels.push_back(next_field(line, pos)); }
+    }
+    else if (rec.front() == 'P') {
+      std::string_view name = next_field(line, pos);
+      chunk.paths.push_back(gfa_path{name, next_field(line, pos)});
+    }
+    else {
+      std::size_t src = to_id(next_field(line, pos));
+      pgt::or_t src_o = to_or(next_field(line, pos));
+      std::size_t snk = to_id(next_field(line, pos));
+      pgt::or_t snk_o = to_or(next_field(line, pos));
+      chunk.edges.push_back(std::make_tuple(src, src_o, snk, snk_o));
+    }
+  }
+}
 
-  /*
-    add nodes
-    ---------
+/**
+ * @brief split the mapped file at newline boundaries and scan each chunk in its
+ * own thread
+ *
+ * chunks are returned in file order so that merging them front to back gives
+ * the same vertex and edge order as a single threaded scan
+ */
+std::vector<gfa_chunk> scan_chunks(const mmapped_gfa& gfa, bool keep_labels, bool keep_paths,
+                                   const core::config& app_config, std::size_t min_chunk_size) {
+  std::string fn_name { std::format("[povu::io::{}]", __func__) };
 
-  */
+  auto t0 = pt::Time::now();
 
-  for (std::size_t v_id : v_ids) { g.add_vertex(v_id); }
+  std::size_t chunk_count = std::max<std::size_t>(
+    1, std::min<std::size_t>(app_config.thread_count(), gfa.size / std::max<std::size_t>(1, min_chunk_size)));
 
+  // chunk boundaries, each chunk except the first starts just after a newline
+  std::vector<const char*> bounds { gfa.begin() };
+  for (std::size_t i{1}; i < chunk_count; ++i) {
+    const char* p = std::max(gfa.begin() + (i * gfa.size / chunk_count), bounds.back());
+    const char* nl = static_cast<const char*>(std::memchr(p, '\n', gfa.end() - p));
+    bounds.push_back(nl == nullptr ? gfa.end() : nl + 1);
+  }
+  bounds.push_back(gfa.end());
 
-  /*
-    add edges
-    ---------
+  std::vector<gfa_chunk> chunks(chunk_count);
 
-  */
+  if (chunk_count == 1) {
+    scan_records(gfa.begin(), gfa.end(), keep_labels, keep_paths, chunks.front());
+  }
+  else {
+    // an exception escaping a thread would terminate, hand it back instead
+    std::vector<std::exception_ptr> errors(chunk_count);
+    std::vector<std::thread> threads;
+    threads.reserve(chunk_count);
+
+    for (std::size_t i{}; i < chunk_count; ++i) {
+      threads.emplace_back([&, i] {
+        try { scan_records(bounds[i], bounds[i + 1], keep_labels, keep_paths, chunks[i]); }
+        catch (...) { errors[i] = std::current_exception(); }
+      });
+    }
 
-  for (auto [src, src_or, snk, snk_or] : edges) {
+    for (auto& thread : threads) { thread.join(); }
+    for (auto& e : errors) { if (e) { std::rethrow_exception(e); } }
+  }
 
-    if (src == snk) {
-      if (src_or == snk_or) {
-        g.add_edge(src, pgt::VertexEnd::l, src, pgt::VertexEnd::r);
-      }
+  if (app_config.verbosity() > 1) {
+    std::chrono::duration<double> period = pt::Time::now() - t0;
+    double mb = static_cast<double>(gfa.size) / (1024 * 1024);
+    std::cerr << std::format("{} INFO Scanned {:.2f} MB in {:.2f} sec ({:.2f} MB/s) across {} chunk(s)\n",
+                             fn_name, mb, period.count(), mb / period.count(), chunk_count);
+  }
 
-      if (src_or != snk_or) {
-        std::cerr << std::format("{} invalid self loop\n", fn_name);
-      }
-      continue;
-    }
+  return chunks;
+}
 
-    auto v1_end = src_or == pgt::or_t::forward ? pgt::v_end::r : pgt::v_end::l;
-    auto v2_end = snk_or == pgt::or_t::forward ? pgt::v_end::l : pgt::v_end::r;
 
-    g.add_edge(src, v1_end, snk, v2_end);
-  }
+/*
+  Graph construction
+  ------------------
 
-  // populate tips
-  // -------------
+  shared by the GFA and the pvg loaders
+*/
+
+void populate_tips(povu::graph::Graph& g, const core::config& app_config) {
+  std::string fn_name { std::format("[povu::io::{}]", __func__) };
 
   for (std::size_t v_idx {}; v_idx < g.size(); ++v_idx) {
     const Vertex& v = g.get_vertex_by_idx(v_idx);
     std::size_t v_id = v.id();
-    if (v.get_edges_l().empty() && v.get_edges_r().empty()) {
+    bool no_l = g.get_edges_l(v_idx).empty();
+    bool no_r = g.get_edges_r(v_idx).empty();
+    if (no_l && no_r) {
       if (app_config.verbosity() > 3) {
         std::cerr << std::format(" {} WARN isolated node {} \n", fn_name, v.id());
       }
 
       g.add_tip(v_id, pgt::VertexEnd::l);
     }
-    else if (v.get_edges_l().empty()) { g.add_tip(v_id, pgt::v_end::l); }
-    else if (v.get_edges_r().empty()) { g.add_tip(v_id, pgt::v_end::r); }
+    else if (no_l) { g.add_tip(v_id, pgt::v_end::l); }
+    else if (no_r) { g.add_tip(v_id, pgt::v_end::r); }
   }
+}
 
-  return g;
+void populate_tips(bd::VG& vg) {
+  std::string fn_name { std::format("[povu::io::{}]", __func__) };
+
+  for (std::size_t v_idx{}; v_idx < vg.size(); ++v_idx) {
+    const bd::Vertex &v = vg.get_vertex(v_idx);
+    bool no_l = vg.get_edges_l(v_idx).empty();
+    bool no_r = vg.get_edges_r(v_idx).empty();
+    if (no_l && no_r) {
+      std::cerr << std::format(" {} WARN isolated node {} \n", fn_name, v.get_name());
+      vg.add_tip(v_idx, pgt::VertexEnd::l);
+    }
+    else if (no_l) { vg.add_tip(v_idx, pgt::v_end::l); }
+    else if (no_l) { vg.add_tip(v_idx, pgt::v_end::r); }
+  }
+}
+
+void add_path(bd::VG& vg, const std::string& name, const std::vector<pgt::id_n_orientation_t>& raw_path) {
+  if (raw_path.empty()) { return; }
+
+  bool is_circular = raw_path.front().v_idx == raw_path.back().v_idx;
+  handlegraph::path_handle_t p_h = vg.create_path_handle(name, is_circular);
+  std::size_t path_id = std::stoll(p_h.data);
+
+  pgt::side_n_id_t path_start = pgt::side_n_id_t{
+    raw_path.front().orientation == pgt::orientation_t::forward ? pgt::v_end::l : pgt::v_end::r,
+    raw_path.front().v_idx };
+
+  pgt::side_n_id_t path_end = pgt::side_n_id_t { pgt::v_end::r, raw_path.back().v_idx };
+
+  // do we need this?
+  vg.add_haplotype_start_node(path_start);
+  vg.add_haplotype_stop_node(path_end);
+
+  std::size_t path_pos { 1 }; // the position of a base in a reference path
+
+  for (std::size_t i{}; i < raw_path.size(); ++i) {
+
+    /*
+      color the edge
+      ...............
+    */
+    if (i+1 < raw_path.size()) {
+      bd::Edge &e = vg.get_edge_mut(raw_path[i], raw_path[i+1]);
+      e.add_ref(path_id);
+    }
+
+    /*
+      color the vertex
+      ................
+    */
+
+    /*
+      this can be done through handleGraph's append_step but this is
+      preferable in my because it also sets the step value which is
+      usable for variant calling
+    */
+    bd::Vertex& v = vg.get_vertex_mut(raw_path[i].v_idx);
+    v.add_path(path_id, path_pos);
+
+    path_pos += v.get_label_length();
+  }
 }
 
 
 /**
- * Count the number of lines of each type in a GFA file.
+ * To a variation graph represented as a bidirected graph
+ *
  *
- * @param[in] filename The GFA file to read.
- * @return A map from line type to number of lines of that type.
+ *
+ * @param [in] filename The GFA file to read
+ * @return A VariationGraph object from the GFA file
  */
-void gfa_line_counts(const char* filename, std::map<char, uint64_t>& line_counts) {
-  int gfa_fd = -1;
-  char* gfa_buf = nullptr;
-  std::size_t gfa_filesize = gfak::mmap_open(filename, gfa_buf, gfa_fd);
-  if (gfa_fd == -1) {
-    std::cerr << "Couldn't open GFA file " << filename << "." << std::endl;
-    exit(1);
+povu::graph::Graph to_pv_graph(const char* filename, const core::config& app_config, std::size_t min_chunk_size) {
+  std::string fn_name { std::format("[povu::io::{}]", __func__) };
+
+  std::vector<gfa_chunk> chunks;
+  {
+    mmapped_gfa gfa(filename);
+    chunks = scan_chunks(gfa, false, false, app_config, min_chunk_size);
   }
 
-  for (std::size_t i{}; i < gfa_filesize; ++i) {
-    if (i == 0 || gfa_buf[i-1] == '\n') { line_counts[gfa_buf[i]]++; }
-    //if (gfa_buf[i] == 'S' || gfa_buf[i] == 'L' || gfa_buf[i] == 'P') {
-    //  line_counts[gfa_buf[i]]++;
-    //}
+  std::size_t v_count {}, e_count {};
+  for (const gfa_chunk& c : chunks) {
+    v_count += c.v_ids.size();
+    e_count += c.edges.size();
   }
 
-  //std::size_t i {};
-  //while (i < gfa_filesize) {
-  //  if (i == 0 || gfa_buf[i-1] == '\n') { line_counts[gfa_buf[i]]++; }
-  //  ++i;
-  //}
-  gfak::mmap_close(gfa_buf, gfa_fd, gfa_filesize);
-  //return counts;
+  pg::Graph g(v_count, e_count);
+
+
+  /*
+    add nodes
+    ---------
+
+  */
+
+  for (const gfa_chunk& c : chunks) {
+    for (std::size_t v_id : c.v_ids) { g.add_vertex(v_id); }
+  }
+
+
+  /*
+    add edges
+    ---------
+
+  */
+
+  for (const gfa_chunk& c : chunks) {
+    for (const gfa_link& link : c.edges) {
+      auto [src, src_or, snk, snk_or] = link;
+
+      try {
+        if (src == snk) {
+          if (src_or == snk_or) {
+            g.add_edge(src, pgt::VertexEnd::l, src, pgt::VertexEnd::r);
+          }
+
+          if (src_or != snk_or) {
+            std::cerr << std::format("{} invalid self loop\n", fn_name);
+          }
+          continue;
+        }
+
+        auto v1_end = src_or == pgt::or_t::forward ? pgt::v_end::r : pgt::v_end::l;
+        auto v2_end = snk_or == pgt::or_t::forward ? pgt::v_end::l : pgt::v_end::r;
+
+        g.add_edge(src, v1_end, snk, v2_end);
+      }
+      catch (const std::invalid_argument& e) {
+        throw std::invalid_argument(std::format("{} {} names a segment that has no S line: {}",
+                                                fn_name, link_str(link), e.what()));
+      }
+    }
+  }
+
+  g.freeze();
+  populate_tips(g, app_config);
+
+  return g;
 }
 
 
@@ -217,127 +450,95 @@ void handle_self_loop(bd::VG &vg, id_t v_id, bool src_f, bool snk_f) {
  * @param [in] filename The GFA file to read
  * @return A VariationGraph object from the GFA file
  */
-bd::VG to_bd(const char* filename, const core::config& app_config) {
+bd::VG to_bd(const char* filename, const core::config& app_config, std::size_t min_chunk_size) {
   std::string fn_name { std::format("[povu::io::{}]", __func__) };
 
   //#ifdef DEBUG
   //if (app_config.verbosity() > 2) { std::cout << fn_name << std::endl; }
   //#endif
 
-  gfak::GFAKluge gg = gfak::GFAKluge();
-
-  gg.parse_gfa_file(filename);
+  auto t0 = pt::Time::now();
 
   /*
-    Preprocess the GFA
-    ------------------
+    Stage the GFA
+    -------------
 
-    scan over the file to count edges and sequences in parallel
+    a single pass over the file, in parallel chunks, stages the S, L and P
+    records. Links and paths may refer to segments that come later in the file
+    so they are only resolved once every segment is known.
   */
-  std::map<char, uint64_t> line_counts;
-  gfa_line_counts(filename, line_counts);
+  bool keep_paths = app_config.get_task() == core::task_t::call || app_config.get_task() == core::task_t::index;
 
-  //std::cout << "min_id: " << min_id << " max_id: " << max_id << std::endl;
+  mmapped_gfa gfa(filename);
+  std::vector<gfa_chunk> chunks = scan_chunks(gfa, true, keep_paths, app_config, min_chunk_size);
 
-  std::size_t node_count = line_counts['S'];
-  std::size_t edge_count = line_counts['L'];
-  std::size_t path_count = line_counts['P'];
+  std::size_t node_count {}, edge_count {}, path_count {};
+  for (const gfa_chunk& c : chunks) {
+    node_count += c.v_ids.size();
+    edge_count += c.edges.size();
+    path_count += c.path_count;
+  }
 
   /*
     Build the digraph
     -----------------
 
   */
-  // compute max nodes by difference between max and min ids
-  //std::size_t max_nodes = max_id - min_id + 1;
 
   // the node count and max and min ids are not necessarily the same
   // this is based on ids and node count not being the same
   bd::VG vg(node_count, edge_count, path_count);
 
-  // we want to start counting from 0 so we have to have an offset_value which would subtruct from the min_id
-  // this is because the input graph is not guaranteed to start from 0
-  // so we have to make sure that the graph starts from 0 as is the digraph
-
-  //std::size_t offset_value = min_id;
-  //std::cout << "offset_value: " << offset_value << std::endl;
-
   /*
     add nodes
     ---------
 
   */
-  //std::size_t min_id{}; // offset value
-  std::size_t curr_id{};
-  {
-    gg.for_each_sequence_line_in_file(
-      filename,
-      [&](const gfak::sequence_elem& s) {
-        //curr_id = stoull(s.name);
-        vg.create_handle(s.sequence, stoull(s.name));
-        //min_id = std::min(min_id, curr_id);
-      });
+  for (const gfa_chunk& c : chunks) {
+    for (std::size_t i{}; i < c.v_ids.size(); ++i) {
+      vg.create_handle(c.labels[i], c.v_ids[i]);
+    }
   }
 
   assert(vg.size() == node_count);
 
-  //std::cout << "[io::gfa_to_vg]" << "Nodes added Graph size: " << vg.size() << std::endl;
-
   /*
     add edges
     ---------
 
   */
-  {
-    gg.for_each_edge_line_in_file(filename, [&](const gfak::edge_elem& e) {
-      if (e.source_name.empty()) return;
-
-      if (e.source_name == e.sink_name) {
-          handle_self_loop(
-            vg, stoll(e.source_name), e.source_orientation_forward, e.sink_orientation_forward);
-          return;
-      }
-
-      /*
-        The handlegraph create_edge method doesn't make sense in this case
-        because the edge is bidirected
-        and not the vertex itself so we don't return a handle to a vertex side
-        but rather a handle to a vertex
-        this would make more sense in the biedged graph
-      */
-      auto v1_end = e.source_orientation_forward ? pgt::v_end::r : pgt::v_end::l;
-      auto v2_end = e.sink_orientation_forward ? pgt::v_end::l : pgt::v_end::r;
-
-      //if (e.source_name == "94679" ) {
-      //std::cerr << "source " << e.source_name << v1_end << " (" << e.source_orientation_forward
-      //          << " sink " << e.sink_name << v2_end << " (" << e.sink_orientation_forward << "\n";
-      //}
+  for (const gfa_chunk& c : chunks) {
+    for (const gfa_link& link : c.edges) {
+      auto [src, src_or, snk, snk_or] = link;
+      bool src_f = src_or == pgt::or_t::forward;
+      bool snk_f = snk_or == pgt::or_t::forward;
+
+      try {
+        if (src == snk) {
+          handle_self_loop(vg, src, src_f, snk_f);
+          continue;
+        }
 
+        /*
+          The handlegraph create_edge method doesn't make sense in this case
+          because the edge is bidirected
+          and not the vertex itself so we don't return a handle to a vertex side
+          but rather a handle to a vertex
+          this would make more sense in the biedged graph
+        */
+        auto v1_end = src_f ? pgt::v_end::r : pgt::v_end::l;
+        auto v2_end = snk_f ? pgt::v_end::l : pgt::v_end::r;
 
-      vg.add_edge(stoll(e.source_name), v1_end, stoll(e.sink_name), v2_end);
-    });
+        vg.add_edge(src, v1_end, snk, v2_end);
+      }
+      catch (const std::invalid_argument& e) {
+        throw std::invalid_argument(std::format("{} {} names a segment that has no S line: {}",
+                                                fn_name, link_str(link), e.what()));
+      }
+    }
   }
 
-  //std::cout  << "[io::gfa_to_vg]" << "Edges added\n";
-
-
-  // TODO: use handles?
-  //std::map<std::string, std::size_t> path_id_map;
-
-  //std::vector<std::vector<std::pair<std::size_t, std::size_t>>> path_spans;
-
-
-  auto path_elem_idx_to_id_o = [&vg](const gfak::path_elem& path, std::size_t i) {
-    const std::string& s = path.segment_names[i];
-    std::size_t v_idx = vg.id_to_idx(std::stoull(s));
-    bool orientation = path.orientations[i];
-    pgt::orientation_t o = orientation ? pgt::orientation_t::forward : pgt::orientation_t::reverse;
-
-    pgt::id_n_orientation_t id_n_orientation = pgt::id_n_orientation_t{v_idx, o};
-    return id_n_orientation;
-  };
-
-  std::size_t path_pos {}; // the position of a base in a reference path
+  vg.freeze();
 
   /*
     add paths
@@ -345,80 +546,63 @@ bd::VG to_bd(const char* filename, const core::config& app_config) {
 
   */
   // do this by associating each node && edge with a reference/color
-  if (app_config.get_task() == core::task_t::call && path_count > 0) {
+  if (keep_paths && path_count > 0) {
     std::vector<std::vector<pgt::id_n_orientation_t>> raw_paths;
+    raw_paths.reserve(path_count);
+
     std::vector<pgt::id_n_orientation_t> raw_path;
 
     // for each reference path (P line) in the GFA file
-    gg.for_each_path_line_in_file(filename, [&](const gfak::path_elem& path) {
-      handlegraph::path_handle_t p_h =
-        vg.create_path_handle(path.name, *std::begin(path.segment_names) == *std::rbegin(path.segment_names));
-
-      path_pos = 1;
-
-      std::size_t s_v_idx = vg.id_to_idx(std::stoull(*std::begin(path.segment_names)));
-      pgt::side_n_id_t path_start = pgt::side_n_id_t{ path.orientations.front() ? pgt::v_end::l : pgt::v_end::r, s_v_idx};
+    for (const gfa_chunk& c : chunks) {
+      for (const gfa_path& path : c.paths) {
 
-      std::size_t e_v_idx = vg.id_to_idx(std::stoull(*std::rbegin(path.segment_names)));
-      pgt::side_n_id_t path_end = pgt::side_n_id_t { path.orientations.back() ? pgt::v_end::r : pgt::v_end::r, e_v_idx };
+        // resolve the steps e.g. 1+,2-,3+
+        for (std::size_t pos {}; pos < path.steps.size();) {
+          std::size_t comma = path.steps.find(',', pos);
+          if (comma == std::string_view::npos) { comma = path.steps.size(); }
 
-      // do we need this?
-      vg.add_haplotype_start_node(path_start);
-      vg.add_haplotype_stop_node(path_end);
+          std::string_view step = path.steps.substr(pos, comma - pos);
+          pos = comma + 1;
+          if (step.size() < 2) { continue; }
 
-      for (std::size_t i{}; i < path.segment_names.size(); ++i) {
+          std::size_t v_id = to_id(step.substr(0, step.size() - 1));
+          pgt::orientation_t o = step.back() == '+' ? pgt::orientation_t::forward : pgt::orientation_t::reverse;
 
-        pgt::id_n_orientation_t id_n_orientation = path_elem_idx_to_id_o(path, i);
+          std::size_t v_idx = vg.id_to_idx(v_id);
+          if (v_idx == pc::INVALID_IDX) {
+            throw std::invalid_argument(std::format("{} P {} step {} names segment {} which has no S line",
+                                                    fn_name, path.name, step, v_id));
+          }
 
-        raw_path.push_back(id_n_orientation);
-
-        /*
-          color the edge
-          ...............
-        */
-        if (i+1 < path.segment_names.size()) {
-          pgt::id_n_orientation_t id_n_orientation_next = path_elem_idx_to_id_o(path, i+1);
-          bd::Edge &e = vg.get_edge_mut(id_n_orientation, id_n_orientation_next);
-          e.add_ref(std::stoll(p_h.data));
+          raw_path.push_back(pgt::id_n_orientation_t{v_idx, o});
         }
 
-        /*
-          color the vertex
-          ................
-         */
-
-        /*
-          this can be done through handleGraph's append_step but this is
-          preferable in my because it also sets the step value which is
-          usable for variant calling
-        */
+        if (raw_path.empty()) { continue; }
 
-        bd::Vertex& v = vg.get_vertex_mut(id_n_orientation.v_idx);
-        v.add_path(std::stoll(p_h.data), path_pos);
+        // an index only keeps the steps, colouring is done when it is loaded
+        if (app_config.get_task() == core::task_t::index) {
+          vg.create_path_handle(std::string(path.name), raw_path.front().v_idx == raw_path.back().v_idx);
+        }
+        else {
+          add_path(vg, std::string(path.name), raw_path);
+        }
 
-        path_pos += v.get_label().length();
+        raw_paths.push_back(std::move(raw_path));
+        raw_path.clear();
       }
+    }
 
-      raw_paths.push_back(raw_path);
-      raw_path.clear();
-    });
-
-    vg.set_raw_paths(raw_paths);
+    vg.set_raw_paths(std::move(raw_paths));
   }
 
-  // populate tips
-  // -------------
+  chunks.clear();
 
-  for (std::size_t v_idx{}; v_idx < vg.size(); ++v_idx) {
-    const bd::Vertex &v = vg.get_vertex(v_idx);
-    if (v.get_edges_l().empty() && v.get_edges_r().empty()) {
-      std::cerr << std::format(" {} WARN isolated node {} \n", fn_name, v.get_name());
-      vg.add_tip(v_idx, pgt::VertexEnd::l);
-    }
-    else if (v.get_edges_l().empty()) { vg.add_tip(v_idx, pgt::v_end::l); }
-    else if (v.get_edges_l().empty()) { vg.add_tip(v_idx, pgt::v_end::r); }
+  if (app_config.verbosity() > 1) {
+    povu::utils::report_time(std::cerr, fn_name, "loading the GFA", pt::Time::now() - t0);
+    povu::utils::report_peak_rss(std::cerr, fn_name);
   }
 
+  populate_tips(vg);
 
   return vg;
 }
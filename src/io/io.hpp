@@ -2,7 +2,12 @@
 #define IO_HPP
 
 #include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <sstream>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "../cli/app.hpp"
@@ -15,10 +20,52 @@
 
 namespace io::from_gfa {
 namespace bd = povu::bidirected;
+namespace pgt = povu::graph_types;
+
+/**
+ * The file is scanned in newline aligned chunks, one per --threads, of at least
+ * min_chunk_size bytes, a file smaller than two chunks is scanned serially. The
+ * graph does not depend on the number of chunks.
+ */
+const std::size_t GFA_MIN_CHUNK_SIZE { 1 << 20 };
+povu::graph::Graph to_pv_graph(const char *filename, const core::config& app_config,
+                               std::size_t min_chunk_size = GFA_MIN_CHUNK_SIZE);
+bd::VariationGraph to_bd(const char* filename, const core::config& app_config,
+                         std::size_t min_chunk_size = GFA_MIN_CHUNK_SIZE);
+
+/**
+ * @brief mark the vertex sides that have no incident edges as tips
+ */
+void populate_tips(povu::graph::Graph& g, const core::config& app_config);
+void populate_tips(bd::VariationGraph& vg);
+
+/**
+ * @brief add a path and colour the vertices and edges along it
+ */
+void add_path(bd::VariationGraph& vg, const std::string& name, const std::vector<pgt::id_n_orientation_t>& raw_path);
+}; // namespace io::from_gfa
+
+/**
+ * pvg is a binary graph index of flat arrays. The file is memory mapped and
+ * checked once, the vertices, edges, tips and CSR adjacency of the graph are
+ * then filled in straight from the arrays. Only the labels are repacked into
+ * the sequence store.
+ *
+ * The readers throw std::invalid_argument on a truncated or corrupt file.
+ */
+namespace povu::io::pvg {
+namespace bd = povu::bidirected;
+
+/**
+ * @brief true if the file at fp starts with the pvg magic bytes
+ */
+bool is_pvg(const std::string& fp);
+
+void write_pvg(const bd::VariationGraph& vg, const std::string& fp, const core::config& app_config);
 
 povu::graph::Graph to_pv_graph(const char *filename, const core::config& app_config);
 bd::VariationGraph to_bd(const char* filename, const core::config& app_config);
-}; // namespace io::from_gfa
+} // namespace povu::io::pvg
 
 namespace povu::io::generic {
 namespace pgt = povu::graph_types;
@@ -42,12 +89,182 @@ namespace pvtr = povu::tree;
 namespace pgt = povu::graph_types;
 
 void write_bub(const pvtr::Tree<pgt::flubble>& bt, const std::string& base_name, const core::config& app_config);
+/**
+ * @brief write a flubble tree in the flb format to out
+ */
+void write_bub(const pvtr::Tree<pgt::flubble>& bt, std::ostream& out);
 /**
   * @brief Read a flb file but only return the canonical flubbles
  */
 std::vector<pgt::flubble> read_canonical_fl(const std::string& fp);
+/**
+ * @brief as above but from the flb text of a tree, name is used in errors
+ */
+std::vector<pgt::flubble> read_canonical_fl(std::string_view flb, const std::string& name);
+/**
+ * @brief read a whole flubble tree from a flb file
+ */
+pvtr::Tree<pgt::flubble> read_bub(const std::string& fp);
+/**
+ * @brief as above but from the flb text of a tree, name is used in errors
+ */
+pvtr::Tree<pgt::flubble> read_bub(std::string_view flb, const std::string& name);
 } // namespace povu::io::bub
 
+/**
+ * flf is a flubble forest in a single file, the flubble tree of each component
+ * is a block of flb text and an index at the end of the file says where each
+ * block is
+ */
+namespace povu::io::flf {
+namespace pvtr = povu::tree;
+namespace pgt = povu::graph_types;
+
+// the name of the forest file deconstruct writes into the output dir
+const std::string FOREST_FILE_NAME { "forest.flf" };
+
+struct entry {
+  std::uint64_t component_id;
+  std::uint64_t offset; // from the start of the file
+  std::uint64_t size;
+};
+
+/**
+ * @brief true if the file at fp starts with the flf magic bytes
+ */
+bool is_flf(const std::string& fp);
+
+/**
+ * @brief appends the flubble trees of components to an flf file
+ *
+ * The index is only written by close(), a file that was never closed is
+ * rejected by the reader. Not thread safe, meant to be owned by a single
+ * writer thread.
+ */
+class writer {
+  std::unique_ptr<char[]> buf_; // the stream buffer of out_
+  std::ofstream out_;
+  std::string fp_;
+  std::ostringstream block_;
+  std::vector<entry> index_;
+  std::uint64_t offset_ {};
+
+public:
+  explicit writer(const std::string& fp);
+  writer(const writer&) = delete;
+  writer& operator=(const writer&) = delete;
+
+  void add(const pvtr::Tree<pgt::flubble>& ft, std::size_t component_id);
+
+  // write the index and close the file
+  void close();
+};
+
+/**
+ * @brief a memory mapped flf file, the blocks can be read from several threads
+ * at once
+ */
+class reader {
+  char* buf_ { nullptr };
+  std::size_t size_ {};
+  const entry* index_ { nullptr }; // by component id
+  std::size_t count_ {};
+
+public:
+  /**
+   * @brief map the file and check its footer and index
+   *
+   * @throws std::invalid_argument if the file is truncated or an index entry
+   * points outside the blocks
+   */
+  explicit reader(const std::string& fp);
+  reader(const reader&) = delete;
+  reader& operator=(const reader&) = delete;
+  ~reader();
+
+  // the number of components in the forest
+  std::size_t size() const;
+  std::vector<std::size_t> component_ids() const;
+
+  /**
+   * @brief the flb text of the flubble tree of a component
+   *
+   * @throws std::out_of_range if the forest has no such component
+   */
+  std::string_view block(std::size_t component_id) const;
+
+  std::vector<pgt::flubble> read_canonical_fl(std::size_t component_id) const;
+};
+} // namespace povu::io::flf
+
+/**
+ * pft is a binary flubble forest, the trees are flat arrays that are memory
+ * mapped and read without any parsing
+ */
+namespace povu::io::pft {
+namespace pvtr = povu::tree;
+namespace pgt = povu::graph_types;
+
+/**
+ * @brief true if the file at fp starts with the pft magic bytes
+ */
+bool is_pft(const std::string& fp);
+
+/**
+ * @brief write a forest, trees[i] is the flubble tree of component component_ids[i]
+ * so the two must be the same size
+ */
+void write_pft(const std::vector<pvtr::Tree<pgt::flubble>>& trees, const std::vector<std::size_t>& component_ids,
+               const std::string& fp, const core::config& app_config);
+
+class pft_view;
+
+/**
+ * @brief a memory mapped pft file
+ */
+class reader {
+  std::unique_ptr<pft_view> v_;
+
+public:
+  /**
+   * @brief map the file and check its arrays
+   *
+   * @throws std::invalid_argument if the file is truncated or an offset, a
+   * vertex index or the canonical bitmap is out of range
+   */
+  explicit reader(const std::string& fp);
+  reader(const reader&) = delete;
+  reader& operator=(const reader&) = delete;
+  ~reader();
+
+  // the number of trees in the forest
+  std::size_t size() const;
+  std::size_t component_id(std::size_t t) const;
+
+  // rebuild tree t
+  pvtr::Tree<pgt::flubble> tree(std::size_t t) const;
+
+  // the leaves that are flubbles, of every tree in the forest
+  std::size_t canonical_count() const;
+  std::vector<pgt::flubble> canonical_fl() const;
+};
+} // namespace povu::io::pft
+
+namespace povu::io::forest {
+namespace pgt = povu::graph_types;
+
+/**
+ * @brief read the canonical flubbles of the forest in the forest dir
+ *
+ * The forest is either a pft or flf file, given or a forest.flf in the forest
+ * dir, or a .flb file per component. The files or the trees of a forest file
+ * are read on --threads threads, each into a vector of its own so the order is
+ * that of reading them one after the other. A flubble that is in more than one
+ * of them is only kept the first time.
+ */
+std::vector<pgt::flubble> read_canonical_fl(const core::config& app_config);
+} // namespace povu::io::forest
+
 namespace povu::io::vcf {
 using povu::genomics::vcf::vcf_record;
 
@@ -0,0 +1,336 @@
+#include <bit>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+#include "./io.hpp"
+
+namespace povu::io::pft {
+
+/*
+  pft layout
+  ----------
+
+  a fixed header followed by flat arrays, each starting on an 8 byte boundary
+  and all integers in host byte order. The vertices of a tree are numbered from
+  0, its root, as in the flb format.
+
+    component_ids  [tree_count]                u64
+    tree_offsets   [tree_count + 1]            u64 first vertex of each tree
+    parents        [vertex_count]              u64 within the tree, NONE for a
+                                               root
+    child_offsets  [vertex_count + 1]          u64 into children
+    children       [child_count]               u64 within the tree
+    boundaries     [vertex_count]              pft_flubble, NONE for a vertex
+                                               with no flubble
+    canonical      [(vertex_count + 63) / 64]  u64 bitmap of the leaves that are
+                                               flubbles
+
+  a boundary is packed as vertex id << 1 | reverse
+*/
+
+const char MAGIC[8] = { 'P', 'O', 'V', 'U', 'P', 'F', 'T', '\0' };
+const std::uint64_t VERSION { 1 };
+const std::uint64_t NONE { ~std::uint64_t{0} };
+
+struct pft_header {
+  char magic[8];
+  std::uint64_t version;
+  std::uint64_t tree_count;
+  std::uint64_t vertex_count;
+  std::uint64_t child_count;
+  std::uint64_t canonical_count;
+};
+
+struct pft_flubble {
+  std::uint64_t start;
+  std::uint64_t end;
+};
+
+inline std::uint64_t aligned(std::uint64_t n) { return (n + 7) & ~std::uint64_t{7}; }
+inline std::uint64_t bitmap_words(std::uint64_t n) { return (n + 63) / 64; }
+
+/**
+ * @brief a memory mapped pft file with pointers to each of its arrays
+ */
+class pft_view {
+  char* buf_ { nullptr };
+  std::size_t size_ {};
+
+public:
+  const pft_header* h { nullptr };
+  const std::uint64_t* component_ids { nullptr };
+  const std::uint64_t* tree_offsets { nullptr };
+  const std::uint64_t* parents { nullptr };
+  const std::uint64_t* child_offsets { nullptr };
+  const std::uint64_t* children { nullptr };
+  const pft_flubble* boundaries { nullptr };
+  const std::uint64_t* canonical { nullptr };
+
+  explicit pft_view(const std::string& fp) {
+    std::string fn_name { std::format("[povu::io::pft::{}]", __func__) };
+
+    int fd = ::open(fp.c_str(), O_RDONLY);
+    if (fd == -1) {
+      std::cerr << std::format("{} Couldn't open pft file {}.\n", fn_name, fp);
+      exit(1);
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) == -1) {
+      ::close(fd);
+      throw std::invalid_argument(std::format("{} Couldn't stat pft file {}", fn_name, fp));
+    }
+    this->size_ = st.st_size;
+
+    if (this->size_ < sizeof(pft_header)) {
+      ::close(fd);
+      throw std::invalid_argument(std::format("{} {} is too small to be a pft file", fn_name, fp));
+    }
+
+    void* m = mmap(nullptr, this->size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (m == MAP_FAILED) {
+      std::cerr << std::format("{} Couldn't mmap pft file {}.\n", fn_name, fp);
+      exit(1);
+    }
+    this->buf_ = static_cast<char*>(m);
+
+    // the destructor doesn't run if the constructor throws
+    try {
+      this->h = reinterpret_cast<const pft_header*>(this->buf_);
+      if (std::memcmp(this->h->magic, MAGIC, sizeof(MAGIC)) != 0 || this->h->version != VERSION) {
+        throw std::invalid_argument(std::format("{} {} is not a version {} pft file", fn_name, fp, VERSION));
+      }
+
+      std::uint64_t off { aligned(sizeof(pft_header)) };
+      auto take = [&](std::uint64_t bytes) {
+        const char* p = this->buf_ + off;
+        off += aligned(bytes);
+        return p;
+      };
+
+      // every count is bounded by the file size so the sizes below can't overflow
+      const pft_header& hd = *this->h;
+      for (std::uint64_t n : { hd.tree_count, hd.vertex_count, hd.child_count, hd.canonical_count }) {
+        if (n > this->size_) {
+          throw std::invalid_argument(std::format("{} {} is truncated", fn_name, fp));
+        }
+      }
+
+      this->component_ids = reinterpret_cast<const std::uint64_t*>(take(hd.tree_count * 8));
+      this->tree_offsets = reinterpret_cast<const std::uint64_t*>(take((hd.tree_count + 1) * 8));
+      this->parents = reinterpret_cast<const std::uint64_t*>(take(hd.vertex_count * 8));
+      this->child_offsets = reinterpret_cast<const std::uint64_t*>(take((hd.vertex_count + 1) * 8));
+      this->children = reinterpret_cast<const std::uint64_t*>(take(hd.child_count * 8));
+      this->boundaries = reinterpret_cast<const pft_flubble*>(take(hd.vertex_count * sizeof(pft_flubble)));
+      this->canonical = reinterpret_cast<const std::uint64_t*>(take(bitmap_words(hd.vertex_count) * 8));
+
+      if (off > this->size_) {
+        throw std::invalid_argument(std::format("{} {} is truncated", fn_name, fp));
+      }
+
+      this->validate(fp);
+    }
+    catch (...) {
+      munmap(this->buf_, this->size_);
+      throw;
+    }
+  }
+
+  /**
+   * @brief check the offsets, the tree indexes and the canonical bitmap
+   * against the counts in the header so that rebuilding a tree can't go out
+   * of bounds
+   *
+   * @throws std::invalid_argument naming the first array that is off
+   */
+  void validate(const std::string& fp) const {
+    std::string fn_name { std::format("[povu::io::pft::{}]", __func__) };
+    const pft_header& hd = *this->h;
+
+    auto fail = [&](const std::string& what) {
+      throw std::invalid_argument(std::format("{} {} is corrupt: {}", fn_name, fp, what));
+    };
+
+    // offsets into an array of size n start at 0, never decrease and end at n
+    auto check_offsets = [&](const std::uint64_t* off, std::uint64_t count, std::uint64_t n, const std::string& what) {
+      if (off[0] != 0 || off[count] != n) { fail(std::format("{} do not span {} entries", what, n)); }
+      for (std::uint64_t i {}; i < count; ++i) {
+        if (off[i] > off[i + 1]) { fail(std::format("{} decrease at {}", what, i)); }
+      }
+    };
+
+    check_offsets(this->tree_offsets, hd.tree_count, hd.vertex_count, "tree offsets");
+    check_offsets(this->child_offsets, hd.vertex_count, hd.child_count, "child offsets");
+
+    // parents and children are indexes within their tree
+    for (std::uint64_t t {}; t < hd.tree_count; ++t) {
+      const std::uint64_t first = this->tree_offsets[t];
+      const std::uint64_t n = this->tree_offsets[t + 1] - first;
+
+      for (std::uint64_t v { first }; v < first + n; ++v) {
+        if (this->parents[v] != NONE && this->parents[v] >= n) { fail(std::format("parent of vertex {} is out of range", v)); }
+        for (std::uint64_t i { this->child_offsets[v] }; i < this->child_offsets[v + 1]; ++i) {
+          if (this->children[i] >= n) { fail(std::format("child {} is out of range", i)); }
+        }
+      }
+    }
+
+    // only vertices with a flubble are canonical and there are canonical_count of them
+    std::uint64_t canonical_count {};
+    for (std::uint64_t w {}; w < bitmap_words(hd.vertex_count); ++w) {
+      for (std::uint64_t bits { this->canonical[w] }; bits != 0; bits &= bits - 1) {
+        std::uint64_t v = w * 64 + std::countr_zero(bits);
+        if (v >= hd.vertex_count) { fail(std::format("canonical bit {} is past the last vertex", v)); }
+        if (this->boundaries[v].start == NONE) { fail(std::format("canonical vertex {} has no flubble", v)); }
+        ++canonical_count;
+      }
+    }
+    if (canonical_count != hd.canonical_count) {
+      fail(std::format("{} canonical bits set, the header says {}", canonical_count, hd.canonical_count));
+    }
+  }
+
+  pft_view(const pft_view&) = delete;
+  pft_view& operator=(const pft_view&) = delete;
+
+  ~pft_view() { if (this->buf_ != nullptr) { munmap(this->buf_, this->size_); } }
+};
+
+
+bool is_pft(const std::string& fp) {
+  std::ifstream f(fp, std::ios::binary);
+  char magic[sizeof(MAGIC)] {};
+  return f.read(magic, sizeof(magic)) && std::memcmp(magic, MAGIC, sizeof(MAGIC)) == 0;
+}
+
+
+void write_pft(const std::vector<pvtr::Tree<pgt::flubble>>& trees, const std::vector<std::size_t>& component_ids,
+               const std::string& fp, const core::config& app_config) {
+  std::string fn_name { std::format("[povu::io::pft::{}]", __func__) };
+  assert(trees.size() == component_ids.size());
+
+  pft_header hd {};
+  std::memcpy(hd.magic, MAGIC, sizeof(MAGIC));
+  hd.version = VERSION;
+  hd.tree_count = trees.size();
+
+  std::vector<std::uint64_t> tree_offsets { 0 }, parents, child_offsets { 0 }, children, canonical;
+  std::vector<pft_flubble> boundaries;
+
+  for (const pvtr::Tree<pgt::flubble>& t : trees) {
+    for (std::size_t v {}; v < t.size(); ++v) {
+      parents.push_back(v == t.root_idx() ? NONE : t.get_parent_idx(v));
+
+      if (!t.is_leaf(v)) {
+        const std::vector<std::size_t>& c = t.get_children(v);
+        children.insert(children.end(), c.begin(), c.end());
+      }
+      child_offsets.push_back(children.size());
+
+      std::optional<pgt::flubble> data = t.get_vertex(v).get_data();
+      boundaries.push_back(data ? pft_flubble{ pgt::pack(data->start_), pgt::pack(data->end_) } : pft_flubble{ NONE, NONE });
+
+      std::size_t i = boundaries.size() - 1;
+      if (i / 64 == canonical.size()) { canonical.push_back(0); }
+      if (data && t.is_leaf(v)) {
+        canonical[i / 64] |= std::uint64_t{1} << (i % 64);
+        ++hd.canonical_count;
+      }
+    }
+    tree_offsets.push_back(boundaries.size());
+  }
+
+  hd.vertex_count = boundaries.size();
+  hd.child_count = children.size();
+
+  std::vector<std::uint64_t> ids(component_ids.begin(), component_ids.end());
+
+  std::ofstream out(fp, std::ios::binary);
+  if (!out) { FILE_ERROR(fp); }
+
+  auto put = [&out](const void* data, std::uint64_t bytes) {
+    static const char pad[8] {};
+    out.write(static_cast<const char*>(data), bytes);
+    out.write(pad, aligned(bytes) - bytes);
+  };
+
+  put(&hd, sizeof(hd));
+  put(ids.data(), ids.size() * 8);
+  put(tree_offsets.data(), tree_offsets.size() * 8);
+  put(parents.data(), parents.size() * 8);
+  put(child_offsets.data(), child_offsets.size() * 8);
+  put(children.data(), children.size() * 8);
+  put(boundaries.data(), boundaries.size() * sizeof(pft_flubble));
+  put(canonical.data(), canonical.size() * 8);
+
+  if (app_config.verbosity() > 1) {
+    std::cerr << std::format("{} INFO Wrote {} trees with {} canonical flubbles to {}\n",
+                             fn_name, hd.tree_count, hd.canonical_count, fp);
+  }
+}
+
+
+/*
+  reader
+  ------
+ */
+
+reader::reader(const std::string& fp) : v_(std::make_unique<pft_view>(fp)) {}
+reader::~reader() = default;
+
+std::size_t reader::size() const { return this->v_->h->tree_count; }
+std::size_t reader::component_id(std::size_t t) const { return this->v_->component_ids[t]; }
+std::size_t reader::canonical_count() const { return this->v_->h->canonical_count; }
+
+pvtr::Tree<pgt::flubble> reader::tree(std::size_t t) const {
+  const pft_view& pft = *this->v_;
+  std::uint64_t first = pft.tree_offsets[t];
+  std::uint64_t n = pft.tree_offsets[t + 1] - first;
+
+  pvtr::Tree<pgt::flubble> ft(n);
+
+  for (std::uint64_t v {}; v < n; ++v) {
+    const pft_flubble& b = pft.boundaries[first + v];
+    if (v > 0) {
+      ft.add_vertex(b.start == NONE ? pvtr::Vertex<pgt::flubble>(v)
+                                    : pvtr::Vertex<pgt::flubble>(v, pgt::flubble(pgt::unpack(b.start), pgt::unpack(b.end))));
+    }
+
+    for (std::uint64_t i { pft.child_offsets[first + v] }; i < pft.child_offsets[first + v + 1]; ++i) {
+      ft.add_edge(v, pft.children[i]);
+    }
+  }
+
+  return ft;
+}
+
+std::vector<pgt::flubble> reader::canonical_fl() const {
+  const pft_view& pft = *this->v_;
+
+  std::vector<pgt::flubble> canonical_fl;
+  canonical_fl.reserve(pft.h->canonical_count);
+
+  for (std::uint64_t w {}; w < bitmap_words(pft.h->vertex_count); ++w) {
+    for (std::uint64_t bits { pft.canonical[w] }; bits != 0; bits &= bits - 1) {
+      const pft_flubble& b = pft.boundaries[w * 64 + std::countr_zero(bits)];
+      canonical_fl.emplace_back(pgt::unpack(b.start), pgt::unpack(b.end));
+    }
+  }
+
+  return canonical_fl;
+}
+
+} // namespace povu::io::pft
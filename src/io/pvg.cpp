@@ -0,0 +1,463 @@
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <tuple>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+#include "./io.hpp"
+
+namespace povu::io::pvg {
+namespace bd = povu::bidirected;
+namespace pg = povu::graph;
+namespace pgt = povu::graph_types;
+namespace pt = povu::types;
+namespace pss = povu::seq_store;
+
+/*
+  pvg layout
+  ----------
+
+  a fixed header followed by flat arrays, each starting on an 8 byte boundary
+  and all integers in host byte order
+
+    ids                [vertex_count]         u64 segment id of each vertex
+    seq_offsets        [vertex_count + 1]     u64 into seqs
+    edges              [edge_count]           pvg_edge
+    adj_offsets        [2 * vertex_count + 1] u64 into adj, left side of vertex
+                                              v at 2v and right side at 2v + 1
+    adj                [adj_count]            u64 edge index
+    tips               [tip_count]            pvg_tip
+    path_name_offsets  [path_count + 1]       u64 into names
+    path_step_offsets  [path_count + 1]       u64 into steps
+    steps              [step_count]           u64 vertex index << 1 | reverse
+    seqs               [seq_bytes]            concatenated vertex labels
+    names              [name_bytes]           concatenated path names
+*/
+
+const char MAGIC[8] = { 'P', 'O', 'V', 'U', 'P', 'V', 'G', '\0' };
+const std::uint64_t VERSION { 1 };
+
+struct pvg_header {
+  char magic[8];
+  std::uint64_t version;
+  std::uint64_t vertex_count;
+  std::uint64_t edge_count;
+  std::uint64_t adj_count;
+  std::uint64_t tip_count;
+  std::uint64_t path_count;
+  std::uint64_t step_count;
+  std::uint64_t seq_bytes;
+  std::uint64_t name_bytes;
+};
+
+struct pvg_edge {
+  std::uint64_t v1_idx;
+  std::uint64_t v2_idx;
+  std::uint32_t v1_end;
+  std::uint32_t v2_end;
+};
+
+struct pvg_tip {
+  std::uint64_t v_idx;
+  std::uint64_t v_end;
+};
+
+inline std::uint64_t aligned(std::uint64_t n) { return (n + 7) & ~std::uint64_t{7}; }
+
+inline std::uint32_t to_u32(pgt::v_end e) { return e == pgt::v_end::l ? 0 : 1; }
+inline pgt::v_end to_v_end(std::uint64_t e) { return e == 0 ? pgt::v_end::l : pgt::v_end::r; }
+
+/**
+ * @brief a memory mapped pvg file with pointers to each of its arrays
+ */
+class pvg_view {
+  char* buf_ { nullptr };
+  std::size_t size_ {};
+
+public:
+  const pvg_header* h { nullptr };
+  const std::uint64_t* ids { nullptr };
+  const std::uint64_t* seq_offsets { nullptr };
+  const pvg_edge* edges { nullptr };
+  const std::uint64_t* adj_offsets { nullptr };
+  const std::uint64_t* adj { nullptr };
+  const pvg_tip* tips { nullptr };
+  const std::uint64_t* path_name_offsets { nullptr };
+  const std::uint64_t* path_step_offsets { nullptr };
+  const std::uint64_t* steps { nullptr };
+  const char* seqs { nullptr };
+  const char* names { nullptr };
+
+  explicit pvg_view(const char* filename) {
+    std::string fn_name { std::format("[povu::io::pvg::{}]", __func__) };
+
+    int fd = ::open(filename, O_RDONLY);
+    if (fd == -1) {
+      std::cerr << std::format("{} Couldn't open pvg file {}.\n", fn_name, filename);
+      exit(1);
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) == -1) {
+      ::close(fd);
+      throw std::invalid_argument(std::format("{} Couldn't stat pvg file {}", fn_name, filename));
+    }
+    this->size_ = st.st_size;
+
+    if (this->size_ < sizeof(pvg_header)) {
+      ::close(fd);
+      throw std::invalid_argument(std::format("{} {} is too small to be a pvg file", fn_name, filename));
+    }
+
+    void* m = mmap(nullptr, this->size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (m == MAP_FAILED) {
+      std::cerr << std::format("{} Couldn't mmap pvg file {}.\n", fn_name, filename);
+      exit(1);
+    }
+    this->buf_ = static_cast<char*>(m);
+
+    // the destructor doesn't run if the constructor throws
+    try {
+      this->h = reinterpret_cast<const pvg_header*>(this->buf_);
+      if (std::memcmp(this->h->magic, MAGIC, sizeof(MAGIC)) != 0 || this->h->version != VERSION) {
+        throw std::invalid_argument(std::format("{} {} is not a version {} pvg file", fn_name, filename, VERSION));
+      }
+
+      std::uint64_t off { aligned(sizeof(pvg_header)) };
+      auto take = [&](std::uint64_t bytes) {
+        const char* p = this->buf_ + off;
+        off += aligned(bytes);
+        return p;
+      };
+
+      // every count is bounded by the file size so the sizes below can't overflow
+      const pvg_header& hd = *this->h;
+      for (std::uint64_t n : { hd.vertex_count, hd.edge_count, hd.adj_count, hd.tip_count, hd.path_count,
+                               hd.step_count, hd.seq_bytes, hd.name_bytes }) {
+        if (n > this->size_) {
+          throw std::invalid_argument(std::format("{} {} is truncated", fn_name, filename));
+        }
+      }
+
+      this->ids = reinterpret_cast<const std::uint64_t*>(take(hd.vertex_count * 8));
+      this->seq_offsets = reinterpret_cast<const std::uint64_t*>(take((hd.vertex_count + 1) * 8));
+      this->edges = reinterpret_cast<const pvg_edge*>(take(hd.edge_count * sizeof(pvg_edge)));
+      this->adj_offsets = reinterpret_cast<const std::uint64_t*>(take((2 * hd.vertex_count + 1) * 8));
+      this->adj = reinterpret_cast<const std::uint64_t*>(take(hd.adj_count * 8));
+      this->tips = reinterpret_cast<const pvg_tip*>(take(hd.tip_count * sizeof(pvg_tip)));
+      this->path_name_offsets = reinterpret_cast<const std::uint64_t*>(take((hd.path_count + 1) * 8));
+      this->path_step_offsets = reinterpret_cast<const std::uint64_t*>(take((hd.path_count + 1) * 8));
+      this->steps = reinterpret_cast<const std::uint64_t*>(take(hd.step_count * 8));
+      this->seqs = take(hd.seq_bytes);
+      this->names = take(hd.name_bytes);
+
+      if (off > this->size_) {
+        throw std::invalid_argument(std::format("{} {} is truncated", fn_name, filename));
+      }
+
+      this->validate(filename);
+    }
+    catch (...) {
+      munmap(this->buf_, this->size_);
+      throw;
+    }
+  }
+
+  /**
+   * @brief check every offset and index in the arrays against the counts in
+   * the header so that reading the graph out can't go out of bounds
+   *
+   * @throws std::invalid_argument naming the first array that is off
+   */
+  void validate(const char* filename) const {
+    std::string fn_name { std::format("[povu::io::pvg::{}]", __func__) };
+    const pvg_header& hd = *this->h;
+
+    auto fail = [&](const std::string& what) {
+      throw std::invalid_argument(std::format("{} {} is corrupt: {}", fn_name, filename, what));
+    };
+
+    // offsets into an array of size n start at 0, never decrease and end at n
+    auto check_offsets = [&](const std::uint64_t* off, std::uint64_t count, std::uint64_t n, const std::string& what) {
+      if (off[0] != 0 || off[count] != n) { fail(std::format("{} do not span {} entries", what, n)); }
+      for (std::uint64_t i {}; i < count; ++i) {
+        if (off[i] > off[i + 1]) { fail(std::format("{} decrease at {}", what, i)); }
+      }
+    };
+
+    check_offsets(this->seq_offsets, hd.vertex_count, hd.seq_bytes, "sequence offsets");
+    check_offsets(this->adj_offsets, 2 * hd.vertex_count, hd.adj_count, "adjacency offsets");
+    check_offsets(this->path_name_offsets, hd.path_count, hd.name_bytes, "path name offsets");
+    check_offsets(this->path_step_offsets, hd.path_count, hd.step_count, "path step offsets");
+
+    for (std::uint64_t e_idx {}; e_idx < hd.edge_count; ++e_idx) {
+      const pvg_edge& e = this->edges[e_idx];
+      if (e.v1_idx >= hd.vertex_count || e.v2_idx >= hd.vertex_count || e.v1_end > 1 || e.v2_end > 1) {
+        fail(std::format("edge {} is out of range", e_idx));
+      }
+    }
+
+    // each edge in the list of a side is incident with it
+    for (std::uint64_t side {}; side < 2 * hd.vertex_count; ++side) {
+      for (std::uint64_t i { this->adj_offsets[side] }; i < this->adj_offsets[side + 1]; ++i) {
+        if (this->adj[i] >= hd.edge_count) { fail(std::format("adjacency entry {} is out of range", i)); }
+        const pvg_edge& e = this->edges[this->adj[i]];
+        if (2 * e.v1_idx + e.v1_end != side && 2 * e.v2_idx + e.v2_end != side) {
+          fail(std::format("adjacency entry {} is not incident with side {}", i, side));
+        }
+      }
+    }
+
+    for (std::uint64_t i {}; i < hd.tip_count; ++i) {
+      if (this->tips[i].v_idx >= hd.vertex_count || this->tips[i].v_end > 1) {
+        fail(std::format("tip {} is out of range", i));
+      }
+    }
+
+    for (std::uint64_t i {}; i < hd.step_count; ++i) {
+      if ((this->steps[i] >> 1) >= hd.vertex_count) { fail(std::format("path step {} is out of range", i)); }
+    }
+  }
+
+  pvg_view(const pvg_view&) = delete;
+  pvg_view& operator=(const pvg_view&) = delete;
+
+  ~pvg_view() { if (this->buf_ != nullptr) { munmap(this->buf_, this->size_); } }
+
+  std::string_view label(std::size_t v_idx) const {
+    return std::string_view(this->seqs + this->seq_offsets[v_idx],
+                            this->seq_offsets[v_idx + 1] - this->seq_offsets[v_idx]);
+  }
+
+  std::string_view path_name(std::size_t p_idx) const {
+    return std::string_view(this->names + this->path_name_offsets[p_idx],
+                            this->path_name_offsets[p_idx + 1] - this->path_name_offsets[p_idx]);
+  }
+
+  /** @brief copy out the stored CSR adjacency so a graph can adopt it without rebuilding */
+  std::pair<std::vector<std::size_t>, std::vector<std::size_t>> csr() const {
+    return {
+      std::vector<std::size_t>(this->adj_offsets, this->adj_offsets + 2 * this->h->vertex_count + 1),
+      std::vector<std::size_t>(this->adj, this->adj + this->h->adj_count)
+    };
+  }
+};
+
+
+bool is_pvg(const std::string& fp) {
+  std::ifstream f(fp, std::ios::binary);
+  char magic[sizeof(MAGIC)] {};
+  return f.read(magic, sizeof(magic)) && std::memcmp(magic, MAGIC, sizeof(MAGIC)) == 0;
+}
+
+
+void write_pvg(const bd::VG& vg, const std::string& fp, const core::config& app_config) {
+  std::string fn_name { std::format("[povu::io::pvg::{}]", __func__) };
+
+  const std::vector<std::vector<pgt::id_n_orientation_t>>& raw_paths = vg.get_raw_paths();
+
+  pvg_header hd {};
+  std::memcpy(hd.magic, MAGIC, sizeof(MAGIC));
+  hd.version = VERSION;
+  hd.vertex_count = vg.size();
+  hd.edge_count = vg.get_edge_count();
+  hd.path_count = raw_paths.size();
+
+  std::vector<std::uint64_t> ids, seq_offsets { 0 }, adj_offsets { 0 }, adj;
+  std::vector<pvg_edge> edges;
+  std::vector<pvg_tip> tips;
+  std::vector<std::uint64_t> path_name_offsets { 0 }, path_step_offsets { 0 }, steps;
+  std::string seqs, names;
+
+  ids.reserve(hd.vertex_count);
+  seq_offsets.reserve(hd.vertex_count + 1);
+  adj_offsets.reserve(2 * hd.vertex_count + 1);
+
+  for (std::size_t v_idx {}; v_idx < vg.size(); ++v_idx) {
+    ids.push_back(vg.idx_to_id(v_idx));
+
+    vg.append_label(v_idx, pgt::orientation_t::forward, seqs);
+    seq_offsets.push_back(seqs.size());
+
+    std::span<const std::size_t> e_l = vg.get_edges_l(v_idx);
+    std::span<const std::size_t> e_r = vg.get_edges_r(v_idx);
+
+    adj.insert(adj.end(), e_l.begin(), e_l.end());
+    adj_offsets.push_back(adj.size());
+    adj.insert(adj.end(), e_r.begin(), e_r.end());
+    adj_offsets.push_back(adj.size());
+
+    // the tips of povu::graph::Graph, see io::from_gfa::populate_tips
+    if (e_l.empty()) { tips.push_back(pvg_tip{v_idx, to_u32(pgt::v_end::l)}); }
+    else if (e_r.empty()) { tips.push_back(pvg_tip{v_idx, to_u32(pgt::v_end::r)}); }
+  }
+
+  edges.reserve(hd.edge_count);
+  for (std::size_t e_idx {}; e_idx < vg.get_edge_count(); ++e_idx) {
+    const bd::Edge& e = vg.get_edge(e_idx);
+    edges.push_back(pvg_edge{e.get_v1_idx(), e.get_v2_idx(), to_u32(e.get_v1_end()), to_u32(e.get_v2_end())});
+  }
+
+  for (std::size_t p_idx {}; p_idx < raw_paths.size(); ++p_idx) {
+    names += vg.get_ref(p_idx).name;
+    path_name_offsets.push_back(names.size());
+
+    for (const pgt::id_n_orientation_t& s : raw_paths[p_idx]) {
+      steps.push_back(pgt::pack(s));
+    }
+    path_step_offsets.push_back(steps.size());
+  }
+
+  hd.adj_count = adj.size();
+  hd.tip_count = tips.size();
+  hd.step_count = steps.size();
+  hd.seq_bytes = seqs.size();
+  hd.name_bytes = names.size();
+
+  std::ofstream out(fp, std::ios::binary);
+  if (!out) { FILE_ERROR(fp); }
+
+  auto put = [&out](const void* data, std::uint64_t bytes) {
+    static const char pad[8] {};
+    out.write(static_cast<const char*>(data), bytes);
+    out.write(pad, aligned(bytes) - bytes);
+  };
+
+  put(&hd, sizeof(hd));
+  put(ids.data(), ids.size() * 8);
+  put(seq_offsets.data(), seq_offsets.size() * 8);
+  put(edges.data(), edges.size() * sizeof(pvg_edge));
+  put(adj_offsets.data(), adj_offsets.size() * 8);
+  put(adj.data(), adj.size() * 8);
+  put(tips.data(), tips.size() * sizeof(pvg_tip));
+  put(path_name_offsets.data(), path_name_offsets.size() * 8);
+  put(path_step_offsets.data(), path_step_offsets.size() * 8);
+  put(steps.data(), steps.size() * 8);
+  put(seqs.data(), seqs.size());
+  put(names.data(), names.size());
+
+  if (app_config.verbosity() > 1) {
+    std::cerr << std::format("{} INFO Wrote {} vertices, {} edges and {} paths to {}\n",
+                             fn_name, hd.vertex_count, hd.edge_count, hd.path_count, fp);
+  }
+}
+
+
+pg::Graph to_pv_graph(const char* filename, const core::config& app_config) {
+  std::string fn_name { std::format("[povu::io::pvg::{}]", __func__) };
+
+  auto t0 = pt::Time::now();
+
+  pvg_view pvg(filename);
+  const pvg_header& hd = *pvg.h;
+
+  // fill the store straight from the arrays, edges and tips are already indexes
+  auto s = std::make_shared<pg::graph_store>();
+
+  s->vertices.reserve(hd.vertex_count);
+  s->v_id_to_idx.reserve(hd.vertex_count);
+  for (std::size_t v_idx {}; v_idx < hd.vertex_count; ++v_idx) {
+    s->vertices.push_back(pg::Vertex{pvg.ids[v_idx]});
+    s->v_id_to_idx.insert(pvg.ids[v_idx], v_idx);
+  }
+
+  s->edges.reserve(hd.edge_count);
+  for (std::size_t e_idx {}; e_idx < hd.edge_count; ++e_idx) {
+    const pvg_edge& e = pvg.edges[e_idx];
+    s->edges.push_back(pg::Edge{e.v1_idx, to_v_end(e.v1_end), e.v2_idx, to_v_end(e.v2_end)});
+  }
+
+  std::tie(s->adj_off, s->adj) = pvg.csr();
+  s->frozen = true;
+
+  std::set<pgt::side_n_id_t> tips;
+  for (std::size_t i {}; i < hd.tip_count; ++i) {
+    tips.insert(pgt::side_n_id_t{to_v_end(pvg.tips[i].v_end), pvg.tips[i].v_idx});
+  }
+
+  pg::Graph g(std::move(s), 0, hd.vertex_count, 0, hd.edge_count, std::move(tips));
+
+  if (app_config.verbosity() > 1) {
+    povu::utils::report_time(std::cerr, fn_name, "loading the index", pt::Time::now() - t0);
+  }
+
+  return g;
+}
+
+
+bd::VG to_bd(const char* filename, const core::config& app_config) {
+  std::string fn_name { std::format("[povu::io::pvg::{}]", __func__) };
+
+  auto t0 = pt::Time::now();
+
+  pvg_view pvg(filename);
+  const pvg_header& hd = *pvg.h;
+
+  // the labels are packed into the sequence store, the rest is taken as is
+  auto seqs = std::make_shared<pss::SeqStore>();
+  seqs->reserve(hd.seq_bytes);
+
+  std::vector<bd::Vertex> vertices;
+  vertices.reserve(hd.vertex_count);
+  pt::IdMap id_to_idx;
+  id_to_idx.reserve(hd.vertex_count);
+  for (std::size_t v_idx {}; v_idx < hd.vertex_count; ++v_idx) {
+    std::string_view label = pvg.label(v_idx);
+    vertices.emplace_back(seqs->append(label), label.size(), pvg.ids[v_idx]);
+    id_to_idx.insert(pvg.ids[v_idx], v_idx);
+  }
+
+  std::vector<bd::Edge> edges;
+  edges.reserve(hd.edge_count);
+  for (std::size_t e_idx {}; e_idx < hd.edge_count; ++e_idx) {
+    const pvg_edge& e = pvg.edges[e_idx];
+    edges.emplace_back(e.v1_idx, to_v_end(e.v1_end), e.v2_idx, to_v_end(e.v2_end));
+  }
+
+  auto [adj_off, adj] = pvg.csr();
+  bd::VG vg(std::move(vertices), std::move(id_to_idx), std::move(edges), std::move(seqs),
+            std::move(adj_off), std::move(adj));
+
+  if (app_config.get_task() == core::task_t::call && hd.path_count > 0) {
+    std::vector<std::vector<pgt::id_n_orientation_t>> raw_paths;
+    raw_paths.reserve(hd.path_count);
+
+    for (std::size_t p_idx {}; p_idx < hd.path_count; ++p_idx) {
+      std::vector<pgt::id_n_orientation_t> raw_path;
+      raw_path.reserve(pvg.path_step_offsets[p_idx + 1] - pvg.path_step_offsets[p_idx]);
+
+      for (std::size_t i { pvg.path_step_offsets[p_idx] }; i < pvg.path_step_offsets[p_idx + 1]; ++i) {
+        raw_path.push_back(pgt::unpack(pvg.steps[i]));
+      }
+
+      ::io::from_gfa::add_path(vg, std::string(pvg.path_name(p_idx)), raw_path);
+      raw_paths.push_back(std::move(raw_path));
+    }
+
+    vg.set_raw_paths(std::move(raw_paths));
+  }
+
+  ::io::from_gfa::populate_tips(vg);
+
+  if (app_config.verbosity() > 1) {
+    povu::utils::report_time(std::cerr, fn_name, "loading the index", pt::Time::now() - t0);
+    povu::utils::report_peak_rss(std::cerr, fn_name);
+  }
+
+  return vg;
+}
+
+} // namespace povu::io::pvg
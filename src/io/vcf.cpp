@@ -25,11 +25,13 @@ namespace bd = povu::bidirected;
  */
 std::string path_to_seq(const bd::VariationGraph& bd_vg,
                         const std::vector<pgt::id_n_orientation_t>& p) {
-  std::string seq = "";
-  for (auto [id, orientation]: p) {
-    bd::Vertex const& v = bd_vg.get_vertex(id);
-    seq += orientation == pgt::orientation_t::forward ? v.get_label() : v.get_rc_label();
-  }
+  std::size_t len {};
+  for (auto [id, _]: p) { len += bd_vg.get_vertex(id).get_label_length(); }
+
+  // decode each label straight into the allele
+  std::string seq(len, '\0');
+  char* out = seq.data();
+  for (auto [id, orientation]: p) { out = bd_vg.decode_label(id, orientation, out); }
 
   return seq;
 }
@@ -1,12 +1,25 @@
+#include <algorithm>
+#include <atomic>
+#include <cctype>
 #include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <filesystem>
 #include <format>
+#include <fstream>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <optional>
 #include <string>
 #include <thread>
+#include <utility>
 #include <vector>
 
 #include "./cli/app.hpp"
 #include "./cli/cli.hpp"
+#include "./common/scheduler.hpp"
 #include "./common/types.hpp"
 #include "./common/utils.hpp"
 #include "./graph/graph.hpp"
@@ -17,6 +30,40 @@
 namespace bd = povu::bidirected;
 namespace pt = povu::types;
 namespace pgt = povu::graph_types;
+namespace pps = povu::scheduler;
+
+/**
+ * @brief read the input, a gfa or a pvg index, into a bidirected graph
+ */
+povu::graph::Graph read_pv_graph(const core::config &app_config) {
+  const std::string& fp = app_config.get_input_gfa();
+  return povu::io::pvg::is_pvg(fp) ? povu::io::pvg::to_pv_graph(fp.c_str(), app_config)
+                                   : io::from_gfa::to_pv_graph(fp.c_str(), app_config);
+}
+
+/**
+ * @brief read the input, a gfa or a pvg index, into a bidirected variation graph
+ */
+bd::VG read_bd(const core::config &app_config) {
+  const std::string& fp = app_config.get_input_gfa();
+  return povu::io::pvg::is_pvg(fp) ? povu::io::pvg::to_bd(fp.c_str(), app_config)
+                                   : io::from_gfa::to_bd(fp.c_str(), app_config);
+}
+
+
+void do_index(const core::config &app_config) {
+  std::string fn_name = std::format("[povu::main::{}]", __func__);
+
+  auto t0 = pt::Time::now();
+
+  bd::VG bd_vg = io::from_gfa::to_bd(app_config.get_input_gfa().c_str(), app_config);
+  povu::io::pvg::write_pvg(bd_vg, app_config.get_index_path().string(), app_config);
+
+  if (app_config.verbosity() > 1) {
+    povu::utils::report_time(std::cerr, fn_name, "index", pt::Time::now() - t0);
+  }
+}
+
 
 void do_info(const core::config &app_config) {
   std::string fn_name = std::format("[povu::main::{}]", __func__);
@@ -25,12 +72,98 @@ void do_info(const core::config &app_config) {
   // -----
   // read the input gfa into a bidirected variation graph
   // -----
-  povu::graph::Graph g = io::from_gfa::to_pv_graph(app_config.get_input_gfa().c_str(), app_config);
+  povu::graph::Graph g = read_pv_graph(app_config);
 
   g.summary();
 }
 
 
+/**
+ * @brief the component id in the name of a flb file written by deconstruct or
+ * fallback if there is none
+ */
+std::size_t flb_component_id(const std::filesystem::path& fp, std::size_t fallback) {
+  std::string stem = fp.stem().string();
+  bool numeric = !stem.empty() && std::all_of(stem.begin(), stem.end(), [](unsigned char c) { return std::isdigit(c); });
+  return numeric ? std::stoull(stem) : fallback;
+}
+
+/**
+ * @brief the .flb files of a forest dir ordered by component id
+ */
+std::vector<std::filesystem::path> flb_files(const std::string& dir) {
+  std::vector<std::filesystem::path> files = povu::io::generic::get_files(dir, ".flb");
+  std::sort(files.begin(), files.end(), [](const std::filesystem::path& a, const std::filesystem::path& b) {
+    return std::make_pair(flb_component_id(a, 0), a) < std::make_pair(flb_component_id(b, 0), b);
+  });
+  return files;
+}
+
+void do_convert(const core::config &app_config) {
+  std::string fn_name = std::format("[povu::main::{}]", __func__);
+
+  auto t0 = pt::Time::now();
+
+  const std::string in = app_config.get_forest_dir().string();
+  const std::filesystem::path out = app_config.get_convert_path();
+  bool is_file = std::filesystem::is_regular_file(in);
+
+  // -----
+  // pft to a flb file per tree
+  // -----
+  if (is_file && povu::io::pft::is_pft(in)) {
+    povu::io::pft::reader forest(in);
+    std::filesystem::create_directories(out);
+
+    for (std::size_t t {}; t < forest.size(); ++t) {
+      std::string fp = (out / std::format("{}.flb", forest.component_id(t))).string();
+      std::ofstream f(fp);
+      if (!f) {
+        std::cerr << "ERROR: could not open file " << fp << "\n";
+        std::exit(1);
+      }
+      povu::io::bub::write_bub(forest.tree(t), f);
+    }
+
+    if (app_config.verbosity() > 1) {
+      povu::utils::report_time(std::cerr, fn_name, std::format("converting {} trees to flb", forest.size()), pt::Time::now() - t0);
+    }
+    return;
+  }
+
+  // -----
+  // flb, a dir of them or flf to pft
+  // -----
+  std::vector<povu::tree::Tree<pgt::flubble>> trees;
+  std::vector<std::size_t> component_ids;
+
+  if (is_file && povu::io::flf::is_flf(in)) {
+    povu::io::flf::reader forest(in);
+    for (std::size_t component_id : forest.component_ids()) {
+      trees.push_back(povu::io::bub::read_bub(forest.block(component_id), std::format("component {}", component_id)));
+      component_ids.push_back(component_id);
+    }
+  }
+  else if (is_file) {
+    trees.push_back(povu::io::bub::read_bub(in));
+    component_ids.push_back(flb_component_id(in, 1));
+  }
+  else {
+    std::vector<std::filesystem::path> files = flb_files(in);
+    for (std::size_t i {}; i < files.size(); ++i) {
+      trees.push_back(povu::io::bub::read_bub(files[i].string()));
+      component_ids.push_back(flb_component_id(files[i], i + 1));
+    }
+  }
+
+  povu::io::pft::write_pft(trees, component_ids, out.string(), app_config);
+
+  if (app_config.verbosity() > 1) {
+    povu::utils::report_time(std::cerr, fn_name, "converting to pft", pt::Time::now() - t0);
+  }
+}
+
+
 void do_call(const core::config& app_config) {
   std::string fn_name = std::format("[povu::main::{}]", __func__);
 
@@ -42,25 +175,23 @@ void do_call(const core::config& app_config) {
   // read the input gfa into a bidirected variation graph
   // -----
   if (app_config.verbosity() > 2)  { std::cerr << std::format ("{} Reading graph\n", fn_name); }
-  bd::VG bd_vg = io::from_gfa::to_bd(app_config.get_input_gfa().c_str(), app_config);
+  bd::VG bd_vg = read_bd(app_config);
 
   if (app_config.verbosity() > 1) {
     timeRefRead = pt::Time::now() - t0;
     povu::utils::report_time(std::cerr, fn_name, "read_gfa", timeRefRead);
   }
 
+  if (app_config.sort_graph()) {
+    auto t1 = pt::Time::now();
+    bd_vg.sort_bfs();
+    if (app_config.verbosity() > 1) {
+      povu::utils::report_time(std::cerr, fn_name, "sorting", pt::Time::now() - t1);
+    }
+  }
 
-  std::vector<std::filesystem::path> flubble_files = povu::io::generic::get_files(app_config.get_forest_dir(), ".flb");
 
-  std::vector<pgt::flubble> canonical_flubbles;
-
-  // TODO: do in parallel
-  for (const auto& fp: flubble_files) {
-    std::cerr << std::format("Reading flubble file: {}\n", fp.string());
-    auto res = povu::io::bub::read_canonical_fl(fp.string());
-    // append the results of the vector with these results
-    canonical_flubbles.insert(canonical_flubbles.end(), res.begin(), res.end());
-  }
+  std::vector<pgt::flubble> canonical_flubbles = povu::io::forest::read_canonical_fl(app_config);
 
   // ------
   // read from a flubble tree in flb in format
@@ -71,6 +202,50 @@ void do_call(const core::config& app_config) {
 }
 
 
+// components with at least this many vertices are split at their bridges into
+// blocks of at least MIN_BLOCK_SIZE vertices
+const std::size_t SPLIT_MIN_SIZE { 1 << 17 };
+const std::size_t MIN_BLOCK_SIZE { 1 << 15 };
+
+// an estimate of the bytes deconstructing a component takes for each of its
+// vertices and edges, on top of the graph itself
+const std::size_t BYTES_PER_COST { 256 };
+
+/**
+ * the flubble trees of the blocks of a component that was split at its
+ * bridges as the jobs finish
+ */
+struct split_component {
+  std::vector<povu::tree::Tree<pgt::flubble>> fts;
+  std::atomic<std::size_t> pending; // blocks not yet deconstructed
+  std::size_t bytes; // held against --max-mem for the whole component
+
+  split_component(std::size_t block_count, std::size_t bytes)
+    : fts(block_count), pending(block_count), bytes(bytes) {}
+};
+
+/**
+ * a component or a block of one for a deconstruct worker
+ */
+struct deconstruct_job {
+  std::size_t component_id {};
+  povu::graph::Graph g;
+  std::size_t bytes {}; // held against --max-mem until the flubble tree is written
+  bool large {};        // holds a large component slot until then as well
+  std::shared_ptr<split_component> sc; // the component of a block, null for a whole component
+  std::size_t block_idx {};
+};
+
+/**
+ * a flubble tree for the writer, none if the component was too small to have one
+ */
+struct deconstruct_result {
+  std::size_t component_id {};
+  std::optional<povu::tree::Tree<pgt::flubble>> ft;
+  std::size_t bytes {};
+  bool large {};
+};
+
 void do_deconstruct(const core::config &app_config) {
   std::string fn_name = std::format("[povu::main::{}]", __func__);
 
@@ -81,7 +256,7 @@ void do_deconstruct(const core::config &app_config) {
   // read the input gfa into a bidirected variation graph
   // -----
   if (app_config.verbosity() > 2)  { std::cerr << std::format ("{} Reading graph\n", fn_name); }
-  povu::graph::Graph g =  io::from_gfa::to_pv_graph(app_config.get_input_gfa().c_str(), app_config);
+  povu::graph::Graph g = read_pv_graph(app_config);
 
   if (app_config.verbosity() > 1) {
     timeRefRead = pt::Time::now() - t0;
@@ -92,51 +267,264 @@ void do_deconstruct(const core::config &app_config) {
   //
   // -----
   if (app_config.verbosity() > 2)  { std::cerr << std::format("{} Finding components\n", fn_name); }
-  std::vector<povu::graph::Graph> components =  povu::graph::componetize(g, app_config);
+  std::vector<povu::graph::Graph> components =  povu::graph::componetize(std::move(g), app_config);
 
   if (app_config.verbosity() > 1) {
     std::cerr << std::format("{} Found {} components\n", fn_name, components.size());
   }
 
   // -----
-  // Divide the vector into chunks for each thread//
+  // deconstruct the components in a pipeline, largest first
+  //
+  // a producer thread hands out the components, sorting and splitting the large
+  // ones at their bridges one at a time, the workers pull them from a shared
+  // queue and turn them into flubble trees and a writer thread writes those out.
+  // The queues between the stages are bounded and each component holds an
+  // estimate of its memory until its flubble tree is written, --max-mem caps the
+  // sum. No more large components are in flight than there are workers either.
+  // A component is released once its flubble tree exists and the store they
+  // share once the last of them is. With a single thread there are no queues,
+  // each component is deconstructed and written as it is handed out.
   // -----
-  std::size_t chunk_size = components.size() / static_cast<std::size_t>(app_config.thread_count() );
+  auto cost_of = [](const povu::graph::Graph& c) -> std::size_t { return c.size() + c.edge_count(); };
+
+  std::size_t total_cost {};
+  for (const povu::graph::Graph& c : components) { total_cost += cost_of(c); }
+
+  std::vector<std::size_t> order(components.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(),
+                   [&](std::size_t a, std::size_t b) { return cost_of(components[a]) > cost_of(components[b]); });
+
+  // a job that is most of the graph would leave the other threads idle, let its
+  // cycle equivalence use them
+  auto inner_threads = [&](std::size_t cost) -> unsigned int {
+    return 2 * cost > total_cost ? app_config.thread_count() : 1;
+  };
+
+  const std::size_t worker_count { std::max(1u, app_config.thread_count()) };
+  pps::bounded_queue<deconstruct_job> jobs(2 * worker_count);
+  pps::bounded_queue<deconstruct_result> results(2 * worker_count);
+  pps::budget mem(app_config.max_mem());
+  // a large component handed out early would hold its sorted copy or its blocks
+  // while it waits for a worker
+  pps::budget large_slots(worker_count);
+
+  std::atomic<std::size_t> fast_path_count {}; // components found to be flubble free
+
+  std::exception_ptr error;
+  std::mutex error_mutex;
+  auto set_error = [&] {
+    std::lock_guard<std::mutex> lock(error_mutex);
+    if (!error) { error = std::current_exception(); }
+  };
+  auto failed = [&] {
+    std::lock_guard<std::mutex> lock(error_mutex);
+    return error != nullptr;
+  };
+
+  // the flubble tree of a whole component
+  auto deconstruct_component = [&](deconstruct_job& j) -> std::optional<povu::tree::Tree<pgt::flubble>> {
+    if (app_config.verbosity()) {
+      std::cerr << std::format("{} Handling component: {}\n", fn_name, j.component_id);
+    }
+
+    if (j.g.size() < 3) {
+      if (app_config.verbosity() > 2) {
+        std::cerr << std::format("{} Skipping component {} because it is too small. (size: {})\n", fn_name, j.component_id, j.g.size());
+      }
+      return std::nullopt;
+    }
 
-  // Create and launch threads
-  std::vector<std::thread> threads(app_config.thread_count());
-  std::size_t start, end;
-  for (unsigned int i {}; i < app_config.thread_count(); ++i) {
-    start = i * chunk_size;
-    end = (i == app_config.thread_count() - 1) ? components.size() : (i + 1) * chunk_size;
+    if (app_config.verbosity() > 3 && app_config.thread_count() == 1 && app_config.get_task() != core::task_t::info) {
+      j.g.summary();
+    }
 
-    threads[i] = std::thread([start, end,fn_name, app_config, &components] {
-      for (std::size_t i{start}; i < end; i++) {
+    // a tree or a simple cycle, write the flubble tree without deconstructing
+    if (povu::graph::is_flubble_free(j.g)) {
+      ++fast_path_count;
+      return povu::tree::Tree<pgt::flubble>();
+    }
 
-        std::size_t component_id {i + 1};
+    // the large ones were sorted before splitting
+    if (app_config.sort_graph() && j.g.size() < SPLIT_MIN_SIZE) {
+      j.g = povu::graph::sort_bfs(j.g);
+    }
 
-        if (app_config.verbosity()) {
-          std::cerr << std::format("{} Handling component: {}\n", fn_name, component_id);
-        }
+    unsigned int threads = inner_threads(cost_of(j.g));
+    return povu::lib::deconstruct_to_ft(std::move(j.g), j.component_id, app_config, threads);
+  };
+
+  // -----
+  // write the flubble trees out as they finish. With --forest-file the trees are
+  // appended to one file in that order, the file is only complete once its
+  // index is written
+  // -----
+  std::optional<povu::io::flf::writer> forest;
+  if (app_config.forest_file()) {
+    forest.emplace((app_config.get_output_dir() / povu::io::flf::FOREST_FILE_NAME).string());
+  }
+
+  auto write_result = [&](deconstruct_result& r) {
+    try {
+      if (r.ft && !failed()) {
+        if (forest) { forest->add(*r.ft, r.component_id); }
+        else { povu::io::bub::write_bub(*r.ft, std::to_string(r.component_id), app_config); }
+      }
+    }
+    catch (...) {
+      set_error();
+    }
+
+    r.ft.reset();
+    mem.release(r.bytes);
+    if (r.large) { large_slots.release(1); }
+  };
+
+  // with a single thread every stage runs inline on this thread
+  const bool serial { app_config.thread_count() <= 1 };
+
+  auto push_result = [&](deconstruct_result&& r) {
+    if (serial) { write_result(r); }
+    else { results.push(std::move(r)); }
+  };
+
+  std::vector<pps::thread_stats> stats(worker_count);
+  auto run_job = [&](deconstruct_job& j, pps::thread_stats& st) {
+    auto t = pt::Time::now();
+    std::size_t cost = cost_of(j.g);
+
+    if (!j.sc) {
+      std::optional<povu::tree::Tree<pgt::flubble>> ft;
+      try { ft = deconstruct_component(j); } catch (...) { set_error(); }
+      push_result({j.component_id, std::move(ft), j.bytes, j.large});
+    }
+    else {
+      if (app_config.verbosity()) {
+        std::cerr << std::format("{} Handling component: {} block: {}\n", fn_name, j.component_id, j.block_idx + 1);
+      }
+
+      split_component& sc = *j.sc;
+      unsigned int threads = inner_threads(cost);
+      try {
+        sc.fts[j.block_idx] = povu::lib::deconstruct_to_ft(std::move(j.g), j.component_id, app_config, threads);
+      }
+      catch (...) {
+        set_error();
+      }
+
+      // the last block to finish merges the flubble trees of the component
+      if (sc.pending.fetch_sub(1) == 1) {
+        push_result({j.component_id, povu::graph::flubble_tree::merge(sc.fts), sc.bytes, true});
+        sc.fts.clear();
+      }
+    }
 
-        if (components[i].size() < 3) {
-          if (app_config.verbosity() > 2) {
-            std::cerr << std::format("{} Skipping component {} because it is too small. (size: {})\n", fn_name, component_id, components[i].size());
+    j = deconstruct_job{};
+    st.busy += pt::Time::now() - t;
+    ++st.task_count;
+    st.cost += cost;
+  };
+
+  auto work = [&](std::size_t w) {
+    deconstruct_job j;
+    while (jobs.pop(j)) { run_job(j, stats[w]); }
+  };
+
+  auto push_job = [&](deconstruct_job&& j) {
+    if (serial) { run_job(j, stats[0]); }
+    else { jobs.push(std::move(j)); }
+  };
+
+  // -----
+  // hand out the components, the large ones are split at their bridges and each
+  // block is a job of its own. With --sort a large component is sorted before
+  // it is split, its blocks keep that order
+  // -----
+  std::chrono::duration<double> sort_time {};
+  std::chrono::duration<double> split_time {};
+
+  auto produce = [&] {
+    try {
+      for (std::size_t i : order) {
+        std::size_t component_id { i + 1 };
+        povu::graph::Graph c = std::move(components[i]);
+        std::size_t bytes = cost_of(c) * BYTES_PER_COST;
+        bool large = c.size() >= SPLIT_MIN_SIZE && !povu::graph::is_flubble_free(c);
+
+        if (large) { large_slots.acquire(1); }
+        mem.acquire(bytes);
+
+        if (large) {
+          if (app_config.sort_graph()) {
+            auto t = pt::Time::now();
+            c = povu::graph::sort_bfs(c);
+            sort_time += pt::Time::now() - t;
           }
-          continue;
-        }
 
-        if (app_config.verbosity() > 3 && app_config.thread_count() == 1 && app_config.get_task() != core::task_t::info) {
-          components[i].summary();
+          auto t = pt::Time::now();
+          std::vector<povu::graph::Graph> blocks = povu::graph::split_at_bridges(c, MIN_BLOCK_SIZE);
+          split_time += pt::Time::now() - t;
+
+          if (!blocks.empty()) {
+            if (app_config.verbosity() > 1) {
+              std::cerr << std::format("{} Split component {} into {} blocks\n", fn_name, component_id, blocks.size());
+            }
+
+            c = povu::graph::Graph();
+            auto sc = std::make_shared<split_component>(blocks.size(), bytes);
+            for (std::size_t j{}; j < blocks.size(); j++) {
+              push_job({component_id, std::move(blocks[j]), 0, false, sc, j});
+            }
+            continue;
+          }
         }
 
-        povu::bin::deconstruct(std::ref(components[i]), component_id, std::ref(app_config)); // Pass by reference
+        push_job({component_id, std::move(c), bytes, large, nullptr, 0});
       }
+    }
+    catch (...) {
+      set_error();
+    }
+
+    jobs.close();
+  };
+
+  auto t2 = pt::Time::now();
+
+  if (serial) {
+    produce();
+  }
+  else {
+    // the first worker runs on this thread, it can then reuse the memory freed
+    // by reading the graph
+    std::thread writer([&] {
+      deconstruct_result r;
+      while (results.pop(r)) { write_result(r); }
     });
+    std::thread producer(produce);
+    std::vector<std::thread> workers;
+    workers.reserve(worker_count - 1);
+    for (std::size_t w { 1 }; w < worker_count; ++w) { workers.emplace_back(work, w); }
+
+    work(0);
+
+    for (std::thread& w : workers) { w.join(); }
+    producer.join();
+    results.close();
+    writer.join();
   }
 
-  // Wait for all threads to finish
-  for (auto& thread : threads) { thread.join(); }
+  if (error) { std::rethrow_exception(error); }
+  if (forest) { forest->close(); }
+
+  if (app_config.verbosity() > 1) {
+    if (app_config.sort_graph()) { povu::utils::report_time(std::cerr, fn_name, "sorting large components", sort_time); }
+    povu::utils::report_time(std::cerr, fn_name, "splitting at bridges", split_time);
+    pps::report(std::cerr, fn_name, stats, pt::Time::now() - t2, false);
+    std::cerr << std::format("{} {} of {} components were flubble free\n", fn_name, fast_path_count.load(), components.size());
+    std::cerr << std::format("{} at most {} MB estimated to be in flight\n", fn_name, mem.peak() >> 20);
+  }
 
   return;
 }
@@ -167,6 +555,12 @@ int main(int argc, char *argv[]) {
     case core::task_t::info:
       do_info(app_config);
       break;
+    case core::task_t::index:
+      do_index(app_config);
+      break;
+    case core::task_t::convert:
+      do_convert(app_config);
+      break;
     default:
       std::cerr << std::format("{} Task not recognized\n", fn_name);
       break;
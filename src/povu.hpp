@@ -7,7 +7,9 @@
 #include "./graph/flubble_tree.hpp"
 
 namespace povu::bin {
-void deconstruct(const povu::graph::Graph& g, std::size_t component_id, const core::config& app_config);
+// thread_count is the number of threads the cycle equivalence of the component may use
+void deconstruct(const povu::graph::Graph& g, std::size_t component_id, const core::config& app_config,
+                 unsigned int thread_count = 1);
 }
 
 namespace povu::lib {
@@ -15,7 +17,11 @@ namespace pvtr = povu::tree;
 namespace pgt = povu::graph_types;
 
 std::vector<pgt::flubble> deconstruct_to_enum(const povu::graph::Graph& g, std::size_t component_id, const core::config& app_config);
-pvtr::Tree<pgt::flubble> deconstruct_to_ft(const povu::graph::Graph& g, std::size_t component_id, const core::config& app_config);
+pvtr::Tree<pgt::flubble> deconstruct_to_ft(const povu::graph::Graph& g, std::size_t component_id, const core::config& app_config,
+                                           unsigned int thread_count = 1);
+// as above but g is released as soon as its spanning tree is built
+pvtr::Tree<pgt::flubble> deconstruct_to_ft(povu::graph::Graph&& g, std::size_t component_id, const core::config& app_config,
+                                           unsigned int thread_count = 1);
 }
 
 #endif
@@ -1,5 +1,9 @@
+#include <memory_resource>
+
 #include "../algorithms/algorithms.hpp"
+#include "../common/arena.hpp"
 #include "../common/types.hpp"
+#include "../common/utils.hpp"
 #include "../graph/biedged.hpp"
 #include "../graph/flubble_tree.hpp"
 #include "../graph/spanning_tree.hpp"
@@ -8,38 +12,118 @@
 
 namespace povu::graph_ops {
 namespace pst = povu::spanning_tree;
+namespace pt = povu::types;
+namespace pgt = povu::graph_types;
+namespace pvtr = povu::tree;
+namespace pa = povu::arena;
+
+namespace {
+// components with fewer vertices than this are deconstructed in the arena of
+// the thread. The arena is not thread safe so their cycle equivalence is serial.
+const std::size_t ARENA_MAX_SIZE { 1 << 15 };
+} // namespace
 
 /**
- * @brief
- *
-*/
-pst::Tree biedge_and_cycle_equiv(const povu::graph::Graph& g, std::size_t component_id, const core::config& app_config)  {
+ * @brief the DFS spanning tree of the biedged form of g, allocated from mr
+ */
+pst::Tree spanning_tree(const povu::graph::Graph& g, std::size_t component_id, const core::config& app_config,
+                        std::pmr::memory_resource* mr) {
   std::string fn_name = std::format("[povu::subcommand::{}]", __func__);
 
-  // convert the bidirected variation graph into a biedged variation graph
-  if (app_config.verbosity() > 2) { std::cerr << std::format("{} Bi-edging {}\n", fn_name, component_id); }
-  biedged::BVariationGraph bg(g); // will add dummy vertices
-
+  // the biedged graph is only materialised to print it
   if (app_config.print_dot() && app_config.verbosity() > 4 ) { std::cout << "\n\n" << "Biedged" << "\n\n";
+    biedged::BVariationGraph bg(g); // will add dummy vertices
     bg.print_dot();
   }
 
+  // run the DFS on an implicit biedged view of the bidirected graph
   if (app_config.verbosity() > 2) { std::cerr << std::format("{} Generating spanning tree {}\n", fn_name, component_id); }
-  pst::Tree st = bg.compute_spanning_tree();
+  pst::Tree st = biedged::BVariationGraphView(g).compute_spanning_tree(mr);
 
   if (app_config.print_dot() && app_config.verbosity() > 4) { std::cout << "\n\n" << "Spanning Tree " << component_id << "\n\n";
     st.print_dot();
   }
 
+  return st;
+}
+
+/**
+ * @brief put the edges of a spanning tree in their cycle equivalence classes
+ */
+void cycle_equiv(pst::Tree& st, std::size_t component_id, const core::config& app_config, unsigned int thread_count) {
+  std::string fn_name = std::format("[povu::subcommand::{}]", __func__);
+
   if (app_config.verbosity() > 2) { std::cerr << std::format("{} Computing Cycle Equivalence {}\n", fn_name, component_id); }
-  povu::algorithms::eulerian_cycle_equiv(st);
+  auto t0 = pt::Time::now();
+  povu::algorithms::eulerian_cycle_equiv(st, thread_count);
+  if (app_config.verbosity() > 2) {
+    povu::utils::report_time(std::cerr, fn_name, std::format("cycle equivalence ({} thread(s))", thread_count), pt::Time::now() - t0);
+  }
 
   if (app_config.print_dot() && app_config.verbosity() > 4) { std::cout << "\n\n" << "Updated Spanning Tree " << component_id << "\n\n";
     st.print_dot();
   }
+}
+
+/**
+ * @brief the spanning tree of g with its edges in cycle equivalence classes,
+ * allocated from mr
+ *
+*/
+pst::Tree biedge_and_cycle_equiv(const povu::graph::Graph& g, std::size_t component_id, const core::config& app_config,
+                                 unsigned int thread_count = 1,
+                                 std::pmr::memory_resource* mr = std::pmr::get_default_resource())  {
+  pst::Tree st = spanning_tree(g, component_id, app_config, mr);
+  cycle_equiv(st, component_id, app_config, thread_count);
 
   return st;
 }
+
+/**
+ * @brief the flubble tree of a component, its unbranched chains are collapsed
+ * first if asked for
+ *
+ * g is released once its spanning tree is built, when the caller held the last
+ * reference to its store that memory goes before the rest of the work.
+ *
+ * The spanning tree and the scratch of a small component live in the arena of
+ * the thread, which is reset on return. The flubble tree is not in the arena.
+ */
+pvtr::Tree<pgt::flubble> to_flubble_tree(povu::graph::Graph&& g, std::size_t component_id, const core::config& app_config,
+                                         unsigned int thread_count) {
+  std::string fn_name = std::format("[povu::subcommand::{}]", __func__);
+
+  pa::Arena& arena = pa::local();
+  pa::scope reset_arena(arena);
+  std::pmr::memory_resource* mr = g.size() < ARENA_MAX_SIZE ? &arena : std::pmr::get_default_resource();
+
+  povu::graph::chain_map chains;
+  if (app_config.compact_chains()) {
+    std::size_t v_count = g.size();
+    auto compacted = povu::graph::compact_chains(g);
+    g = std::move(compacted.first);
+    chains = std::move(compacted.second);
+
+    if (app_config.verbosity() > 2) {
+      std::cerr << std::format("{} Compacted {} chains in component {}, vertices {} -> {}\n",
+                               fn_name, chains.size(), component_id, v_count, g.size());
+    }
+  }
+
+  pst::Tree st = spanning_tree(g, component_id, app_config, mr);
+  g = povu::graph::Graph();
+
+  // only the thread that owns the arena may allocate from it
+  cycle_equiv(st, component_id, app_config, mr == &arena ? 1 : thread_count);
+  pvtr::Tree<pgt::flubble> ft = povu::graph::flubble_tree::st_to_ft(st, chains);
+
+  if (app_config.verbosity() > 2 && mr == &arena) {
+    std::cerr << std::format("{} Component {} used {} of {} arena bytes\n",
+                             fn_name, component_id, arena.used(), arena.capacity());
+  }
+
+  return ft;
+}
 }
 
 namespace povu::bin {
@@ -49,11 +133,11 @@ namespace pgt = povu::graph_types;
 namespace pvtr = povu::tree;
 
 
-void deconstruct(const povu::graph::Graph& g, std::size_t component_id, const core::config& app_config) {
+void deconstruct(const povu::graph::Graph& g, std::size_t component_id, const core::config& app_config,
+                 unsigned int thread_count) {
   std::string fn_name = std::format("[povu::subcommand::{}]", __func__);
 
-  pst::Tree st = povu::graph_ops::biedge_and_cycle_equiv(g, component_id, app_config);
-  pvtr::Tree<pgt::flubble> flubble_tree = povu::graph::flubble_tree::st_to_ft(st);
+  pvtr::Tree<pgt::flubble> flubble_tree = povu::graph_ops::to_flubble_tree(povu::graph::Graph(g), component_id, app_config, thread_count);
   povu::io::bub::write_bub(flubble_tree, std::to_string(component_id), app_config);
 }
 
@@ -66,13 +150,19 @@ namespace pgt = povu::graph_types;
 namespace pvtr = povu::tree;
 
 
-pvtr::Tree<pgt::flubble> deconstruct_to_ft(const povu::graph::Graph& g, std::size_t component_id, const core::config& app_config) {
+pvtr::Tree<pgt::flubble> deconstruct_to_ft(const povu::graph::Graph& g, std::size_t component_id, const core::config& app_config,
+                                           unsigned int thread_count) {
   std::string fn_name = std::format("[povu::subcommand::{}]", __func__);
 
-  pst::Tree st = povu::graph_ops::biedge_and_cycle_equiv(g, component_id, app_config);
-  pvtr::Tree<pgt::flubble> flubble_tree = povu::graph::flubble_tree::st_to_ft(st);
+  return povu::graph_ops::to_flubble_tree(povu::graph::Graph(g), component_id, app_config, thread_count);
+}
+
+
+pvtr::Tree<pgt::flubble> deconstruct_to_ft(povu::graph::Graph&& g, std::size_t component_id, const core::config& app_config,
+                                           unsigned int thread_count) {
+  std::string fn_name = std::format("[povu::subcommand::{}]", __func__);
 
-  return flubble_tree;
+  return povu::graph_ops::to_flubble_tree(std::move(g), component_id, app_config, thread_count);
 }
 
 
@@ -0,0 +1,184 @@
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <list>
+#include <memory_resource>
+#include <random>
+#include <vector>
+
+#include "../src/common/types.hpp"
+#include "../src/graph/bracket_list.hpp"
+
+namespace pc = povu::constants;
+namespace pbl = povu::bracket_list;
+
+namespace {
+// the back edge ids of l from the top down, read by popping every bracket
+std::vector<std::size_t> drain(pbl::BracketPool& p, pbl::BracketList& l) {
+  std::vector<std::size_t> ids;
+  while (!l.empty()) {
+    std::size_t id = p.top(l).back_edge_id();
+    ids.push_back(id);
+    // ids are idx + 100 in these tests
+    p.del(l, id - 100);
+  }
+  EXPECT_EQ(l.head, pc::INVALID_IDX);
+  EXPECT_EQ(l.tail, pc::INVALID_IDX);
+  return ids;
+}
+
+std::vector<std::size_t> to_vec(const std::list<std::size_t>& l) { return { l.begin(), l.end() }; }
+} // namespace
+
+
+/*
+  BracketPool
+  -----------
+ */
+
+TEST(BracketPoolTest, PushIsTopFirst) {
+  pbl::BracketPool p;
+  pbl::BracketList l;
+  for (std::size_t i {}; i < 5; ++i) { p.push(l, i, i + 100); }
+
+  EXPECT_EQ(l.size, 5);
+  EXPECT_EQ(p.top(l).back_edge_id(), 104);
+  EXPECT_EQ(drain(p, l), (std::vector<std::size_t> { 104, 103, 102, 101, 100 }));
+}
+
+// del of the top, the bottom and the middle, and of brackets in no list
+TEST(BracketPoolTest, Del) {
+  pbl::BracketPool p;
+  pbl::BracketList l, other;
+  for (std::size_t i {}; i < 6; ++i) { p.push(l, i, i + 100); }
+
+  p.del(l, 5);
+  p.del(l, 0);
+  p.del(l, 3);
+  EXPECT_EQ(l.size, 3);
+
+  // already deleted, never pushed and out of the pool are all no-ops
+  p.del(l, 3);
+  p.del(other, 3);
+  p.del(l, 1000);
+  EXPECT_EQ(l.size, 3);
+  EXPECT_EQ(other.size, 0);
+
+  EXPECT_EQ(drain(p, l), (std::vector<std::size_t> { 104, 102, 101 }));
+}
+
+// the child goes on top of the parent and is left empty
+TEST(BracketPoolTest, Concat) {
+  pbl::BracketPool p;
+  pbl::BracketList parent, child, empty;
+  for (std::size_t i {}; i < 3; ++i) { p.push(parent, i, i + 100); }
+  for (std::size_t i { 3 }; i < 5; ++i) { p.push(child, i, i + 100); }
+
+  p.concat(parent, empty);
+  EXPECT_EQ(parent.size, 3);
+
+  p.concat(parent, child);
+  EXPECT_TRUE(child.empty());
+  EXPECT_EQ(child.head, pc::INVALID_IDX);
+  EXPECT_EQ(parent.size, 5);
+
+  // a del across the seam keeps both halves linked
+  p.del(parent, 3);
+  p.del(parent, 2);
+
+  pbl::BracketList into_empty;
+  p.concat(into_empty, parent);
+  EXPECT_TRUE(parent.empty());
+  EXPECT_EQ(drain(p, into_empty), (std::vector<std::size_t> { 104, 101, 100 }));
+}
+
+// a slot is reused once its bracket is deleted, the new bracket starts clean
+TEST(BracketPoolTest, SlotReuse) {
+  pbl::BracketPool p;
+  pbl::BracketList a, b;
+  p.push(a, 0, 100);
+  p.push(a, 1, 101);
+  p.top(a).set_recent_size(7);
+  p.top(a).set_recent_class(9);
+
+  p.del(a, 1);
+  p.push(b, 1, 101);
+  EXPECT_EQ(p.top(b).recent_size(), pc::UNDEFINED_SIZE_T);
+  EXPECT_EQ(p.top(b).recent_class(), pc::UNDEFINED_SIZE_T);
+
+  // a lost the bracket, b has it
+  EXPECT_EQ(a.size, 1);
+  EXPECT_EQ(p.top(a).back_edge_id(), 100);
+  p.del(a, 0);
+  p.push(b, 0, 100);
+  EXPECT_EQ(drain(p, b), (std::vector<std::size_t> { 100, 101 }));
+  EXPECT_TRUE(a.empty());
+}
+
+// random push, del and concat against std::list, as WBracketList did it
+TEST(BracketPoolTest, MatchesStdList) {
+  const std::size_t LISTS { 8 };
+  const std::size_t SLOTS { 200 };
+  std::mt19937 rng(11);
+
+  // a pool that lives in a buffer that is released and reused
+  std::pmr::monotonic_buffer_resource mr;
+  for (std::size_t round {}; round < 3; ++round) {
+    pbl::BracketPool p(&mr);
+    p.reserve(SLOTS);
+    std::vector<pbl::BracketList> lists(LISTS);
+    std::vector<std::list<std::size_t>> expected(LISTS);
+    std::vector<std::size_t> in(SLOTS, pc::INVALID_IDX); // the list a slot is in
+
+    for (std::size_t step {}; step < 20'000; ++step) {
+      std::size_t op = rng() % 3;
+      std::size_t li = rng() % LISTS;
+      std::size_t s = rng() % SLOTS;
+
+      if (op == 0 && in[s] == pc::INVALID_IDX) {
+        p.push(lists[li], s, s + 100);
+        expected[li].push_front(s + 100);
+        in[s] = li;
+      }
+      else if (op == 1) {
+        // del is a no-op unless the slot is in a list
+        std::size_t l = in[s] == pc::INVALID_IDX ? li : in[s];
+        p.del(lists[l], s);
+        expected[l].remove(s + 100);
+        in[s] = pc::INVALID_IDX;
+      }
+      else if (op == 2) {
+        std::size_t ci = rng() % LISTS;
+        if (ci == li) { continue; }
+        for (std::size_t id : expected[ci]) { in[id - 100] = li; }
+        p.concat(lists[li], lists[ci]);
+        expected[li].splice(expected[li].begin(), expected[ci]);
+      }
+
+      ASSERT_EQ(lists[li].size, expected[li].size());
+      if (!expected[li].empty()) { ASSERT_EQ(p.top(lists[li]).back_edge_id(), expected[li].front()); }
+    }
+
+    for (std::size_t li {}; li < LISTS; ++li) { EXPECT_EQ(drain(p, lists[li]), to_vec(expected[li])) << li; }
+    mr.release();
+  }
+}
+
+// remap moves brackets to new slots and drops those mapped to INVALID_IDX
+TEST(BracketPoolTest, Remap) {
+  pbl::BracketPool p;
+  std::pmr::vector<pbl::BracketList> lists(2);
+  for (std::size_t i {}; i < 6; ++i) { p.push(lists[i % 2], i, i + 100); }
+  p.del(lists[0], 2);
+  p.del(lists[1], 3);
+
+  // reverse the slots of the brackets left, 2 and 3 are dropped
+  std::pmr::vector<std::size_t> new_idx { 3, 2, pc::INVALID_IDX, pc::INVALID_IDX, 1, 0 };
+  p.remap(new_idx, 4, lists);
+  for (std::size_t i {}; i < 4; ++i) { p.set_back_edge_id(i, i + 100); }
+
+  EXPECT_EQ(lists[0].size, 2);
+  EXPECT_EQ(lists[1].size, 2);
+  EXPECT_EQ(drain(p, lists[0]), (std::vector<std::size_t> { 101, 103 }));
+  EXPECT_EQ(drain(p, lists[1]), (std::vector<std::size_t> { 100, 102 }));
+}
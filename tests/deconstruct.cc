@@ -0,0 +1,415 @@
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <exception>
+#include <format>
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "../src/algorithms/algorithms.hpp"
+#include "../src/common/types.hpp"
+#include "../src/graph/biedged.hpp"
+#include "../src/graph/flubble_tree.hpp"
+#include "../src/graph/spanning_tree.hpp"
+#include "../src/graph/graph.hpp"
+#include "../src/povu.hpp"
+#include "./test_utils.hpp"
+
+namespace pg = povu::graph;
+namespace pa = povu::algorithms;
+namespace pc = povu::constants;
+namespace pgt = povu::graph_types;
+namespace pft = povu::graph::flubble_tree;
+namespace pst = povu::spanning_tree;
+namespace ptest = povu::test;
+
+namespace {
+typedef std::vector<std::tuple<std::size_t, pgt::v_end, std::size_t, pgt::v_end>> edge_list;
+
+// a graph of the vertices 1 .. v_count and the edges between them
+pg::Graph from_edges(std::size_t v_count, const edge_list& edges) {
+  pg::Graph g(v_count, edges.size());
+  for (std::size_t id { 1 }; id <= v_count; ++id) { g.add_vertex(id); }
+  for (auto [v1, e1, v2, e2] : edges) { g.add_edge(v1, e1, v2, e2); }
+  g.freeze();
+  io::from_gfa::populate_tips(g, ptest::quiet_config());
+
+  return g;
+}
+
+/**
+ * a chain of bubbles joined by bridges, each bubble a -> (b | c) -> d with a
+ * skip edge from a to d in some of them, d of one bubble links to a of the
+ * next. The b branch is a chain of chain_len vertices, its middle one flipped.
+ */
+pg::Graph bubble_chain(std::size_t bubble_count, std::size_t chain_len, unsigned int seed) {
+  std::mt19937 rng(seed);
+  edge_list edges;
+  std::size_t next_id { 1 };
+  std::size_t prev_d {};
+
+  for (std::size_t i {}; i < bubble_count; ++i) {
+    std::size_t a = next_id++;
+    if (prev_d) { edges.emplace_back(prev_d, pgt::v_end::r, a, pgt::v_end::l); }
+
+    // the b branch, entered and left on the side its orientation gives
+    std::size_t prev = a;
+    pgt::v_end prev_out = pgt::v_end::r;
+    for (std::size_t j {}; j < chain_len; ++j) {
+      std::size_t b = next_id++;
+      bool flipped = chain_len > 2 && j == chain_len / 2;
+      edges.emplace_back(prev, prev_out, b, flipped ? pgt::v_end::r : pgt::v_end::l);
+      prev = b;
+      prev_out = flipped ? pgt::v_end::l : pgt::v_end::r;
+    }
+
+    std::size_t c = next_id++;
+    std::size_t d = next_id++;
+    edges.emplace_back(prev, prev_out, d, pgt::v_end::l);
+    edges.emplace_back(a, pgt::v_end::r, c, pgt::v_end::l);
+    edges.emplace_back(c, pgt::v_end::r, d, pgt::v_end::l);
+    if (rng() % 3 == 0) { edges.emplace_back(a, pgt::v_end::r, d, pgt::v_end::l); }
+
+    prev_d = d;
+  }
+
+  return from_edges(next_id - 1, edges);
+}
+
+/**
+ * a random tree of junctions, the link from a junction to its parent is a
+ * bubble a -> (b | c) -> d hung from either side of the parent and entered on
+ * either side of the junction. Some junctions have a hairpin and a few more
+ * links join random junctions. The DFS trees of these branch where those of
+ * bubble chains are nearly a path.
+ */
+pg::Graph branching_graph(std::size_t junction_count, unsigned int seed) {
+  std::mt19937 rng(seed);
+  edge_list edges;
+  auto any_side = [&] { return rng() % 2 ? pgt::v_end::l : pgt::v_end::r; };
+
+  // the junctions are 1 .. junction_count
+  std::size_t next_id { junction_count + 1 };
+  for (std::size_t j { 2 }; j <= junction_count; ++j) {
+    std::size_t p = 1 + rng() % (j - 1);
+    std::size_t a = next_id++, b = next_id++, c = next_id++, d = next_id++;
+    edges.emplace_back(p, any_side(), a, pgt::v_end::l);
+    edges.emplace_back(a, pgt::v_end::r, b, pgt::v_end::l);
+    edges.emplace_back(a, pgt::v_end::r, c, pgt::v_end::l);
+    edges.emplace_back(b, pgt::v_end::r, d, pgt::v_end::l);
+    edges.emplace_back(c, pgt::v_end::r, d, pgt::v_end::l);
+    edges.emplace_back(d, pgt::v_end::r, j, rng() % 4 == 0 ? pgt::v_end::r : pgt::v_end::l);
+
+    // a hairpin h1 -> h2 -> back into h1 on the side it left by
+    if (rng() % 5 == 0) {
+      std::size_t h1 = next_id++, h2 = next_id++;
+      edges.emplace_back(j, any_side(), h1, pgt::v_end::l);
+      edges.emplace_back(h1, pgt::v_end::r, h2, pgt::v_end::l);
+      edges.emplace_back(h2, pgt::v_end::r, h1, pgt::v_end::r);
+    }
+  }
+  for (std::size_t k {}; k < junction_count / 20; ++k) {
+    std::size_t u = 1 + rng() % junction_count;
+    std::size_t v = 1 + rng() % junction_count;
+    if (u != v) { edges.emplace_back(u, any_side(), v, any_side()); }
+  }
+
+  return from_edges(next_id - 1, edges);
+}
+
+// a random tree, each vertex hangs from either side of an earlier one by either
+// of its own sides. The first two hang from the right of 1 so that it branches.
+edge_list random_tree(std::size_t v_count, std::mt19937& rng) {
+  auto any_side = [&] { return rng() % 2 ? pgt::v_end::l : pgt::v_end::r; };
+  edge_list edges;
+  for (std::size_t v { 2 }; v <= v_count; ++v) {
+    if (v <= 3) { edges.emplace_back(1, pgt::v_end::r, v, any_side()); }
+    else { edges.emplace_back(1 + rng() % (v - 1), any_side(), v, any_side()); }
+  }
+  return edges;
+}
+
+// a simple cycle through 1 .. v_count, each vertex either way round
+edge_list simple_cycle(std::size_t v_count, std::mt19937& rng) {
+  std::vector<bool> flipped(v_count + 1);
+  for (std::size_t v { 1 }; v <= v_count; ++v) { flipped[v] = rng() % 2; }
+  auto in = [&](std::size_t v) { return flipped[v] ? pgt::v_end::r : pgt::v_end::l; };
+  auto out = [&](std::size_t v) { return flipped[v] ? pgt::v_end::l : pgt::v_end::r; };
+
+  edge_list edges;
+  for (std::size_t v { 1 }; v <= v_count; ++v) {
+    std::size_t next = v == v_count ? 1 : v + 1;
+    edges.emplace_back(v, out(v), next, in(next));
+  }
+  return edges;
+}
+
+// the tree and back edges of a spanning tree with their classes
+std::vector<std::tuple<std::size_t, std::size_t, std::size_t, pst::EdgeType, std::size_t>> classes(pst::Tree& st) {
+  std::vector<std::tuple<std::size_t, std::size_t, std::size_t, pst::EdgeType, std::size_t>> cs;
+  for (std::size_t e_idx {}; e_idx < st.tree_edge_count(); ++e_idx) {
+    const pst::Edge& e = st.get_tree_edge(e_idx);
+    cs.emplace_back(e.id(), e.get_parent_v_idx(), e.get_child(), pst::EdgeType::tree_edge, e.get_class());
+  }
+  for (std::size_t be_idx {}; be_idx < st.back_edge_count(); ++be_idx) {
+    const pst::BackEdge& be = st.get_backedge(be_idx);
+    cs.emplace_back(be.id(), be.get_src(), be.get_tgt(), be.type(), be.get_class());
+  }
+  return cs;
+}
+
+// the capping and simplifying back edges chained onto each vertex, in order
+std::vector<std::vector<std::size_t>> added_ibes(const pst::Tree& st) {
+  std::vector<std::vector<std::size_t>> ibes(st.size());
+  for (std::size_t v {}; v < st.size(); ++v) {
+    for (std::size_t b = st.first_added_ibe(v); b != pc::INVALID_IDX; b = st.next_added_ibe(b)) { ibes[v].push_back(b); }
+  }
+  return ibes;
+}
+
+// the components of the test data and of a few bubble chains
+std::vector<std::pair<std::string, pg::Graph>> test_components() {
+  std::vector<std::pair<std::string, pg::Graph>> cs;
+  for (const std::string& fp : ptest::test_gfas()) {
+    std::vector<pg::Graph> components = pg::componetize(ptest::load(fp, ptest::quiet_config()), ptest::quiet_config());
+    for (std::size_t i {}; i < components.size(); ++i) {
+      cs.emplace_back(std::format("{} component {}", fp, i + 1), std::move(components[i]));
+    }
+  }
+  for (unsigned int seed : { 1u, 2u, 3u }) {
+    for (std::size_t chain_len : { 1, 4 }) {
+      cs.emplace_back(std::format("bubble chain seed {} chain {}", seed, chain_len), bubble_chain(200, chain_len, seed));
+    }
+  }
+  return cs;
+}
+
+// the .flb text of a component as deconstruct writes it without splitting or
+// compacting, empty if it is too small or deconstruct rejects it
+std::string reference_flb(const pg::Graph& c, const core::config& app_config) {
+  if (c.size() < 3 || pg::is_flubble_free(c)) { return ""; }
+  try {
+    return ptest::flb(povu::lib::deconstruct_to_ft(c, 1, app_config));
+  }
+  catch (const std::exception&) {
+    return "";
+  }
+}
+} // namespace
+
+
+/*
+  split_at_bridges
+  ----------------
+ */
+
+// the merged flubble trees of the blocks are the flubble tree of the component,
+// with every eligible bridge cut and with blocks merged to a minimum size
+TEST(SplitAtBridgesTest, KeepsFlubbles) {
+  const core::config app_config = ptest::quiet_config();
+  std::size_t split_count {};
+
+  for (auto& [name, c] : test_components()) {
+    std::string expected = reference_flb(c, app_config);
+    if (expected.empty()) { continue; }
+
+    for (std::size_t min_block_size : { 1, 50 }) {
+      std::vector<pg::Graph> blocks = pg::split_at_bridges(c, min_block_size);
+      if (blocks.empty()) { continue; }
+      ++split_count;
+
+      std::size_t v_count {};
+      std::vector<povu::tree::Tree<pgt::flubble>> fts;
+      for (const pg::Graph& b : blocks) {
+        v_count += b.size();
+        fts.push_back(povu::lib::deconstruct_to_ft(b, 1, app_config));
+      }
+
+      EXPECT_EQ(v_count, c.size()) << name;
+      EXPECT_EQ(ptest::flb(pft::merge(fts)), expected) << name << " min block size " << min_block_size;
+    }
+  }
+
+  // the bubble chains at least are split
+  EXPECT_GE(split_count, 12);
+}
+
+// a bridge whose end has another edge on the same side is not cut
+TEST(SplitAtBridgesTest, KeepsBridgesWithSharedSides) {
+  pg::Graph g(6, 6);
+  for (std::size_t id { 1 }; id <= 6; ++id) { g.add_vertex(id); }
+  g.add_edge(1, pgt::v_end::r, 2, pgt::v_end::l);
+  g.add_edge(1, pgt::v_end::r, 3, pgt::v_end::l);
+  g.add_edge(2, pgt::v_end::r, 4, pgt::v_end::l);
+  g.add_edge(3, pgt::v_end::r, 4, pgt::v_end::l);
+  // 4 -> 5 and 4 -> 6 are bridges that share the right side of 4
+  g.add_edge(4, pgt::v_end::r, 5, pgt::v_end::l);
+  g.add_edge(4, pgt::v_end::r, 6, pgt::v_end::l);
+  g.freeze();
+  io::from_gfa::populate_tips(g, ptest::quiet_config());
+
+  EXPECT_TRUE(pg::split_at_bridges(g, 1).empty());
+}
+
+
+/*
+  compact_chains
+  --------------
+ */
+
+TEST(CompactChainsTest, CollapsesChains) {
+  // 1 -> (2 3 -4 5 | 6) -> 7 -> 8 -> (9 10 -11 12 | 13) -> 14
+  auto [g, chains] = pg::compact_chains(bubble_chain(2, 4, 1));
+
+  EXPECT_EQ(g.size(), 7);
+  EXPECT_EQ(chains.size(), 3);
+
+  auto steps = [&](std::size_t v_id) {
+    std::vector<std::string> s;
+    for (const pgt::id_or& step : chains.get(v_id)) { s.push_back(step.as_str()); }
+    return s;
+  };
+  EXPECT_EQ(steps(2), (std::vector<std::string> { ">2", ">3", "<4", ">5" }));
+  EXPECT_EQ(steps(7), (std::vector<std::string> { ">7", ">8" }));
+  EXPECT_EQ(steps(9), (std::vector<std::string> { ">9", ">10", "<11", ">12" }));
+  EXPECT_TRUE(chains.get(1).empty());
+  EXPECT_TRUE(chains.get(6).empty());
+}
+
+// --compact gives the flubbles of the uncompacted component, also on the
+// blocks of a split component
+TEST(CompactChainsTest, KeepsFlubbles) {
+  const core::config app_config = ptest::quiet_config();
+  core::config compact_config = ptest::quiet_config();
+  compact_config.set_compact_chains(true);
+  std::size_t compacted_count {};
+
+  for (auto& [name, c] : test_components()) {
+    std::string expected = reference_flb(c, app_config);
+    if (expected.empty()) { continue; }
+
+    if (pg::compact_chains(c).first.size() < c.size()) { ++compacted_count; }
+    EXPECT_EQ(ptest::flb(povu::lib::deconstruct_to_ft(c, 1, compact_config)), expected) << name;
+
+    std::vector<pg::Graph> blocks = pg::split_at_bridges(c, 1);
+    if (blocks.empty()) { continue; }
+
+    std::vector<povu::tree::Tree<pgt::flubble>> fts;
+    for (const pg::Graph& b : blocks) { fts.push_back(povu::lib::deconstruct_to_ft(b, 1, compact_config)); }
+    EXPECT_EQ(ptest::flb(pft::merge(fts)), expected) << name << " split";
+  }
+
+  // the bubble chains at least are compacted
+  EXPECT_GE(compacted_count, 6);
+}
+
+
+/*
+  eulerian_cycle_equiv
+  --------------------
+ */
+
+// with the thresholds lowered subtrees go to the scheduler, the classes, the
+// back edges added, their chains and the flubble tree are those of a serial run
+TEST(CycleEquivTest, ParallelMatchesSerial) {
+  std::vector<std::pair<std::string, pg::Graph>> cs = test_components();
+  for (unsigned int seed : { 1u, 2u, 3u, 4u }) {
+    for (std::size_t junction_count : { 300, 1000 }) {
+      cs.emplace_back(std::format("branching seed {} junctions {}", seed, junction_count),
+                      branching_graph(junction_count, seed));
+    }
+  }
+
+  std::size_t parallel_count {};
+  for (auto& [name, c] : cs) {
+    if (c.size() < 3 || pg::is_flubble_free(c)) { continue; }
+
+    pst::Tree serial = biedged::BVariationGraphView(c).compute_spanning_tree();
+    EXPECT_FALSE(pa::eulerian_cycle_equiv(serial, 1, 0, 1)) << name;
+    auto expected_classes = classes(serial);
+    auto expected_ibes = added_ibes(serial);
+    std::string expected_flb = ptest::flb(pft::st_to_ft(serial));
+
+    for (unsigned int thread_count : { 2, 4, 8 }) {
+      for (std::size_t min_task_size : { 8, 64 }) {
+        pst::Tree st = biedged::BVariationGraphView(c).compute_spanning_tree();
+        bool parallel = pa::eulerian_cycle_equiv(st, thread_count, 0, min_task_size);
+        parallel_count += parallel;
+        if (name.starts_with("branching")) { EXPECT_TRUE(parallel) << name; }
+
+        std::string at = std::format("{} threads {} min task {}", name, thread_count, min_task_size);
+        EXPECT_EQ(classes(st), expected_classes) << at;
+        EXPECT_EQ(added_ibes(st), expected_ibes) << at;
+        EXPECT_EQ(ptest::flb(pft::st_to_ft(st)), expected_flb) << at;
+      }
+    }
+  }
+
+  // at least the branching graphs on every thread count and task size
+  EXPECT_GE(parallel_count, 48);
+}
+
+
+/*
+  is_flubble_free
+  ---------------
+ */
+
+// trees and simple cycles take the fast path and their flubble tree is the
+// root alone, as it is when they are deconstructed
+TEST(FlubbleFreeTest, TreesAndCycles) {
+  const core::config app_config = ptest::quiet_config();
+  const std::string root_only = ptest::flb(povu::tree::Tree<pgt::flubble>());
+  std::mt19937 rng(5);
+
+  std::vector<std::pair<std::string, pg::Graph>> cs;
+  for (std::size_t i {}; i < 150; ++i) {
+    std::size_t v_count = 3 + rng() % 60;
+    cs.emplace_back(std::format("tree {}", i), from_edges(v_count, random_tree(v_count, rng)));
+    cs.emplace_back(std::format("cycle {}", i), from_edges(v_count, simple_cycle(v_count, rng)));
+    EXPECT_TRUE(pg::is_flubble_free(cs[cs.size() - 2].second)) << "tree " << i;
+    EXPECT_TRUE(pg::is_flubble_free(cs.back().second)) << "cycle " << i;
+  }
+
+  std::size_t test_data_count {};
+  for (auto& [name, c] : test_components()) {
+    if (c.size() >= 3 && pg::is_flubble_free(c)) {
+      ++test_data_count;
+      cs.emplace_back(name, std::move(c));
+    }
+  }
+
+  for (auto& [name, c] : cs) {
+    EXPECT_EQ(ptest::flb(povu::lib::deconstruct_to_ft(c, 1, app_config)), root_only) << name;
+  }
+
+  // synthetic/test.gfa is a tree
+  EXPECT_GE(test_data_count, 1);
+}
+
+// as many edges as vertices but not a simple cycle, or a tree with an edge more
+TEST(FlubbleFreeTest, RejectsOtherGraphs) {
+  std::mt19937 rng(6);
+
+  for (std::size_t i {}; i < 50; ++i) {
+    std::size_t v_count = 4 + rng() % 60;
+
+    // a cycle through all but the last vertex, which hangs from the first
+    edge_list tail = simple_cycle(v_count - 1, rng);
+    tail.emplace_back(1, rng() % 2 ? pgt::v_end::l : pgt::v_end::r, v_count, pgt::v_end::l);
+    EXPECT_FALSE(pg::is_flubble_free(from_edges(v_count, tail))) << "cycle with a tail " << i;
+
+    // 1 branches in the tree, so the edge added can't close a simple cycle
+    edge_list extra = random_tree(v_count, rng);
+    std::size_t u = 1 + rng() % v_count;
+    std::size_t v = 1 + (u + rng() % (v_count - 1)) % v_count;
+    extra.emplace_back(u, rng() % 2 ? pgt::v_end::l : pgt::v_end::r, v, rng() % 2 ? pgt::v_end::l : pgt::v_end::r);
+    EXPECT_FALSE(pg::is_flubble_free(from_edges(v_count, extra))) << "tree and an edge " << i;
+
+    // two edges more
+    extra.emplace_back(u, pgt::v_end::l, v, pgt::v_end::r);
+    EXPECT_FALSE(pg::is_flubble_free(from_edges(v_count, extra))) << "tree and two edges " << i;
+  }
+}
@@ -1,35 +1,140 @@
-#include "../src/common/common.hpp"
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
 #include "../src/genomics/genomics.hpp"
+#include "../src/graph/bidirected.hpp"
+#include "../src/io/io.hpp"
+#include "../src/povu.hpp"
+#include "./test_utils.hpp"
+
+namespace bd = povu::bidirected;
+namespace pg = povu::graph;
+namespace pgt = povu::graph_types;
+namespace pgen = povu::genomics;
+namespace ptest = povu::test;
+
+namespace {
+/*
+  1 -> (2 | 3) -> 4 -> (5 | 6 | skip) -> 7 -> (8 | 9) -> 10
+
+  h1 and h2 go forward, h3 goes in reverse over the skip edge and h4 is h1
+  again. No haplotype goes past 7.
+ */
+const std::string SWEEP_GFA {
+  "H\tVN:Z:1.0\n"
+  "S\t1\tA\nS\t2\tC\nS\t3\tG\nS\t4\tT\nS\t5\tA\n"
+  "S\t6\tC\nS\t7\tG\nS\t8\tT\nS\t9\tA\nS\t10\tC\n"
+  "L\t1\t+\t2\t+\t0M\nL\t1\t+\t3\t+\t0M\nL\t2\t+\t4\t+\t0M\nL\t3\t+\t4\t+\t0M\n"
+  "L\t4\t+\t5\t+\t0M\nL\t4\t+\t6\t+\t0M\nL\t4\t+\t7\t+\t0M\nL\t5\t+\t7\t+\t0M\nL\t6\t+\t7\t+\t0M\n"
+  "L\t7\t+\t8\t+\t0M\nL\t7\t+\t9\t+\t0M\nL\t8\t+\t10\t+\t0M\nL\t9\t+\t10\t+\t0M\n"
+  "P\th1\t1+,2+,4+,5+,7+\t*\n"
+  "P\th2\t1+,3+,4+,6+,7+\t*\n"
+  "P\th3\t7-,4-,3-,1-\t*\n"
+  "P\th4\t1+,2+,4+,5+,7+\t*\n"
+};
+
+bd::VG load_for_call(const std::string& fp) {
+  core::config app_config = ptest::quiet_config();
+  app_config.set_task(core::task_t::call);
+  return io::from_gfa::to_bd(fp.c_str(), app_config);
+}
+
+bd::VG sweep_graph() {
+  std::filesystem::path fp = ptest::scratch_dir("sweep") / "sweep.gfa";
+  std::ofstream(fp) << SWEEP_GFA;
+  return load_for_call(fp.string());
+}
+
+pgt::flubble fl(std::size_t entry, std::size_t exit) {
+  return { { entry, pgt::orientation_t::forward }, { exit, pgt::orientation_t::forward } };
+}
+
+// the walks of each flubble as strings of vertex ids such as >1>2>4
+std::vector<std::vector<std::string>> sweep(const std::vector<pgt::flubble>& flubbles, const bd::VG& vg,
+                                            unsigned int thread_count) {
+  std::vector<std::vector<pgt::walk>> all_paths;
+  pgen::find_bubble_paths_sweep(flubbles, vg, all_paths, ptest::quiet_config(thread_count));
+
+  std::vector<std::vector<std::string>> walks;
+  for (const std::vector<pgt::walk>& ws : all_paths) {
+    std::vector<std::string>& strs = walks.emplace_back();
+    for (const pgt::walk& w : ws) {
+      std::string s;
+      for (const pgt::id_n_orientation_t& step : w) { s += pgt::or_to_str(step.orientation) + std::to_string(vg.idx_to_id(step.v_idx)); }
+      strs.push_back(s);
+    }
+  }
+  return walks;
+}
+} // namespace
+
+
+/*
+  find_bubble_paths_sweep
+  -----------------------
+ */
+
+// 4 closes 1 -> 4 and opens 4 -> 7 on the same step, the skip walk of h3
+// comes last as h3 comes after h1 and h2
+TEST(SweepTest, Forward) {
+  bd::VG vg = sweep_graph();
+  auto walks = sweep({ fl(1, 4), fl(4, 7) }, vg, 1);
+
+  ASSERT_EQ(walks.size(), 2);
+  EXPECT_EQ(walks[0], (std::vector<std::string> { ">1>2>4", ">1>3>4" }));
+  EXPECT_EQ(walks[1], (std::vector<std::string> { ">4>5>7", ">4>6>7", ">4>7" }));
+}
+
+// given from 7 to 4, h1 and h2 walk the flubble from its exit to its entry and
+// h3 from its entry to its exit, the walks all go from 7 to 4
+TEST(SweepTest, Reverse) {
+  bd::VG vg = sweep_graph();
+  pgt::flubble rev { { 7, pgt::orientation_t::reverse }, { 4, pgt::orientation_t::reverse } };
+  auto walks = sweep({ rev, fl(1, 4) }, vg, 1);
+
+  ASSERT_EQ(walks.size(), 2);
+  EXPECT_EQ(walks[0], (std::vector<std::string> { "<7<5<4", "<7<6<4", "<7<4" }));
+  EXPECT_EQ(walks[1], (std::vector<std::string> { ">1>2>4", ">1>3>4" }));
+}
+
+// h1, h2 and h4 open 7 -> 10 but none of them reaches 10
+TEST(SweepTest, Untraversed) {
+  bd::VG vg = sweep_graph();
+  auto walks = sweep({ fl(7, 10), fl(1, 4) }, vg, 1);
+
+  ASSERT_EQ(walks.size(), 2);
+  EXPECT_TRUE(walks[0].empty());
+  EXPECT_EQ(walks[1].size(), 2);
+}
+
+// the walks and their order do not depend on the thread count
+TEST(SweepTest, ThreadCount) {
+  {
+    bd::VG vg = sweep_graph();
+    std::vector<pgt::flubble> flubbles { fl(1, 4), fl(4, 7), fl(7, 10) };
+    EXPECT_EQ(sweep(flubbles, vg, 1), sweep(flubbles, vg, 4));
+  }
+
+  for (const char* rel : { "real/LPA.gfa", "real/chr6.C4.gfa" }) {
+    std::vector<pgt::flubble> flubbles;
+    for (const pg::Graph& c : pg::componetize(ptest::load(ptest::data_path(rel), ptest::quiet_config()), ptest::quiet_config())) {
+      if (c.size() < 3 || pg::is_flubble_free(c)) { continue; }
+      std::vector<pgt::flubble> c_flubbles =
+        povu::io::bub::read_canonical_fl(ptest::flb(povu::lib::deconstruct_to_ft(c, 1, ptest::quiet_config())), rel);
+      flubbles.insert(flubbles.end(), c_flubbles.begin(), c_flubbles.end());
+    }
+    bd::VG vg = load_for_call(ptest::data_path(rel));
 
+    auto walks = sweep(flubbles, vg, 1);
+    std::size_t traversed {};
+    for (const std::vector<std::string>& ws : walks) { traversed += !ws.empty(); }
 
-TEST(GenomicsTest, ExtractCanonicalFlubbles) {
-  std::vector<graph_types::eq_n_id_t> v = {
-    {7, 2},
-    {8, 4},
-    {9, 6},
-    {9, 8},
-    {10, 10},
-    {0, 11},
-    {9, 14},
-    {8, 16},
-    {3, 17},
-    {3, 19},
-    {2, 22},
-    {4, 23},
-    {1, 26},
-    {3, 27},
-    {3, 29},
-    {7, 32},
-    {7, 34},
-    };
-
-
-  //tree::Tree t = pvst::compute_pvst(v, test_config);
-  //std::vector<std::pair<std::size_t, std::size_t>> cfl = genomics::extract_canonical_flubbles(t);
-
-  // print cfl
-  //for (auto flubble : cfl) {
-  //std::cout << flubble.first << " " << flubble.second << std::endl;
-  //}
-  //EXPECT_EQ(1, 2);
+    EXPECT_GT(traversed, 0) << rel;
+    EXPECT_EQ(walks, sweep(flubbles, vg, 4)) << rel;
+  }
 }
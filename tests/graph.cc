@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "../src/graph/graph.hpp"
+#include "./test_utils.hpp"
+
+namespace pg = povu::graph;
+namespace pgt = povu::graph_types;
+namespace ptest = povu::test;
+
+namespace {
+// a component as the ids of its vertices, its edges and its tips, in the order
+// the view holds them
+struct component_dump {
+  std::vector<std::size_t> vertices;
+  std::vector<std::tuple<std::size_t, pgt::v_end, std::size_t, pgt::v_end>> edges;
+  std::vector<std::pair<pgt::v_end, std::size_t>> tips;
+
+  bool operator==(const component_dump&) const = default;
+};
+
+std::vector<component_dump> dump(const std::vector<pg::Graph>& components) {
+  std::vector<component_dump> d;
+  for (const pg::Graph& c : components) {
+    component_dump cd;
+    for (std::size_t v_idx {}; v_idx < c.size(); ++v_idx) { cd.vertices.push_back(c.v_idx_to_id(v_idx)); }
+    for (std::size_t e_idx {}; e_idx < c.edge_count(); ++e_idx) {
+      const pg::Edge& e = c.get_edge(e_idx);
+      cd.edges.emplace_back(c.v_idx_to_id(e.get_v1_idx()), e.get_v1_end(), c.v_idx_to_id(e.get_v2_idx()), e.get_v2_end());
+    }
+    for (auto [end, v_idx] : c.tips()) { cd.tips.emplace_back(end, c.v_idx_to_id(v_idx)); }
+    d.push_back(std::move(cd));
+  }
+  return d;
+}
+
+/**
+ * many small components of random bubbles with their vertex ids shuffled
+ * across the whole graph so that the components interleave
+ */
+pg::Graph interleaved_components(std::size_t comp_count, std::size_t comp_size, unsigned int seed) {
+  std::mt19937 rng(seed);
+  std::size_t v_count = comp_count * comp_size;
+
+  std::vector<std::size_t> ids(v_count);
+  for (std::size_t i {}; i < v_count; ++i) { ids[i] = i + 1; }
+  std::shuffle(ids.begin(), ids.end(), rng);
+
+  std::vector<std::tuple<std::size_t, pgt::v_end, std::size_t, pgt::v_end>> edges;
+  for (std::size_t c {}; c < comp_count; ++c) {
+    std::size_t first = c * comp_size;
+    for (std::size_t i { 1 }; i < comp_size; ++i) {
+      // a chain with a random skip back to an earlier vertex of the component
+      edges.emplace_back(ids[first + i - 1], pgt::v_end::r, ids[first + i], pgt::v_end::l);
+      if (rng() % 3 == 0) {
+        std::size_t j = first + rng() % i;
+        edges.emplace_back(ids[j], pgt::v_end::r, ids[first + i], pgt::v_end::l);
+      }
+    }
+  }
+  std::shuffle(edges.begin(), edges.end(), rng);
+
+  pg::Graph g(v_count, edges.size());
+  for (std::size_t id { 1 }; id <= v_count; ++id) { g.add_vertex(id); }
+  for (auto [v1, e1, v2, e2] : edges) { g.add_edge(v1, e1, v2, e2); }
+  g.freeze();
+  io::from_gfa::populate_tips(g, ptest::quiet_config());
+
+  return g;
+}
+} // namespace
+
+
+/*
+  componetize
+  -----------
+ */
+
+// with a small min_chunk the union-find and the root lookups run split across
+// threads, the components must be those of the serial run
+TEST(ComponetizeTest, ParallelMatchesSerial) {
+  for (unsigned int seed : { 1u, 2u, 3u }) {
+    std::vector<component_dump> serial =
+      dump(pg::componetize(interleaved_components(500, 40, seed), ptest::quiet_config(1)));
+
+    for (unsigned int thread_count : { 2u, 4u, 8u }) {
+      std::vector<component_dump> parallel =
+        dump(pg::componetize(interleaved_components(500, 40, seed), ptest::quiet_config(thread_count), 64));
+      EXPECT_EQ(serial.size(), 500);
+      EXPECT_TRUE(serial == parallel) << "seed " << seed << " threads " << thread_count;
+    }
+  }
+}
+
+TEST(ComponetizeTest, ParallelMatchesSerialOnTestData) {
+  for (const std::string& fp : ptest::test_gfas()) {
+    std::vector<component_dump> serial = dump(pg::componetize(ptest::load(fp, ptest::quiet_config()), ptest::quiet_config(1)));
+    std::vector<component_dump> parallel =
+      dump(pg::componetize(ptest::load(fp, ptest::quiet_config()), ptest::quiet_config(4), 16));
+    EXPECT_TRUE(serial == parallel) << fp;
+  }
+}
@@ -0,0 +1,533 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iterator>
+#include <optional>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "../src/graph/bidirected.hpp"
+#include "../src/io/io.hpp"
+#include "../src/povu.hpp"
+#include "./test_utils.hpp"
+
+namespace bd = povu::bidirected;
+namespace pg = povu::graph;
+namespace pgt = povu::graph_types;
+namespace ptest = povu::test;
+
+namespace {
+// chunks this small split every test GFA into as many chunks as there are threads
+const std::size_t SMALL_CHUNK { 64 };
+
+struct graph_dump {
+  std::vector<std::size_t> vertices;
+  std::vector<std::tuple<std::size_t, pgt::v_end, std::size_t, pgt::v_end>> edges;
+  std::vector<std::pair<pgt::v_end, std::size_t>> tips;
+
+  bool operator==(const graph_dump&) const = default;
+};
+
+graph_dump dump(const pg::Graph& g) {
+  graph_dump d;
+  for (std::size_t v_idx {}; v_idx < g.size(); ++v_idx) { d.vertices.push_back(g.v_idx_to_id(v_idx)); }
+  for (std::size_t e_idx {}; e_idx < g.edge_count(); ++e_idx) {
+    const pg::Edge& e = g.get_edge(e_idx);
+    d.edges.emplace_back(e.get_v1_idx(), e.get_v1_end(), e.get_v2_idx(), e.get_v2_end());
+  }
+  for (auto [end, v_idx] : g.tips()) { d.tips.emplace_back(end, v_idx); }
+  return d;
+}
+
+struct bd_dump {
+  std::vector<std::tuple<std::size_t, std::string, std::vector<std::pair<std::size_t, std::size_t>>>> vertices;
+  std::vector<std::tuple<std::size_t, pgt::v_end, std::size_t, pgt::v_end, std::set<std::size_t>>> edges;
+  std::vector<std::tuple<std::string, std::size_t, bool>> paths;
+  std::vector<std::vector<std::pair<std::size_t, pgt::orientation_t>>> raw_paths;
+  std::vector<std::pair<pgt::v_end, std::size_t>> tips;
+
+  bool operator==(const bd_dump&) const = default;
+};
+
+bd_dump dump(const bd::VG& vg) {
+  bd_dump d;
+  for (std::size_t v_idx {}; v_idx < vg.size(); ++v_idx) {
+    std::vector<std::pair<std::size_t, std::size_t>> refs;
+    for (const bd::PathInfo& p : vg.get_vertex(v_idx).get_refs()) { refs.emplace_back(p.path_id, p.step_index); }
+    d.vertices.emplace_back(vg.idx_to_id(v_idx), vg.get_label_str(v_idx), std::move(refs));
+  }
+  for (const bd::Edge& e : vg.get_all_edges()) {
+    d.edges.emplace_back(e.get_v1_idx(), e.get_v1_end(), e.get_v2_idx(), e.get_v2_end(),
+                         std::set<std::size_t>(e.get_refs().begin(), e.get_refs().end()));
+  }
+  for (const pgt::path_t& p : vg.get_refs()) { d.paths.emplace_back(p.name, p.id, p.is_circular); }
+  for (const auto& raw_path : vg.get_raw_paths()) {
+    std::vector<std::pair<std::size_t, pgt::orientation_t>> steps;
+    for (const pgt::id_n_orientation_t& s : raw_path) { steps.emplace_back(s.v_idx, s.orientation); }
+    d.raw_paths.push_back(std::move(steps));
+  }
+  for (auto [end, v_idx] : vg.tips()) { d.tips.emplace_back(end, v_idx); }
+  return d;
+}
+
+// the bidirected graph call loads from a GFA, empty if the GFA is rejected
+std::optional<bd::VG> load_for_call(const std::string& fp) {
+  core::config app_config = ptest::quiet_config();
+  app_config.set_task(core::task_t::call);
+  try { return io::from_gfa::to_bd(fp.c_str(), app_config); }
+  catch (const std::exception&) { return std::nullopt; }
+}
+
+std::string read_file(const std::filesystem::path& fp) {
+  std::ifstream in(fp, std::ios::binary);
+  return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+void write_file(const std::filesystem::path& fp, const std::string& bytes) {
+  std::ofstream(fp, std::ios::binary).write(bytes.data(), bytes.size());
+}
+
+std::uint64_t get_u64(const std::string& bytes, std::size_t off) {
+  std::uint64_t n;
+  std::memcpy(&n, bytes.data() + off, 8);
+  return n;
+}
+
+void put_u64(std::string& bytes, std::size_t off, std::uint64_t n) { std::memcpy(bytes.data() + off, &n, 8); }
+
+// the flubble trees of the components of a few test GFAs by component id, the
+// ids are spread out and not in the order the trees come in
+std::vector<std::pair<std::size_t, povu::tree::Tree<pgt::flubble>>> forest() {
+  std::vector<std::pair<std::size_t, povu::tree::Tree<pgt::flubble>>> trees;
+  for (const char* rel : { "real/LPA.gfa", "real/chr6.C4.gfa", "synthetic/diamond.gfa" }) {
+    std::vector<pg::Graph> components =
+      pg::componetize(ptest::load(ptest::data_path(rel), ptest::quiet_config()), ptest::quiet_config());
+    for (const pg::Graph& c : components) {
+      trees.emplace_back(1000 - 7 * trees.size(), povu::lib::deconstruct_to_ft(c, 1, ptest::quiet_config()));
+    }
+  }
+  return trees;
+}
+} // namespace
+
+
+/*
+  from_gfa
+  --------
+ */
+
+// the records of a GFA split into chunks at newlines must give the graph of a
+// serial scan, whatever line a chunk boundary lands on
+TEST(FromGfaTest, ChunkedMatchesSerial) {
+  for (const std::string& fp : ptest::test_gfas()) {
+    graph_dump serial = dump(io::from_gfa::to_pv_graph(fp.c_str(), ptest::quiet_config(1)));
+    EXPECT_FALSE(serial.vertices.empty()) << fp;
+
+    for (unsigned int thread_count : { 2u, 3u, 8u }) {
+      graph_dump chunked = dump(io::from_gfa::to_pv_graph(fp.c_str(), ptest::quiet_config(thread_count), SMALL_CHUNK));
+      EXPECT_TRUE(serial == chunked) << fp << " threads " << thread_count;
+    }
+  }
+}
+
+// as above with the labels and the paths that call keeps, a GFA the serial
+// scan rejects must be rejected with the same error
+TEST(FromGfaTest, ChunkedMatchesSerialBidirected) {
+  auto load = [](const std::string& fp, unsigned int thread_count, std::size_t min_chunk_size) {
+    core::config app_config = ptest::quiet_config(thread_count);
+    app_config.set_task(core::task_t::call);
+    try { return std::make_pair(dump(io::from_gfa::to_bd(fp.c_str(), app_config, min_chunk_size)), std::string()); }
+    catch (const std::exception& e) { return std::make_pair(bd_dump {}, std::string(e.what())); }
+  };
+
+  for (const std::string& fp : ptest::test_gfas()) {
+    auto serial = load(fp, 1, io::from_gfa::GFA_MIN_CHUNK_SIZE);
+    for (unsigned int thread_count : { 2u, 3u, 8u }) {
+      EXPECT_TRUE(serial == load(fp, thread_count, SMALL_CHUNK)) << fp << " threads " << thread_count;
+    }
+  }
+}
+
+// an L line or a P step on a segment with no S line is rejected with an error
+// that names it instead of indexing past the vertices
+TEST(FromGfaTest, RejectsDanglingSegments) {
+  std::filesystem::path dir = ptest::scratch_dir("dangling_segments");
+  const std::string segments = "H\tVN:Z:1.0\nS\t1\tACT\nS\t2\tCGT\nS\t3\tTT\nL\t1\t+\t2\t+\t0M\n";
+
+  std::string link_fp = (dir / "link.gfa").string();
+  std::ofstream(link_fp) << segments << "L\t2\t+\t9\t-\t0M\nP\tp\t1+,2+\t*,*\n";
+
+  std::string step_fp = (dir / "step.gfa").string();
+  std::ofstream(step_fp) << segments << "L\t2\t+\t3\t+\t0M\nP\tp\t1+,2+,7+\t*,*,*\n";
+
+  core::config call_config = ptest::quiet_config();
+  call_config.set_task(core::task_t::call);
+
+  auto error = [](auto&& load) -> std::string {
+    try { load(); }
+    catch (const std::invalid_argument& e) { return e.what(); }
+    return "";
+  };
+
+  for (unsigned int thread_count : { 1u, 4u }) {
+    std::string pv = error([&] { io::from_gfa::to_pv_graph(link_fp.c_str(), ptest::quiet_config(thread_count), SMALL_CHUNK); });
+    EXPECT_NE(pv.find("L 2 + 9 -"), std::string::npos) << pv;
+
+    std::string bd = error([&] { io::from_gfa::to_bd(link_fp.c_str(), call_config, SMALL_CHUNK); });
+    EXPECT_NE(bd.find("L 2 + 9 -"), std::string::npos) << bd;
+  }
+
+  std::string step = error([&] { io::from_gfa::to_bd(step_fp.c_str(), call_config); });
+  EXPECT_NE(step.find("P p step 7+"), std::string::npos) << step;
+
+  // the steps are only resolved when the paths are kept
+  EXPECT_NO_THROW(io::from_gfa::to_pv_graph(step_fp.c_str(), ptest::quiet_config()));
+}
+
+
+/*
+  pvg
+  ---
+ */
+
+// both graphs loaded from an index must be those loaded from the GFA, the
+// paths are compared for the GFAs that call accepts. A GFA that can't be
+// indexed e.g. because a path steps on a missing segment is skipped.
+TEST(PvgTest, RoundTrip) {
+  std::filesystem::path dir = ptest::scratch_dir("pvg_round_trip");
+  std::string pvg_fp = (dir / "g.pvg").string();
+
+  core::config index_config = ptest::quiet_config();
+  index_config.set_task(core::task_t::index);
+  core::config deconstruct_config = ptest::quiet_config();
+  deconstruct_config.set_task(core::task_t::deconstruct);
+  core::config call_config = ptest::quiet_config();
+  call_config.set_task(core::task_t::call);
+
+  for (const std::string& fp : ptest::test_gfas()) {
+    try { povu::io::pvg::write_pvg(io::from_gfa::to_bd(fp.c_str(), index_config), pvg_fp, index_config); }
+    catch (const std::invalid_argument&) { continue; }
+    ASSERT_TRUE(povu::io::pvg::is_pvg(pvg_fp));
+
+    EXPECT_TRUE(dump(io::from_gfa::to_pv_graph(fp.c_str(), deconstruct_config))
+                == dump(povu::io::pvg::to_pv_graph(pvg_fp.c_str(), deconstruct_config))) << fp;
+
+    EXPECT_TRUE(dump(io::from_gfa::to_bd(fp.c_str(), deconstruct_config))
+                == dump(povu::io::pvg::to_bd(pvg_fp.c_str(), deconstruct_config))) << fp;
+
+    if (std::optional<bd::VG> from_gfa = load_for_call(fp)) {
+      EXPECT_TRUE(dump(*from_gfa) == dump(povu::io::pvg::to_bd(pvg_fp.c_str(), call_config))) << fp;
+    }
+  }
+}
+
+// each kind of damage the reader checks for is rejected before the graph is built
+TEST(PvgTest, RejectsCorrupt) {
+  std::filesystem::path dir = ptest::scratch_dir("pvg_corrupt");
+  std::string good_fp = (dir / "good.pvg").string();
+
+  core::config index_config = ptest::quiet_config();
+  index_config.set_task(core::task_t::index);
+  povu::io::pvg::write_pvg(io::from_gfa::to_bd(ptest::data_path("synthetic/diamond.gfa").c_str(), index_config),
+                           good_fp, index_config);
+  const std::string good = read_file(good_fp);
+
+  // see the pvg layout in src/io/pvg.cpp
+  const std::size_t HEADER { 80 };
+  const std::uint64_t vertex_count = get_u64(good, 16), edge_count = get_u64(good, 24);
+  const std::uint64_t adj_count = get_u64(good, 32), tip_count = get_u64(good, 40);
+  const std::uint64_t path_count = get_u64(good, 48), step_count = get_u64(good, 56);
+  ASSERT_GT(edge_count, 0);
+  ASSERT_GT(step_count, 0);
+
+  const std::size_t seq_offsets = HEADER + 8 * vertex_count;
+  const std::size_t edges = seq_offsets + 8 * (vertex_count + 1);
+  const std::size_t adj_offsets = edges + 24 * edge_count;
+  const std::size_t adj = adj_offsets + 8 * (2 * vertex_count + 1);
+  const std::size_t steps = adj + 8 * adj_count + 16 * tip_count + 16 * (path_count + 1);
+
+  std::vector<std::pair<std::string, std::string>> damaged;
+  damaged.emplace_back("truncated", good.substr(0, good.size() / 2));
+  damaged.emplace_back("header only", good.substr(0, HEADER));
+  { std::string b = good; b[0] = 'X'; damaged.emplace_back("bad magic", b); }
+  { std::string b = good; put_u64(b, 8, 99); damaged.emplace_back("bad version", b); }
+  { std::string b = good; put_u64(b, 16, std::uint64_t{1} << 62); damaged.emplace_back("huge vertex count", b); }
+  { std::string b = good; put_u64(b, 24, ~std::uint64_t{0} / 24 + 1); damaged.emplace_back("overflowing edge count", b); }
+  { std::string b = good; put_u64(b, seq_offsets + 8, ~std::uint64_t{0}); damaged.emplace_back("sequence offset", b); }
+  { std::string b = good; put_u64(b, edges, vertex_count); damaged.emplace_back("edge vertex", b); }
+  { std::string b = good; put_u64(b, adj_offsets + 8 * vertex_count, adj_count + 1); damaged.emplace_back("adjacency offset", b); }
+  { std::string b = good; put_u64(b, adj, edge_count); damaged.emplace_back("adjacency edge", b); }
+  { std::string b = good; put_u64(b, steps, vertex_count << 1); damaged.emplace_back("path step", b); }
+
+  core::config call_config = ptest::quiet_config();
+  call_config.set_task(core::task_t::call);
+  for (const auto& [what, bytes] : damaged) {
+    std::string fp = (dir / "bad.pvg").string();
+    write_file(fp, bytes);
+    EXPECT_THROW(povu::io::pvg::to_bd(fp.c_str(), call_config), std::invalid_argument) << what;
+    EXPECT_THROW(povu::io::pvg::to_pv_graph(fp.c_str(), call_config), std::invalid_argument) << what;
+  }
+
+  EXPECT_NO_THROW(povu::io::pvg::to_bd(good_fp.c_str(), call_config));
+}
+
+
+/*
+  flf
+  ---
+ */
+
+TEST(FlfTest, RoundTrip) {
+  std::filesystem::path dir = ptest::scratch_dir("flf_round_trip");
+  std::string fp = (dir / "forest.flf").string();
+
+  auto trees = forest();
+  ASSERT_GT(trees.size(), 1);
+  {
+    povu::io::flf::writer w(fp);
+    for (const auto& [id, ft] : trees) { w.add(ft, id); }
+    w.close();
+  }
+  ASSERT_TRUE(povu::io::flf::is_flf(fp));
+
+  povu::io::flf::reader r(fp);
+  EXPECT_EQ(r.size(), trees.size());
+
+  std::vector<std::size_t> ids = r.component_ids();
+  EXPECT_TRUE(std::is_sorted(ids.begin(), ids.end()));
+
+  for (const auto& [id, ft] : trees) {
+    EXPECT_EQ(r.block(id), ptest::flb(ft)) << id;
+    EXPECT_EQ(r.read_canonical_fl(id).size(), povu::io::bub::read_canonical_fl(ptest::flb(ft), "ft").size()) << id;
+  }
+  EXPECT_THROW(r.block(1), std::out_of_range);
+}
+
+// each kind of damage the reader checks for is rejected before a block is read
+TEST(FlfTest, RejectsCorrupt) {
+  std::filesystem::path dir = ptest::scratch_dir("flf_corrupt");
+  std::string good_fp = (dir / "good.flf").string();
+
+  auto trees = forest();
+  {
+    povu::io::flf::writer w(good_fp);
+    for (const auto& [id, ft] : trees) { w.add(ft, id); }
+    w.close();
+  }
+  const std::string good = read_file(good_fp);
+
+  // see the flf layout in src/io/flf.cpp
+  const std::size_t HEADER { 16 };
+  const std::size_t ENTRY { 24 };
+  const std::size_t footer = good.size() - 24;
+  const std::uint64_t index_offset = get_u64(good, footer);
+  ASSERT_EQ(get_u64(good, footer + 8), trees.size());
+
+  std::vector<std::pair<std::string, std::string>> damaged;
+  damaged.emplace_back("truncated", good.substr(0, good.size() - 1));
+  damaged.emplace_back("no footer", good.substr(0, footer));
+  { std::string b = good; b[0] = 'X'; damaged.emplace_back("bad magic", b); }
+  { std::string b = good; put_u64(b, 8, 99); damaged.emplace_back("bad version", b); }
+  { std::string b = good; put_u64(b, footer, index_offset + 8); damaged.emplace_back("index offset", b); }
+  { std::string b = good; put_u64(b, footer, good.size()); damaged.emplace_back("index offset past the end", b); }
+  { std::string b = good; put_u64(b, footer + 8, trees.size() + 1); damaged.emplace_back("component count", b); }
+  {
+    // the count times the size of an entry wraps around to 8
+    std::string b = good;
+    put_u64(b, footer, footer - 8);
+    put_u64(b, footer + 8, ~std::uint64_t{0} / ENTRY + 1);
+    damaged.emplace_back("overflowing component count", b);
+  }
+  { std::string b = good; put_u64(b, index_offset + 8, index_offset); damaged.emplace_back("block in the index", b); }
+  { std::string b = good; put_u64(b, index_offset + 8, 0); damaged.emplace_back("block in the header", b); }
+  { std::string b = good; put_u64(b, index_offset + 16, index_offset); damaged.emplace_back("block size", b); }
+  {
+    // offset + size wraps around
+    std::string b = good;
+    put_u64(b, index_offset + 8, HEADER);
+    put_u64(b, index_offset + 16, ~std::uint64_t{0} - 8);
+    damaged.emplace_back("overflowing block size", b);
+  }
+  {
+    std::string b = good;
+    put_u64(b, index_offset, get_u64(good, index_offset + ENTRY));
+    damaged.emplace_back("index out of order", b);
+  }
+
+  for (const auto& [what, bytes] : damaged) {
+    std::string fp = (dir / "bad.flf").string();
+    write_file(fp, bytes);
+    EXPECT_THROW(povu::io::flf::reader r(fp), std::invalid_argument) << what;
+  }
+
+  EXPECT_NO_THROW(povu::io::flf::reader r(good_fp));
+}
+
+
+/*
+  pft
+  ---
+ */
+
+TEST(PftTest, RoundTrip) {
+  std::filesystem::path dir = ptest::scratch_dir("pft_round_trip");
+  std::string fp = (dir / "forest.pft").string();
+
+  std::vector<povu::tree::Tree<pgt::flubble>> trees;
+  std::vector<std::size_t> ids;
+  std::size_t canonical_count {};
+  for (auto& [id, ft] : forest()) {
+    canonical_count += povu::io::bub::read_canonical_fl(ptest::flb(ft), "ft").size();
+    ids.push_back(id);
+    trees.push_back(std::move(ft));
+  }
+  povu::io::pft::write_pft(trees, ids, fp, ptest::quiet_config());
+  ASSERT_TRUE(povu::io::pft::is_pft(fp));
+
+  povu::io::pft::reader r(fp);
+  ASSERT_EQ(r.size(), trees.size());
+  for (std::size_t t {}; t < trees.size(); ++t) {
+    EXPECT_EQ(r.component_id(t), ids[t]);
+    EXPECT_EQ(ptest::flb(r.tree(t)), ptest::flb(trees[t])) << t;
+  }
+  EXPECT_EQ(r.canonical_count(), canonical_count);
+  EXPECT_EQ(r.canonical_fl().size(), canonical_count);
+}
+
+// each kind of damage the reader checks for is rejected before a tree is read
+TEST(PftTest, RejectsCorrupt) {
+  std::filesystem::path dir = ptest::scratch_dir("pft_corrupt");
+  std::string good_fp = (dir / "good.pft").string();
+
+  std::vector<povu::tree::Tree<pgt::flubble>> trees;
+  std::vector<std::size_t> ids;
+  for (auto& [id, ft] : forest()) {
+    ids.push_back(id);
+    trees.push_back(std::move(ft));
+  }
+  povu::io::pft::write_pft(trees, ids, good_fp, ptest::quiet_config());
+  const std::string good = read_file(good_fp);
+
+  // see the pft layout in src/io/pft.cpp
+  const std::size_t HEADER { 48 };
+  const std::uint64_t tree_count = get_u64(good, 16), vertex_count = get_u64(good, 24);
+  const std::uint64_t child_count = get_u64(good, 32), canonical_count = get_u64(good, 40);
+  ASSERT_GT(tree_count, 1);
+  ASSERT_GT(child_count, 0);
+  ASSERT_NE(vertex_count % 64, 0);
+
+  const std::size_t tree_offsets = HEADER + 8 * tree_count;
+  const std::size_t parents = tree_offsets + 8 * (tree_count + 1);
+  const std::size_t child_offsets = parents + 8 * vertex_count;
+  const std::size_t children = child_offsets + 8 * (vertex_count + 1);
+  const std::size_t canonical = children + 8 * child_count + 16 * vertex_count;
+  const std::size_t last_word = canonical + 8 * (vertex_count / 64);
+
+  std::vector<std::pair<std::string, std::string>> damaged;
+  damaged.emplace_back("truncated", good.substr(0, good.size() - 8));
+  damaged.emplace_back("header only", good.substr(0, HEADER));
+  { std::string b = good; b[0] = 'X'; damaged.emplace_back("bad magic", b); }
+  { std::string b = good; put_u64(b, 8, 99); damaged.emplace_back("bad version", b); }
+  { std::string b = good; put_u64(b, 24, std::uint64_t{1} << 62); damaged.emplace_back("huge vertex count", b); }
+  { std::string b = good; put_u64(b, 32, ~std::uint64_t{0} / 8 + 1); damaged.emplace_back("overflowing child count", b); }
+  { std::string b = good; put_u64(b, tree_offsets + 8 * tree_count, vertex_count - 1); damaged.emplace_back("tree offsets end", b); }
+  { std::string b = good; put_u64(b, tree_offsets + 8, vertex_count + 1); damaged.emplace_back("tree offsets decrease", b); }
+  { std::string b = good; put_u64(b, child_offsets + 8, child_count + 1); damaged.emplace_back("child offset", b); }
+  { std::string b = good; put_u64(b, children, vertex_count); damaged.emplace_back("child", b); }
+  { std::string b = good; put_u64(b, parents + 8, vertex_count); damaged.emplace_back("parent", b); }
+  { std::string b = good; put_u64(b, 40, canonical_count + 1); damaged.emplace_back("canonical count", b); }
+  {
+    std::string b = good;
+    put_u64(b, last_word, get_u64(good, last_word) | std::uint64_t{1} << 63);
+    put_u64(b, 40, canonical_count + 1);
+    damaged.emplace_back("canonical bit past the end", b);
+  }
+  {
+    // vertex 0 is the root of the first tree, it has no flubble
+    std::string b = good;
+    put_u64(b, canonical, get_u64(good, canonical) | 1);
+    put_u64(b, 40, canonical_count + 1);
+    damaged.emplace_back("canonical root", b);
+  }
+
+  for (const auto& [what, bytes] : damaged) {
+    std::string fp = (dir / "bad.pft").string();
+    write_file(fp, bytes);
+    EXPECT_THROW(povu::io::pft::reader r(fp), std::invalid_argument) << what;
+  }
+
+  EXPECT_NO_THROW(povu::io::pft::reader r(good_fp));
+}
+
+
+/*
+  forest
+  ------
+ */
+
+// a forest with every tree twice gives each flubble once, whichever way it is
+// stored and however many threads read it
+TEST(ForestTest, ReadDropsDuplicates) {
+  std::filesystem::path dir = ptest::scratch_dir("forest_duplicates");
+
+  auto trees = forest();
+  std::vector<povu::tree::Tree<pgt::flubble>> fts;
+  std::vector<std::size_t> ids;
+  for (auto& [id, ft] : trees) {
+    fts.push_back(ft);
+    ids.push_back(id);
+  }
+
+  // the flubbles of every tree once, as start and end
+  auto key = [](const pgt::flubble& fl) { return std::make_pair(fl.start_.as_str(), fl.end_.as_str()); };
+  std::set<std::pair<std::string, std::string>> expected;
+  for (const auto& ft : fts) {
+    for (const pgt::flubble& fl : povu::io::bub::read_canonical_fl(ptest::flb(ft), "ft")) { expected.insert(key(fl)); }
+  }
+  ASSERT_GT(expected.size(), 0);
+
+  // a dir of .flb files, an flf and a pft, each with every tree in it twice
+  std::filesystem::create_directories(dir / "flb");
+  std::filesystem::create_directories(dir / "flf");
+  {
+    povu::io::flf::writer w((dir / "flf" / povu::io::flf::FOREST_FILE_NAME).string());
+    for (std::size_t copy {}; copy < 2; ++copy) {
+      for (std::size_t i {}; i < fts.size(); ++i) {
+        std::size_t id = ids[i] + copy * 10'000;
+        write_file(dir / "flb" / std::format("{}.flb", id), ptest::flb(fts[i]));
+        w.add(fts[i], id);
+      }
+    }
+    w.close();
+  }
+  std::vector<povu::tree::Tree<pgt::flubble>> twice = fts;
+  twice.insert(twice.end(), fts.begin(), fts.end());
+  std::vector<std::size_t> twice_ids = ids;
+  for (std::size_t id : ids) { twice_ids.push_back(id + 10'000); }
+  povu::io::pft::write_pft(twice, twice_ids, (dir / "forest.pft").string(), ptest::quiet_config());
+
+  for (const std::filesystem::path& forest_dir : { dir / "flb", dir / "flf", dir / "forest.pft" }) {
+    std::vector<std::vector<pgt::flubble>> reads;
+    for (unsigned int thread_count : { 1u, 4u }) {
+      core::config app_config = ptest::quiet_config(thread_count);
+      app_config.set_forest_dir(forest_dir.string());
+      reads.push_back(povu::io::forest::read_canonical_fl(app_config));
+    }
+
+    std::set<std::pair<std::string, std::string>> got;
+    for (const pgt::flubble& fl : reads[0]) { EXPECT_TRUE(got.insert(key(fl)).second) << forest_dir << " " << key(fl).first << key(fl).second; }
+    EXPECT_EQ(got, expected) << forest_dir;
+
+    // the same flubbles in the same order on any number of threads
+    ASSERT_EQ(reads[0].size(), reads[1].size()) << forest_dir;
+    for (std::size_t i {}; i < reads[0].size(); ++i) { EXPECT_EQ(key(reads[0][i]), key(reads[1][i])) << forest_dir << " " << i; }
+  }
+}
@@ -0,0 +1,122 @@
+#include <gtest/gtest.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../src/common/utils.hpp"
+#include "../src/graph/seq_store.hpp"
+
+namespace pss = povu::seq_store;
+namespace pu = povu::utils;
+
+namespace {
+// every way of reading [off, off + len) must give the reference bytes
+void expect_range(const pss::SeqStore& s, const std::string& all, std::size_t off, std::size_t len) {
+  for (bool rc : { false, true }) {
+    std::string expected = all.substr(off, len);
+    if (rc) { expected = pu::reverse_complement(expected); }
+
+    pss::SeqView v = s.view(off, len, rc);
+    EXPECT_EQ(v.to_string(), expected) << off << " " << len << " rc " << rc;
+    EXPECT_EQ(std::string(v.begin(), v.end()), expected) << off << " " << len << " rc " << rc;
+
+    std::string out;
+    s.append_to(off, len, rc, out);
+    EXPECT_EQ(out, expected) << off << " " << len << " rc " << rc;
+
+    if (len > 0) {
+      EXPECT_EQ(v.front(), expected.front()) << off << " " << len << " rc " << rc;
+      EXPECT_EQ(v.back(), expected.back()) << off << " " << len << " rc " << rc;
+    }
+  }
+}
+
+// append the labels and check each of them
+std::string fill(pss::SeqStore& s, const std::vector<std::string>& labels) {
+  std::string all;
+  for (const std::string& l : labels) {
+    EXPECT_EQ(s.append(l), all.size());
+    all += l;
+  }
+  EXPECT_EQ(s.size(), all.size());
+
+  std::size_t off {};
+  for (const std::string& l : labels) {
+    expect_range(s, all, off, l.size());
+    off += l.size();
+  }
+  return all;
+}
+} // namespace
+
+
+/*
+  SeqStore
+  --------
+ */
+
+TEST(SeqStoreTest, UpperCase) {
+  pss::SeqStore s;
+  fill(s, { "A", "ACGT", "TTGCA", "", "GATTACAGATTACA", "CCCCCCCCC" });
+  EXPECT_EQ(s.exception_count(), 0);
+  EXPECT_EQ(s.lower_run_count(), 0);
+}
+
+TEST(SeqStoreTest, NAndIupac) {
+  pss::SeqStore s;
+  fill(s, { "NNNN", "ACNNNGT", "RYKMSWBDHVN", "AN", "NA", "A-*.T", "nnnACGTnnn" });
+  EXPECT_GT(s.exception_count(), 0);
+}
+
+// soft-masked bases are packed, only the case runs are extra and like
+// utils::complement they are not complemented
+TEST(SeqStoreTest, LowerCase) {
+  pss::SeqStore s;
+  std::string masked;
+  for (std::size_t i {}; i < 1000; ++i) { masked += "acgt"; }
+
+  fill(s, { masked, "ACGTacgtACGT", "acgtNNNNacgt", "aCgTaCgT", "ttttTTTT", "gattaca" });
+  EXPECT_EQ(s.exception_count(), 1);
+  // the 4000 base soft-masked label is a single run
+  EXPECT_LT(s.lower_run_count(), 20);
+}
+
+TEST(SeqStoreTest, SoftMaskedIsCompact) {
+  pss::SeqStore s;
+  std::string masked;
+  for (std::size_t block {}; block < 100; ++block) {
+    for (std::size_t i {}; i < 1000; ++i) { masked += "acgt"[i % 4]; }
+    for (std::size_t i {}; i < 1000; ++i) { masked += "ACGT"[i % 4]; }
+  }
+  s.append(masked);
+
+  EXPECT_EQ(s.exception_count(), 0);
+  EXPECT_EQ(s.lower_run_count(), 100);
+  EXPECT_LT(s.byte_size(), masked.size() / 3);
+  expect_range(s, masked, 0, masked.size());
+}
+
+// ranges that start and end inside packed bytes, lower case runs and
+// exception runs, including the ones that straddle labels
+TEST(SeqStoreTest, RangesStraddlingRuns) {
+  std::mt19937 rng(7);
+  const std::string alphabet { "ACGTACGTACGTacgtacgtNNnRY" };
+
+  std::vector<std::string> labels;
+  for (std::size_t i {}; i < 50; ++i) {
+    std::string l;
+    // runs of a single byte so that ranges land inside them
+    for (std::size_t r {}, runs = 1 + rng() % 6; r < runs; ++r) { l.append(1 + rng() % 9, alphabet[rng() % alphabet.size()]); }
+    labels.push_back(l);
+  }
+
+  pss::SeqStore s;
+  std::string all = fill(s, labels);
+
+  for (std::size_t i {}; i < 2000; ++i) {
+    std::size_t off = rng() % all.size();
+    std::size_t len = rng() % (all.size() - off + 1);
+    expect_range(s, all, off, len);
+  }
+}
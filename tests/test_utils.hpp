@@ -0,0 +1,61 @@
+#ifndef POVU_TEST_UTILS_HPP
+#define POVU_TEST_UTILS_HPP
+
+#include <algorithm>
+#include <filesystem>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../src/cli/app.hpp"
+#include "../src/graph/graph.hpp"
+#include "../src/graph/tree.hpp"
+#include "../src/io/io.hpp"
+
+namespace povu::test {
+// POVU_TEST_DATA is set by the build to the test_data dir of the source tree
+inline std::string data_path(const std::string& rel) {
+  return (std::filesystem::path(POVU_TEST_DATA) / rel).string();
+}
+
+// the gfa files the tests are run over, small enough to run them all
+inline std::vector<std::string> test_gfas() {
+  std::vector<std::string> gfas;
+  for (const char* dir : { "synthetic", "real" }) {
+    for (const std::filesystem::path& fp : povu::io::generic::get_files(data_path(dir), ".gfa")) {
+      gfas.push_back(fp.string());
+    }
+  }
+  std::sort(gfas.begin(), gfas.end());
+  return gfas;
+}
+
+inline core::config quiet_config(unsigned int thread_count = 1) {
+  core::config app_config;
+  app_config.set_verbosity(0);
+  app_config.set_print_dot(false);
+  app_config.set_thread_count(thread_count);
+  return app_config;
+}
+
+inline povu::graph::Graph load(const std::string& fp, const core::config& app_config) {
+  return ::io::from_gfa::to_pv_graph(fp.c_str(), app_config);
+}
+
+// a flubble tree as the text of its .flb file
+inline std::string flb(const povu::tree::Tree<povu::graph_types::flubble>& ft) {
+  std::ostringstream out;
+  povu::io::bub::write_bub(ft, out);
+  return out.str();
+}
+
+// a fresh dir under the temp dir for the files a test writes
+inline std::filesystem::path scratch_dir(const std::string& name) {
+  std::filesystem::path dir = std::filesystem::temp_directory_path() / "povu_tests" / name;
+  std::filesystem::remove_all(dir);
+  std::filesystem::create_directories(dir);
+  return dir;
+}
+} // namespace povu::test
+
+#endif
@@ -0,0 +1,138 @@
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <vector>
+
+#include "../src/common/types.hpp"
+
+namespace pc = povu::constants;
+namespace pgt = povu::graph_types;
+namespace pt = povu::types;
+
+namespace {
+// every id maps to its idx and back
+void expect_maps(const pt::IdMap& m, const std::vector<std::size_t>& ids) {
+  EXPECT_EQ(m.size(), ids.size());
+  for (std::size_t idx {}; idx < ids.size(); ++idx) {
+    EXPECT_EQ(m.get_idx(ids[idx]), idx) << "id " << ids[idx];
+    EXPECT_EQ(m.get_id(idx), ids[idx]) << "idx " << idx;
+  }
+}
+} // namespace
+
+
+/*
+  IdMap
+  -----
+ */
+
+TEST(IdMapTest, DenseIds) {
+  pt::IdMap m;
+  std::vector<std::size_t> ids;
+  for (std::size_t id { 1 }; id <= 1000; ++id) { ids.push_back(id); m.insert(id, id - 1); }
+
+  EXPECT_TRUE(m.is_dense());
+  expect_maps(m, ids);
+}
+
+// ids that arrive in descending order grow the dense range downwards
+TEST(IdMapTest, DescendingIds) {
+  pt::IdMap m;
+  std::vector<std::size_t> ids;
+  for (std::size_t id { 5000 }; id > 0; --id) { m.insert(id, ids.size()); ids.push_back(id); }
+
+  EXPECT_TRUE(m.is_dense());
+  expect_maps(m, ids);
+}
+
+TEST(IdMapTest, SparseIds) {
+  pt::IdMap m;
+  std::vector<std::size_t> ids;
+  for (std::size_t i {}; i < 1000; ++i) { ids.push_back(i * 1'000'003); m.insert(ids.back(), i); }
+
+  EXPECT_FALSE(m.is_dense());
+  expect_maps(m, ids);
+}
+
+// a range that went sparse goes dense again once enough ids fill it in
+TEST(IdMapTest, SparseToDense) {
+  pt::IdMap m;
+  std::vector<std::size_t> ids { 0, 200'000 };
+  m.insert(0, 0);
+  m.insert(200'000, 1);
+  EXPECT_FALSE(m.is_dense());
+
+  for (std::size_t id { 1 }; id < 150'000; ++id) { m.insert(id, ids.size()); ids.push_back(id); }
+
+  EXPECT_TRUE(m.is_dense());
+  expect_maps(m, ids);
+}
+
+// a size hint keeps ids that arrive out of order dense
+TEST(IdMapTest, ReserveKeepsDense) {
+  pt::IdMap hinted, unhinted;
+  hinted.reserve(100'000);
+  for (pt::IdMap* m : { &hinted, &unhinted }) {
+    m->insert(100'000, 0);
+    m->insert(1, 1);
+  }
+
+  EXPECT_TRUE(hinted.is_dense());
+  EXPECT_FALSE(unhinted.is_dense());
+  expect_maps(hinted, { 100'000, 1 });
+  expect_maps(unhinted, { 100'000, 1 });
+}
+
+TEST(IdMapTest, MissingIds) {
+  pt::IdMap empty;
+  EXPECT_EQ(empty.get_idx(0), pc::INVALID_IDX);
+  EXPECT_EQ(empty.get_id(0), pc::INVALID_ID);
+  EXPECT_FALSE(empty.has_id(7));
+
+  pt::IdMap dense, sparse;
+  for (std::size_t i {}; i < 100; ++i) {
+    dense.insert(10 + 2 * i, i);
+    sparse.insert(10 + 1'000'003 * i, i);
+  }
+  ASSERT_TRUE(dense.is_dense());
+  ASSERT_FALSE(sparse.is_dense());
+
+  for (const pt::IdMap* m : { &dense, &sparse }) {
+    // below, inside and above the range
+    for (std::size_t id : { std::size_t { 0 }, std::size_t { 9 }, std::size_t { 11 }, std::size_t { 1'000'004 },
+                            std::size_t { 1'000'000'000'000 } }) {
+      EXPECT_EQ(m->get_idx(id), pc::INVALID_IDX) << id;
+      EXPECT_FALSE(m->has_id(id)) << id;
+    }
+    EXPECT_EQ(m->get_id(100), pc::INVALID_ID);
+  }
+}
+
+// inserting an id again moves it to its new idx
+TEST(IdMapTest, Reinsert) {
+  for (std::size_t stride : { 1, 1'000'003 }) {
+    pt::IdMap m;
+    for (std::size_t i {}; i < 10; ++i) { m.insert(stride * i, i); }
+    m.insert(stride * 3, 42);
+
+    EXPECT_EQ(m.size(), 10);
+    EXPECT_EQ(m.get_idx(stride * 3), 42);
+    EXPECT_EQ(m.get_id(42), stride * 3);
+  }
+}
+
+
+/*
+  pack and unpack
+  ---------------
+ */
+
+TEST(PackTest, RoundTrip) {
+  for (std::size_t v_idx : { std::size_t {}, std::size_t { 1 }, std::size_t { 12345 }, (std::size_t { 1 } << 62) - 1 }) {
+    for (pgt::orientation_t o : { pgt::orientation_t::forward, pgt::orientation_t::reverse }) {
+      pgt::id_n_orientation_t x { v_idx, o };
+      EXPECT_EQ(pgt::pack(x), v_idx << 1 | (o == pgt::orientation_t::reverse));
+      EXPECT_EQ(pgt::unpack(pgt::pack(x)), x);
+    }
+  }
+}